@@ -101,7 +101,9 @@ static GstFlowReturn callback(GstElement* sink, void* user_data  __attribute__((
             g_warning("No meta data available\n");
         }
 
-        GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
+        // the structure is created on the first call
+        // plain values are also available via ((TcamStatisticsMeta*)meta)->statistics
+        const GstStructure* struc = tcam_statistics_meta_get_structure((TcamStatisticsMeta*)meta);
 
         // this prints all contained fields
         gst_structure_foreach(struc, meta_struc_print, NULL);
@@ -4,6 +4,8 @@
 #include <gst/gst.h>
 #include <string>
 #include <functional>
+#include <system_error>
+#include <vector>
 
 #include <Tcam-1.0.h>
 
@@ -11,6 +13,22 @@ namespace tcamprop1_gobj
 {
     using report_error_function = std::function<void ( const GError& err, const std::string& prop_name, const GValue* prop_value )>;
 
-    void    apply_properties( TcamPropertyProvider* prop_provider, const GstStructure& data_struct, const report_error_function& report_func );
+    // Optional, called around all writes of apply_properties.
+    // Allows the provider to collect the writes and apply them at once.
+    struct batch_failure
+    {
+        std::string         prop_name;
+        std::error_code     errc;
+    };
+
+    struct apply_batch_functions
+    {
+        std::function<void()>   begin;
+        // Returns the properties the provider failed to write, they are passed on to report_func.
+        std::function<std::vector<batch_failure>()>   commit;
+    };
+
+    void    apply_properties( TcamPropertyProvider* prop_provider, const GstStructure& data_struct, const report_error_function& report_func,
+                              const apply_batch_functions& batch_funcs = {} );
     void    serialize_properties( TcamPropertyProvider* prop_provider, GstStructure& data_struct );
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <gst-helper/gobject_ptr.h>
 #include <tcamprop1.0_gobject/tcam_gerror.h>
 #include <tcam-property-1.0.h>
+#include <algorithm>
 #include <cassert>
 #include <fmt/format.h>
 
@@ -152,7 +153,8 @@ namespace
 
 }
 
-void tcamprop1_gobj::apply_properties( TcamPropertyProvider* prop_provider, const GstStructure& data_struct, const report_error_function& report_func )
+void tcamprop1_gobj::apply_properties( TcamPropertyProvider* prop_provider, const GstStructure& data_struct, const report_error_function& report_func,
+                                       const apply_batch_functions& batch_funcs )
 {
     std::vector<gst_apply_entry>	struct_list;
 
@@ -174,6 +176,27 @@ void tcamprop1_gobj::apply_properties( TcamPropertyProvider* prop_provider, cons
         return;
     }
 
+    if( batch_funcs.begin ) {
+        batch_funcs.begin();
+    }
+
+    // an exception while applying must not leave the batch of the device open
+    struct batch_guard
+    {
+        const apply_batch_functions& funcs;
+        bool committed = false;
+
+        ~batch_guard()
+        {
+            if( !committed && funcs.commit ) {
+                funcs.commit();
+            }
+        }
+    } guard{ batch_funcs };
+
+    // entries that are only collected until batch_funcs.commit
+    std::vector<gst_apply_entry> written_list;
+
     bool at_least_one_success = false;
     do
     {
@@ -189,12 +212,35 @@ void tcamprop1_gobj::apply_properties( TcamPropertyProvider* prop_provider, cons
             }
             else if( res == apply_entry_result::success ) {
                 at_least_one_success = true;
+                written_list.push_back( e );
             }
         }
 
         struct_list = std::move( retry_list );
     } while( at_least_one_success && !struct_list.empty() );
 
+    guard.committed = true;
+    if( batch_funcs.commit )
+    {
+        for( auto&& failure : batch_funcs.commit() )
+        {
+            GError* err = nullptr;
+            tcamprop1_gobj::set_gerror( &err, failure.errc );
+            if( err == nullptr ) {
+                tcamprop1_gobj::set_gerror( &err, TCAM_ERROR_UNKNOWN );
+            }
+
+            auto entry = std::find_if( written_list.begin(), written_list.end(),
+                                       [&failure]( const gst_apply_entry& e ) { return e.name == failure.prop_name; } );
+            if( entry != written_list.end() ) {
+                report_func( *err, entry->name, entry->val.get() );
+            } else {
+                report_func( *err, failure.prop_name, nullptr );
+            }
+            g_error_free( err );
+        }
+    }
+
     if( !struct_list.empty() )
     {
         GError* err = nullptr;
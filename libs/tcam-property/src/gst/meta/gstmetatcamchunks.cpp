@@ -0,0 +1,148 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gstmetatcamchunks.h"
+
+GType tcam_chunk_meta_api_get_type(void)
+{
+    static GType type;
+    static const gchar* tags[] = { "id", "val", NULL };
+
+    if (g_once_init_enter(&type))
+    {
+        GType _type = gst_meta_api_type_register("TcamChunkMetaApi", tags);
+        g_once_init_leave(&type, _type);
+    }
+    return type;
+}
+
+
+static gboolean tcam_chunk_meta_init(GstMeta* meta, gpointer /* params */, GstBuffer* /* buffer */)
+{
+    TcamChunkMeta* tcam = (TcamChunkMeta*)meta;
+
+    tcam->version = TCAM_CHUNK_META_VERSION;
+    tcam->data = {};
+
+    return TRUE;
+}
+
+
+static gboolean tcam_chunk_meta_transform(GstBuffer* trans_buffer,
+                                          GstMeta* meta,
+                                          GstBuffer* /* buffer */,
+                                          GQuark type,
+                                          gpointer /* data */)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(trans_buffer), FALSE);
+
+    TcamChunkMeta* tcam = (TcamChunkMeta*)meta;
+
+    if (GST_META_TRANSFORM_IS_COPY(type))
+    {
+        TcamChunkMeta* trans_tcam =
+            (TcamChunkMeta*)gst_buffer_add_meta(trans_buffer, TCAM_CHUNK_META_INFO, nullptr);
+
+        if (!trans_tcam)
+        {
+            return FALSE;
+        }
+
+        trans_tcam->data = tcam->data;
+    }
+    return TRUE;
+}
+
+
+const GstMetaInfo* tcam_chunk_meta_get_info(void)
+{
+    static const GstMetaInfo* meta_info = nullptr;
+
+    if (g_once_init_enter(&meta_info))
+    {
+        const GstMetaInfo* mi = gst_meta_register(TCAM_CHUNK_META_API_TYPE,
+                                                  "TcamChunkMeta",
+                                                  sizeof(TcamChunkMeta),
+                                                  tcam_chunk_meta_init,
+                                                  nullptr,
+                                                  tcam_chunk_meta_transform);
+        g_once_init_leave(&meta_info, mi);
+    }
+
+    return meta_info;
+}
+
+
+TcamChunkMeta* gst_buffer_add_tcam_chunk_meta(GstBuffer* buffer)
+{
+    g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
+
+    return (TcamChunkMeta*)gst_buffer_add_meta(buffer, TCAM_CHUNK_META_INFO, nullptr);
+}
+
+
+gboolean tcam_chunk_meta_get_data(const TcamChunkMeta* meta, TcamChunkData* out_data)
+{
+    if (!meta || !out_data)
+    {
+        return FALSE;
+    }
+
+    *out_data = meta->data;
+
+    return TRUE;
+}
+
+
+void tcam_chunk_meta_set_data(TcamChunkMeta* meta, const TcamChunkData* data)
+{
+    g_return_if_fail(meta);
+    g_return_if_fail(data);
+
+    meta->data = *data;
+}
+
+
+GstStructure* tcam_chunk_meta_create_structure(const TcamChunkMeta* meta)
+{
+    g_return_val_if_fail(meta, nullptr);
+
+    const auto& d = meta->data;
+    GstStructure* s = gst_structure_new_empty("TcamChunkData");
+
+    if (d.valid_fields & TCAM_CHUNK_DATA_EXPOSURE_TIME)
+    {
+        gst_structure_set(s, "ExposureTime", G_TYPE_DOUBLE, d.exposure_time_us, nullptr);
+    }
+    if (d.valid_fields & TCAM_CHUNK_DATA_GAIN)
+    {
+        gst_structure_set(s, "Gain", G_TYPE_DOUBLE, d.gain, nullptr);
+    }
+    if (d.valid_fields & TCAM_CHUNK_DATA_FRAME_ID)
+    {
+        gst_structure_set(s, "FrameID", G_TYPE_UINT64, d.frame_id, nullptr);
+    }
+    if (d.valid_fields & TCAM_CHUNK_DATA_LINE_STATUS_ALL)
+    {
+        gst_structure_set(s, "LineStatusAll", G_TYPE_UINT64, d.line_status_all, nullptr);
+    }
+    if (d.valid_fields & TCAM_CHUNK_DATA_TIMESTAMP)
+    {
+        gst_structure_set(s, "Timestamp", G_TYPE_UINT64, d.timestamp, nullptr);
+    }
+
+    return s;
+}
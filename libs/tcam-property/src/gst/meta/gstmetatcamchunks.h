@@ -0,0 +1,103 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GST_META_TCAM_CHUNKS_H
+#define GST_META_TCAM_CHUNKS_H
+
+
+#include <gst/gst.h>
+
+_Pragma("GCC visibility push (default)")
+
+#if __cplusplus
+extern "C" {
+#endif
+
+G_BEGIN_DECLS
+
+// version of the binary layout of TcamChunkMeta
+#define TCAM_CHUNK_META_VERSION 1
+
+// bits of TcamChunkData.valid_fields
+#define TCAM_CHUNK_DATA_EXPOSURE_TIME (1 << 0)
+#define TCAM_CHUNK_DATA_GAIN (1 << 1)
+#define TCAM_CHUNK_DATA_FRAME_ID (1 << 2)
+#define TCAM_CHUNK_DATA_LINE_STATUS_ALL (1 << 3)
+#define TCAM_CHUNK_DATA_TIMESTAMP (1 << 4)
+
+// GenICam chunk values the camera transmitted with the image
+// only fields marked in valid_fields contain data
+typedef struct
+{
+    guint32 valid_fields;
+    // ChunkExposureTime, in us
+    gdouble exposure_time_us;
+    // ChunkGain
+    gdouble gain;
+    // ChunkFrameID
+    guint64 frame_id;
+    // ChunkLineStatusAll, bit n is the state of line n
+    guint64 line_status_all;
+    // ChunkTimestamp, camera clock ticks
+    guint64 timestamp;
+} TcamChunkData;
+
+typedef struct _GstMetaTcamChunks TcamChunkMeta;
+
+struct _GstMetaTcamChunks
+{
+    GstMeta meta;
+
+    // TCAM_CHUNK_META_VERSION of the producer
+    guint version;
+    // has to stay the last member, new fields are appended to TcamChunkData
+    TcamChunkData data;
+};
+
+GType tcam_chunk_meta_api_get_type(void);
+#define TCAM_CHUNK_META_API_TYPE (tcam_chunk_meta_api_get_type())
+
+// finds and returns the metadata
+#define gst_buffer_get_tcam_chunk_meta(b) \
+    ((TcamChunkMeta*)gst_buffer_get_meta((b), TCAM_CHUNK_META_API_TYPE))
+
+
+const GstMetaInfo* tcam_chunk_meta_get_info(void);
+#define TCAM_CHUNK_META_INFO (tcam_chunk_meta_get_info())
+
+// the meta is added without any valid fields
+TcamChunkMeta* gst_buffer_add_tcam_chunk_meta(GstBuffer* buffer);
+
+// returns FALSE when meta is nullptr
+gboolean tcam_chunk_meta_get_data(const TcamChunkMeta* meta, TcamChunkData* out_data);
+
+void tcam_chunk_meta_set_data(TcamChunkMeta* meta, const TcamChunkData* data);
+
+// returns a new GstStructure named TcamChunkData
+// that only contains the valid fields
+// the caller takes ownership
+GstStructure* tcam_chunk_meta_create_structure(const TcamChunkMeta* meta);
+
+G_END_DECLS
+
+#if __cplusplus
+} // extern "C"
+#endif
+
+_Pragma("GCC visibility pop")
+
+#endif /* GST_META_TCAM_CHUNKS_H */
@@ -18,6 +18,138 @@
 
 #include <cstring>
 
+namespace
+{
+
+struct statistics_quarks
+{
+    GQuark frame_count = g_quark_from_static_string("frame_count");
+    GQuark frames_dropped = g_quark_from_static_string("frames_dropped");
+    GQuark capture_time_ns = g_quark_from_static_string("capture_time_ns");
+    GQuark camera_time_ns = g_quark_from_static_string("camera_time_ns");
+    GQuark is_damaged = g_quark_from_static_string("is_damaged");
+    GQuark buffer_count = g_quark_from_static_string("buffer_count");
+    GQuark buffers_added = g_quark_from_static_string("buffers_added");
+    GQuark buffers_removed = g_quark_from_static_string("buffers_removed");
+    GQuark dequeue_time_ns = g_quark_from_static_string("dequeue_time_ns");
+    GQuark properties_done_time_ns = g_quark_from_static_string("properties_done_time_ns");
+    GQuark queued_time_ns = g_quark_from_static_string("queued_time_ns");
+    GQuark acquired_time_ns = g_quark_from_static_string("acquired_time_ns");
+    GQuark convert_start_time_ns = g_quark_from_static_string("convert_start_time_ns");
+    GQuark convert_end_time_ns = g_quark_from_static_string("convert_end_time_ns");
+    GQuark frames_dropped_size_mismatch = g_quark_from_static_string("frames_dropped_size_mismatch");
+    GQuark sequence_gap = g_quark_from_static_string("sequence_gap");
+    GQuark packets_resent = g_quark_from_static_string("packets_resent");
+    GQuark packets_missing = g_quark_from_static_string("packets_missing");
+    GQuark frames_lost = g_quark_from_static_string("frames_lost");
+    GQuark frame_packets_resent = g_quark_from_static_string("frame_packets_resent");
+    GQuark frame_packets_missing = g_quark_from_static_string("frame_packets_missing");
+    GQuark packet_size = g_quark_from_static_string("packet_size");
+    GQuark packet_delay_ns = g_quark_from_static_string("packet_delay_ns");
+    GQuark corrected_time_ns = g_quark_from_static_string("corrected_time_ns");
+};
+
+
+const statistics_quarks& get_quarks()
+{
+    static const statistics_quarks quarks;
+    return quarks;
+}
+
+
+GstStructure* create_structure(const TcamStatistics& stat)
+{
+    GstStructure* structure = gst_structure_new_empty("TcamStatistics");
+
+    const auto& q = get_quarks();
+
+    gst_structure_id_set(structure,
+                         q.frame_count,
+                         G_TYPE_UINT64,
+                         stat.frame_count,
+                         q.frames_dropped,
+                         G_TYPE_UINT64,
+                         stat.frames_dropped,
+                         q.capture_time_ns,
+                         G_TYPE_UINT64,
+                         stat.capture_time_ns,
+                         q.camera_time_ns,
+                         G_TYPE_UINT64,
+                         stat.camera_time_ns,
+                         q.is_damaged,
+                         G_TYPE_BOOLEAN,
+                         stat.is_damaged,
+                         q.buffer_count,
+                         G_TYPE_UINT,
+                         stat.buffer_count,
+                         q.buffers_added,
+                         G_TYPE_UINT64,
+                         stat.buffers_added,
+                         q.buffers_removed,
+                         G_TYPE_UINT64,
+                         stat.buffers_removed,
+                         q.dequeue_time_ns,
+                         G_TYPE_UINT64,
+                         stat.dequeue_time_ns,
+                         q.properties_done_time_ns,
+                         G_TYPE_UINT64,
+                         stat.properties_done_time_ns,
+                         q.queued_time_ns,
+                         G_TYPE_UINT64,
+                         stat.queued_time_ns,
+                         q.acquired_time_ns,
+                         G_TYPE_UINT64,
+                         stat.acquired_time_ns,
+                         q.convert_start_time_ns,
+                         G_TYPE_UINT64,
+                         stat.convert_start_time_ns,
+                         q.convert_end_time_ns,
+                         G_TYPE_UINT64,
+                         stat.convert_end_time_ns,
+                         q.frames_dropped_size_mismatch,
+                         G_TYPE_UINT64,
+                         stat.frames_dropped_size_mismatch,
+                         q.sequence_gap,
+                         G_TYPE_BOOLEAN,
+                         stat.sequence_gap,
+                         q.packets_resent,
+                         G_TYPE_UINT64,
+                         stat.packets_resent,
+                         q.packets_missing,
+                         G_TYPE_UINT64,
+                         stat.packets_missing,
+                         q.frames_lost,
+                         G_TYPE_UINT64,
+                         stat.frames_lost,
+                         q.frame_packets_resent,
+                         G_TYPE_UINT,
+                         stat.frame_packets_resent,
+                         q.frame_packets_missing,
+                         G_TYPE_UINT,
+                         stat.frame_packets_missing,
+                         q.packet_size,
+                         G_TYPE_UINT,
+                         stat.packet_size,
+                         q.packet_delay_ns,
+                         G_TYPE_UINT64,
+                         stat.packet_delay_ns,
+                         q.corrected_time_ns,
+                         G_TYPE_UINT64,
+                         stat.corrected_time_ns,
+                         nullptr);
+
+    return structure;
+}
+
+
+// the structure may be created concurrently by tcam_statistics_meta_get_structure
+const GstStructure* load_structure(const TcamStatisticsMeta& meta)
+{
+    return (const GstStructure*)g_atomic_pointer_get(const_cast<GstStructure**>(&meta.structure));
+}
+
+} // namespace
+
 GType tcam_statistics_meta_api_get_type(void)
 {
     static GType type;
@@ -39,7 +171,8 @@ static gboolean tcam_statistics_meta_init(GstMeta* meta,
     TcamStatisticsMeta* tcam = (TcamStatisticsMeta*)meta;
 
     tcam->structure = nullptr;
-    //gst_structure_new_empty("TcamStatistics");
+    tcam->version = TCAM_STATISTICS_META_VERSION;
+    tcam->statistics = {};
 
     return TRUE;
 }
@@ -68,7 +201,12 @@ static gboolean tcam_statistics_meta_transform(GstBuffer* trans_buffer,
             return FALSE;
         }
 
-        trans_tcam->structure = gst_structure_copy(tcam->structure);
+        auto structure = load_structure(*tcam);
+        if (structure)
+        {
+            trans_tcam->structure = gst_structure_copy(structure);
+        }
+        trans_tcam->statistics = tcam->statistics;
     }
     return TRUE;
 }
@@ -110,7 +248,6 @@ TcamStatisticsMeta* gst_buffer_add_tcam_statistics_meta(GstBuffer* buffer, GstSt
 {
 
     g_return_val_if_fail(GST_IS_BUFFER(buffer), nullptr);
-    g_return_val_if_fail(statistics, nullptr);
 
 
     TcamStatisticsMeta* meta =
@@ -127,6 +264,75 @@ TcamStatisticsMeta* gst_buffer_add_tcam_statistics_meta(GstBuffer* buffer, GstSt
 }
 
 
+gboolean tcam_statistics_meta_get_statistics(const TcamStatisticsMeta* meta,
+                                             TcamStatistics* out_statistics)
+{
+    if (!meta || !out_statistics)
+    {
+        return FALSE;
+    }
+
+    *out_statistics = meta->statistics;
+
+    return TRUE;
+}
+
+
+void tcam_statistics_meta_set_statistics(TcamStatisticsMeta* meta,
+                                         const TcamStatistics* statistics)
+{
+    g_return_if_fail(meta);
+    g_return_if_fail(statistics);
+
+    meta->statistics = *statistics;
+
+    // the buffer is writable, nobody else can hold the old structure
+    if (meta->structure)
+    {
+        gst_structure_free(meta->structure);
+        meta->structure = nullptr;
+    }
+}
+
+
+const GstStructure* tcam_statistics_meta_get_structure(TcamStatisticsMeta* meta)
+{
+    g_return_val_if_fail(meta, nullptr);
+
+    // the buffer may be shared, e.g. after a tee, so several threads can get here at once
+    // the statistics of a shared buffer do not change, the structure is built once
+    // and published atomically. Whoever loses the race frees its copy.
+    auto structure = load_structure(*meta);
+    if (structure)
+    {
+        return structure;
+    }
+
+    GstStructure* created = create_structure(meta->statistics);
+    if (!g_atomic_pointer_compare_and_exchange(&meta->structure, nullptr, created))
+    {
+        gst_structure_free(created);
+    }
+
+    return load_structure(*meta);
+}
+
+
+GstStructure* tcam_statistics_meta_create_structure(const TcamStatisticsMeta* meta)
+{
+    g_return_val_if_fail(meta, nullptr);
+
+    // producers of version 1 only provide the structure
+    auto structure = load_structure(*meta);
+    if (structure)
+    {
+        return gst_structure_copy(structure);
+    }
+
+    return create_structure(meta->statistics);
+}
+
+
 gboolean tcam_statistics_get_structure(TcamStatisticsMeta* meta, char* out_buffer, size_t out_buffer_size)
 {
     if (!meta || !out_buffer)
@@ -134,7 +340,9 @@ gboolean tcam_statistics_get_structure(TcamStatisticsMeta* meta, char* out_buffe
         return FALSE;
     }
 
-    char* tmp =  gst_structure_to_string(meta->structure);
+    GstStructure* structure = tcam_statistics_meta_create_structure(meta);
+    char* tmp = gst_structure_to_string(structure);
+    gst_structure_free(structure);
 
     if (strlen(tmp) >= out_buffer_size)
     {
@@ -31,13 +31,78 @@ extern "C" {
 
 G_BEGIN_DECLS
 
+// version of the binary layout of TcamStatisticsMeta
+// 1: only structure
+// 2: statistics as plain values, structure is created on demand
+// 3: pipeline stage timestamps
+// 4: frames_dropped_size_mismatch, sequence_gap
+// 5: GigE packet statistics
+// 6: corrected_time_ns
+#define TCAM_STATISTICS_META_VERSION 6
+
+// plain copy of the stream statistics libtcam reports for each buffer
+// the GstStructure fields carry the same names
+//
+// The *_time_ns stage timestamps are CLOCK_MONOTONIC, the clock
+// gst_util_get_timestamp uses. 0 means the stage was not passed.
+typedef struct
+{
+    guint64 frame_count;
+    guint64 frames_dropped;
+    guint64 capture_time_ns;
+    guint64 camera_time_ns;
+    gboolean is_damaged;
+    guint buffer_count;
+    guint64 buffers_added;
+    guint64 buffers_removed;
+
+    // backend received the buffer from the driver/stream
+    guint64 dequeue_time_ns;
+    // libtcam applied the software properties
+    guint64 properties_done_time_ns;
+    // tcammainsrc queued the buffer for its streaming thread
+    guint64 queued_time_ns;
+    // tcammainsrc streaming thread took the buffer
+    guint64 acquired_time_ns;
+    // tcamconvert transform
+    guint64 convert_start_time_ns;
+    guint64 convert_end_time_ns;
+
+    // part of frames_dropped, images the driver delivered with an unexpected size
+    guint64 frames_dropped_size_mismatch;
+    // frames were dropped directly before this buffer
+    gboolean sequence_gap;
+
+    // GigE Vision packet statistics, 0 for other devices
+    // packets_resent, packets_missing and frames_lost count since stream start,
+    // frame_packets_* only while this image was received
+    guint64 packets_resent;
+    guint64 packets_missing;
+    guint64 frames_lost;
+    guint frame_packets_resent;
+    guint frame_packets_missing;
+    guint packet_size;
+    guint64 packet_delay_ns;
+
+    // camera_time_ns mapped to the host clock, CLOCK_REALTIME or CLOCK_TAI
+    // 0 when the camera time can not be mapped
+    guint64 corrected_time_ns;
+} TcamStatistics;
+
 typedef struct _GstMetaTcamStatistics TcamStatisticsMeta;
 
 struct _GstMetaTcamStatistics
 {
     GstMeta meta;
 
+    // nullptr until tcam_statistics_meta_get_structure has been called
+    // use the statistics member or tcam_statistics_meta_get_statistics instead
     GstStructure* structure;
+
+    // TCAM_STATISTICS_META_VERSION of the producer
+    guint version;
+    // has to stay the last member, new fields are appended to TcamStatistics
+    TcamStatistics statistics;
 };
 
 // registering out metadata API definition
@@ -52,9 +117,31 @@ GType tcam_statistics_meta_api_get_type(void);
 const GstMetaInfo* tcam_statistics_meta_get_info(void);
 #define TCAM_STATISTICS_META_INFO (tcam_statistics_meta_get_info())
 
+// statistics may be nullptr, the structure is then created on demand
+// the meta takes ownership of statistics
 TcamStatisticsMeta* gst_buffer_add_tcam_statistics_meta(GstBuffer* buffer,
                                                         GstStructure* statistics);
 
+// copies the statistics, no GstStructure is touched
+// returns FALSE when meta is nullptr
+gboolean tcam_statistics_meta_get_statistics(const TcamStatisticsMeta* meta,
+                                             TcamStatistics* out_statistics);
+
+// replaces the statistics, the buffer of meta has to be writable
+// the structure is recreated with the next call to tcam_statistics_meta_get_structure
+void tcam_statistics_meta_set_statistics(TcamStatisticsMeta* meta,
+                                         const TcamStatistics* statistics);
+
+// returns the statistics as GstStructure
+// the structure is created on the first call and owned by the meta
+// safe to call concurrently on shared buffers
+const GstStructure* tcam_statistics_meta_get_structure(TcamStatisticsMeta* meta);
+
+// returns a new GstStructure with the statistics, free it with gst_structure_free
+// does not modify meta
+GstStructure* tcam_statistics_meta_create_structure(const TcamStatisticsMeta* meta);
+
+// writes the serialized statistics structure into out_buffer
 gboolean tcam_statistics_get_structure(TcamStatisticsMeta*, char* out_buffer, size_t out_buffer_size);
 
 G_END_DECLS
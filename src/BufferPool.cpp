@@ -64,7 +64,9 @@ outcome::result<void> tcam::BufferPool::allocate(const VideoFormat& format,
 
     for (auto& m : memory)
     {
-        buffer_.push_back(std::make_shared<ImageBuffer>(format, m));
+        auto buf = std::make_shared<ImageBuffer>(format, m);
+        buf->set_pool_index(buffer_.size());
+        buffer_.push_back(buf);
     }
 
     return outcome::success();
@@ -72,6 +74,16 @@ outcome::result<void> tcam::BufferPool::allocate(const VideoFormat& format,
 
 outcome::result<void> tcam::BufferPool::allocate()
 {
+    if (memory_type_ == TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        // memory is provided via import_memory
+        if (buffer_.size() != count_)
+        {
+            libtcam::logger()->error("Imported {} of {} required buffer", buffer_.size(), count_);
+            return status::UndefinedError;
+        }
+        return outcome::success();
+    }
 
     auto memory = allocator_->allocate(count_, memory_type_, format_.get_required_buffer_size());
 
@@ -86,17 +98,214 @@ outcome::result<void> tcam::BufferPool::allocate()
 
     for (auto& m : memory)
     {
-        buffer_.push_back(std::make_shared<ImageBuffer>(format_, m));
+        auto buf = std::make_shared<ImageBuffer>(format_, m);
+        buf->set_pool_index(buffer_.size());
+        buffer_.push_back(buf);
+    }
+
+    return outcome::success();
+}
+
+
+outcome::result<void> tcam::BufferPool::import_memory(
+    std::vector<std::shared_ptr<Memory>> memory)
+{
+    if (memory_type_ != TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        libtcam::logger()->error("Memory can only be imported for TCAM_MEMORY_TYPE_DMA_IMPORT");
+        return status::UndefinedError;
+    }
+
+    buffer_.clear();
+    buffer_.reserve(memory.size());
+
+    for (auto& m : memory)
+    {
+        if (m->length() < format_.get_required_buffer_size())
+        {
+            libtcam::logger()->error("Imported buffer is too small. Has {} bytes, requires {}",
+                                     m->length(),
+                                     format_.get_required_buffer_size());
+            buffer_.clear();
+            return status::UndefinedError;
+        }
+
+        auto buf = std::make_shared<ImageBuffer>(format_, m);
+        buf->set_pool_index(buffer_.size());
+        buffer_.push_back(buf);
+    }
+
+    count_ = buffer_.size();
+
+    return outcome::success();
+}
+
+
+void tcam::BufferPool::set_max_count(size_t max_count)
+{
+    std::scoped_lock lck(mtx_);
+    max_count_ = max_count;
+}
+
+
+size_t tcam::BufferPool::get_max_count() const
+{
+    std::scoped_lock lck(mtx_);
+    return std::max(max_count_, buffer_.size());
+}
+
+
+bool tcam::BufferPool::can_grow() const
+{
+    std::scoped_lock lck(mtx_);
+
+    return can_grow_unlocked();
+}
+
+
+bool tcam::BufferPool::can_grow_unlocked() const
+{
+    if (memory_type_ != TCAM_MEMORY_TYPE_USERPTR)
+    {
+        return false;
+    }
+
+    return get_active_count_unlocked() < max_count_;
+}
+
+
+tcam::BufferPool::action tcam::BufferPool::update_queue_level(size_t queued_count)
+{
+    // max_count_ may be changed by set_max_count from another thread
+    std::scoped_lock lck(mtx_);
+
+    if (max_count_ <= count_ || memory_type_ != TCAM_MEMORY_TYPE_USERPTR)
+    {
+        return action::none;
+    }
+
+    if (queued_count == 0)
+    {
+        min_queue_level_ = SIZE_MAX;
+        frames_in_window_ = 0;
+
+        if (can_grow_unlocked())
+        {
+            return action::grow;
+        }
+        return action::none;
+    }
+
+    min_queue_level_ = std::min(min_queue_level_, queued_count);
+
+    if (++frames_in_window_ < shrink_window_)
+    {
+        return action::none;
+    }
+
+    // at least two buffers were never needed during the whole window
+    const bool is_idle = min_queue_level_ >= 2;
+
+    min_queue_level_ = SIZE_MAX;
+    frames_in_window_ = 0;
+
+    if (is_idle && get_active_count_unlocked() > count_)
+    {
+        return action::shrink;
     }
+    return action::none;
+}
+
+
+outcome::result<std::shared_ptr<tcam::ImageBuffer>> tcam::BufferPool::grow()
+{
+    if (!can_grow())
+    {
+        return status::UndefinedError;
+    }
+
+    auto memory = allocator_->allocate(1, memory_type_, format_.get_required_buffer_size());
+
+    if (memory.size() != 1)
+    {
+        libtcam::logger()->error("Unable to allocate additional buffer");
+        return status::UndefinedError;
+    }
+
+    std::scoped_lock lck(mtx_);
+
+    ++grow_count_;
+
+    for (auto& buf : buffer_)
+    {
+        if (!buf->has_memory())
+        {
+            buf->set_memory(memory.at(0));
+            return buf;
+        }
+    }
+
+    auto buf = std::make_shared<ImageBuffer>(format_, memory.at(0));
+    buf->set_pool_index(buffer_.size());
+    buffer_.push_back(buf);
+
+    return buf;
+}
+
+
+outcome::result<void> tcam::BufferPool::shrink(const std::shared_ptr<ImageBuffer>& buffer)
+{
+    std::scoped_lock lck(mtx_);
+
+    const int index = buffer->get_pool_index();
+    if (index < 0 || (size_t)index >= buffer_.size() || buffer_.at(index) != buffer)
+    {
+        return status::UndefinedError;
+    }
+
+    buffer->set_memory(nullptr);
+    ++shrink_count_;
 
     return outcome::success();
 }
 
 
+size_t tcam::BufferPool::get_active_count() const
+{
+    std::scoped_lock lck(mtx_);
+
+    return get_active_count_unlocked();
+}
+
+
+size_t tcam::BufferPool::get_active_count_unlocked() const
+{
+    return std::count_if(
+        buffer_.begin(), buffer_.end(), [](const auto& b) { return b->has_memory(); });
+}
+
+
+void tcam::BufferPool::fill_statistics(tcam_stream_statistics& stats) const
+{
+    std::scoped_lock lck(mtx_);
+
+    stats.buffer_count = get_active_count_unlocked();
+    stats.buffers_added = grow_count_;
+    stats.buffers_removed = shrink_count_;
+}
+
+
 outcome::result<void> tcam::BufferPool::clear()
 {
+    std::scoped_lock lck(mtx_);
+
     buffer_.clear();
 
+    grow_count_ = 0;
+    shrink_count_ = 0;
+    min_queue_level_ = SIZE_MAX;
+    frames_in_window_ = 0;
+
     return outcome::success();
 }
 
@@ -22,6 +22,7 @@
 #include "error.h"
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace tcam
@@ -33,18 +34,46 @@ namespace tcam
 // some backends need to configure the format 
 // BEFORE any memory can be allocated (e.g. v4l2::mmap)
 // setting a format may invalidate queued memory
+//
+// With set_max_count the pool can grow up to a max count when the
+// backend runs out of buffers and shrink back to the min count
+// when buffers stay idle. Backends ask update_queue_level what to do.
+// Growing is only supported for TCAM_MEMORY_TYPE_USERPTR as all
+// other types are allocated by the device in one go.
 class BufferPool
 {
+public:
+    enum class action
+    {
+        none,
+        grow,
+        shrink,
+    };
 
 private:
 
     size_t count_ = 0;
+    size_t max_count_ = 0;
+
+    // number of frames over which the queue level is observed before shrinking
+    static constexpr uint64_t shrink_window_ = 300;
+    size_t min_queue_level_ = SIZE_MAX;
+    uint64_t frames_in_window_ = 0;
+
+    uint64_t grow_count_ = 0;
+    uint64_t shrink_count_ = 0;
+
+    mutable std::mutex mtx_;
     TCAM_MEMORY_TYPE memory_type_ = TCAM_MEMORY_TYPE_USERPTR;
     tcam::VideoFormat format_;
     std::shared_ptr<AllocatorInterface> allocator_ = nullptr;
 
     std::vector<std::shared_ptr<ImageBuffer>> buffer_;
 
+    // caller has to hold mtx_
+    bool can_grow_unlocked() const;
+    size_t get_active_count_unlocked() const;
+
 public:
     BufferPool(TCAM_MEMORY_TYPE, std::shared_ptr<AllocatorInterface>);
     ~BufferPool();
@@ -55,6 +84,14 @@ public:
     outcome::result<void> allocate();
     outcome::result<void> clear();
 
+    // use externally owned memory instead of allocating it
+    // only valid for TCAM_MEMORY_TYPE_DMA_IMPORT
+    // has to be called after configure
+    // allocate() will then keep the imported memory
+    outcome::result<void> import_memory(std::vector<std::shared_ptr<Memory>> memory);
+
+    // the position of each buffer in the returned vector
+    // is identical with ImageBuffer::get_pool_index()
     std::vector<std::weak_ptr<ImageBuffer>> get_buffer();
 
     TCAM_MEMORY_TYPE get_memory_type() const
@@ -62,6 +99,32 @@ public:
         return memory_type_;
     }
 
+    // min_count is the count given to configure
+    // max_count <= min_count disables growing
+    void set_max_count(size_t max_count);
+    // upper bound for the number of slots get_buffer() may contain while streaming
+    size_t get_max_count() const;
+
+    bool can_grow() const;
+
+    // the backend reports how many buffers it currently holds for capture
+    // after each frame. The returned action should be applied
+    // via grow() or, for action::shrink, by calling shrink() with
+    // the next buffer that is requeued.
+    action update_queue_level(size_t queued_count);
+
+    // adds a buffer, reuses slots released by shrink first
+    // new slots receive the next pool index
+    outcome::result<std::shared_ptr<ImageBuffer>> grow();
+
+    // releases the memory of buffer, the slot is kept for later growth
+    outcome::result<void> shrink(const std::shared_ptr<ImageBuffer>& buffer);
+
+    // number of buffers that currently have memory
+    size_t get_active_count() const;
+
+    void fill_statistics(tcam_stream_statistics& stats) const;
+
 }; // class BufferPool
 
 } // namespace tcam
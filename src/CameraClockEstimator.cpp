@@ -0,0 +1,122 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CameraClockEstimator.h"
+
+#include "logging.h"
+
+#include <algorithm>
+
+using namespace tcam;
+
+namespace
+{
+
+// larger deviations from the current estimate are treated as a new time base
+const double max_prediction_error_ns = 10'000'000.0;
+
+// samples may have this much more uncertainty than the best one in the window
+const uint64_t uncertainty_tolerance_ns = 20'000;
+
+} // namespace
+
+
+CameraClockEstimator::CameraClockEstimator(size_t window)
+    : window_(std::max<size_t>(window, 2)), fit_(window_, max_prediction_error_ns)
+{
+}
+
+
+void CameraClockEstimator::reset()
+{
+    std::scoped_lock lck(mtx_);
+
+    fit_.reset();
+    uncertainties_.clear();
+}
+
+
+void CameraClockEstimator::add_sample(uint64_t camera_ns,
+                                      uint64_t host_before_ns,
+                                      uint64_t host_after_ns)
+{
+    if (camera_ns == 0 || host_after_ns < host_before_ns)
+    {
+        return;
+    }
+
+    // the camera latched somewhere within the round trip
+    const uint64_t uncertainty = (host_after_ns - host_before_ns) / 2;
+    const uint64_t host = host_before_ns + uncertainty;
+
+    std::scoped_lock lck(mtx_);
+
+    if (!fit_.empty() && fit_.is_new_base(camera_ns, host))
+    {
+        libtcam::logger()->debug("Camera time base changed. Restarting clock estimation.");
+
+        fit_.reset();
+        // the round trips before the change do not tell anything about the new time base
+        uncertainties_.clear();
+    }
+
+    uncertainties_.push_back(uncertainty);
+    while (uncertainties_.size() > window_) { uncertainties_.pop_front(); }
+
+    const uint64_t best = *std::min_element(uncertainties_.begin(), uncertainties_.end());
+    if (uncertainty > 2 * best + uncertainty_tolerance_ns)
+    {
+        return;
+    }
+
+    fit_.add(camera_ns, host);
+}
+
+
+uint64_t CameraClockEstimator::to_host_time(uint64_t camera_ns) const
+{
+    if (camera_ns == 0)
+    {
+        return 0;
+    }
+
+    std::scoped_lock lck(mtx_);
+
+    return fit_.to_host(camera_ns);
+}
+
+
+uint64_t CameraClockEstimator::now(clockid_t clock_id)
+{
+    timespec ts = {};
+    clock_gettime(clock_id, &ts);
+
+    return (uint64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+}
+
+
+std::optional<clockid_t> CameraClockEstimator::clock_from_name(std::string_view name)
+{
+    if (name == "realtime")
+    {
+        return CLOCK_REALTIME;
+    }
+    if (name == "tai")
+    {
+        return CLOCK_TAI;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "ClockFit.h"
+#include "compiler_defines.h"
+
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+//
+// Maps camera timestamps to a host clock
+//
+// The estimator is fed with pairs of a latched camera time and the host time
+// the latch was triggered at. Image receive times are not used, they contain
+// exposure, readout and transfer time and would bias the offset.
+//
+// Offset and drift are a tcam::ClockFit over the last samples.
+// Samples with a large round trip are ignored, their host time is imprecise.
+// A camera time that jumps (TimestampReset, PTP step) restarts the estimation.
+//
+class CameraClockEstimator
+{
+public:
+    // window - number of samples the drift is estimated from
+    explicit CameraClockEstimator(size_t window = 16);
+
+    void reset();
+
+    // camera_ns - latched camera time
+    // host_before_ns/host_after_ns - host clock directly before triggering the latch
+    // and after the camera acknowledged it
+    void add_sample(uint64_t camera_ns, uint64_t host_before_ns, uint64_t host_after_ns);
+
+    // 0 when no estimate is available yet
+    uint64_t to_host_time(uint64_t camera_ns) const;
+
+    // current time of clock_id in ns, e.g. CLOCK_REALTIME or CLOCK_TAI
+    static uint64_t now(clockid_t clock_id);
+
+    // host clock for a TCAM_CAMERA_CLOCK value, "realtime" or "tai"
+    static std::optional<clockid_t> clock_from_name(std::string_view name);
+
+private:
+    const size_t window_;
+
+    mutable std::mutex mtx_;
+    ClockFit fit_;
+    // half round trips of the last samples, including the ignored ones
+    std::deque<uint64_t> uncertainties_;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -48,6 +48,12 @@ bool CaptureDevice::register_device_lost_callback(tcam_device_lost_callback call
     return impl->register_device_lost_callback(callback, user_data);
 }
 
+bool CaptureDevice::register_property_changed_callback(tcam_property_changed_callback callback,
+                                                       void* user_data)
+{
+    return impl->register_property_changed_callback(callback, user_data);
+}
+
 
 std::vector<std::shared_ptr<tcam::property::IPropertyBase>> CaptureDevice::get_properties()
 {
@@ -114,6 +120,27 @@ void CaptureDevice::set_drop_incomplete_frames(bool b)
     impl->set_drop_incomplete_frames(b);
 }
 
+bool CaptureDevice::set_chunk_selection(const std::vector<std::string>& chunks)
+{
+    return impl->set_chunk_selection(chunks);
+}
+
+void CaptureDevice::begin_property_batch()
+{
+    impl->begin_property_batch();
+}
+
+outcome::result<void> CaptureDevice::commit_property_batch()
+{
+    return impl->commit_property_batch();
+}
+
+outcome::result<void> CaptureDevice::commit_property_batch(
+    std::vector<tcam::property::batch_write_failure>& failed)
+{
+    return impl->commit_property_batch(failed);
+}
+
 outcome::result<tcam::framerate_info> CaptureDevice::get_framerate_info(const VideoFormat& fmt)
 {
     return impl->get_framerate_info(fmt);
@@ -124,6 +151,11 @@ std::shared_ptr<tcam::AllocatorInterface> CaptureDevice::get_allocator()
     return impl->get_allocator();
 }
 
+std::shared_ptr<StreamMetrics> CaptureDevice::get_metrics() const
+{
+    return impl->get_metrics();
+}
+
 std::shared_ptr<CaptureDevice> tcam::open_device(const std::string& serial, TCAM_DEVICE_TYPE type)
 {
     auto _open = [](const DeviceInfo& info) -> std::shared_ptr<CaptureDevice> {
@@ -37,6 +37,7 @@ namespace tcam
 class AllocatorInterface;
 class BufferPool;
 class CaptureDeviceImpl;
+class StreamMetrics;
 
 class CaptureDevice
 {
@@ -68,12 +69,30 @@ public:
 
     bool register_device_lost_callback(tcam_device_lost_callback callback, void* user_data);
 
+    /**
+     * callback is called when the device itself reports a changed property value
+     * Own writes are not reported. The callback may be called from the stream thread.
+     */
+    bool register_property_changed_callback(tcam_property_changed_callback callback,
+                                            void* user_data);
+
 
     // property related:
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties();
     std::shared_ptr<tcam::property::IPropertyBase> get_property(const std::string& name);
 
+    /**
+     * Collect property writes until commit_property_batch.
+     * Devices that support it apply all of them at once, e.g. v4l2 with one ioctl.
+     * Calls may nest.
+     * The properties the device rejected are added to failed.
+     */
+    void begin_property_batch();
+    outcome::result<void> commit_property_batch();
+    outcome::result<void> commit_property_batch(
+        std::vector<tcam::property::batch_write_failure>& failed);
+
 
     // videoformat related:
 
@@ -123,8 +142,20 @@ public:
 
     void set_drop_incomplete_frames(bool b);
 
+    /**
+     * Select the chunk data the device appends to images, see tcam_stream_statistics::chunks.
+     * Has to be called before configure_stream.
+     * @return false if the device does not support one of the chunks
+     */
+    bool set_chunk_selection(const std::vector<std::string>& chunks);
+
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
+    /**
+     * @return aggregated stream metrics of this device, always valid while the device is open
+     */
+    std::shared_ptr<StreamMetrics> get_metrics() const;
+
 private:
     std::shared_ptr<CaptureDeviceImpl> impl;
 
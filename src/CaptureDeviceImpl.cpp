@@ -17,6 +17,7 @@
 #include "CaptureDeviceImpl.h"
 
 #include "logging.h"
+#include "utils.h"
 
 #include <exception>
 
@@ -79,6 +80,13 @@ CaptureDeviceImpl::CaptureDeviceImpl(const DeviceInfo& device_desc)
     }
     const auto serial = device_->get_device_description().get_serial();
     index_.register_device_lost(deviceindex_lost_cb, this, serial);
+
+    // values are reset when a stream is started, see start_stream
+    metrics_ = StreamMetrics::open(serial);
+    if (metrics_)
+    {
+        device_->set_stream_metrics(metrics_);
+    }
 }
 
 CaptureDeviceImpl::~CaptureDeviceImpl()
@@ -90,6 +98,13 @@ CaptureDeviceImpl::~CaptureDeviceImpl()
     index_.remove_device_lost(deviceindex_lost_cb);
 
     device_.reset();
+
+    if (metrics_)
+    {
+        // nobody will update them anymore
+        // only done when this process streamed, see StreamMetrics::claim
+        metrics_->unlink();
+    }
 }
 
 bool CaptureDeviceImpl::is_device_open() const
@@ -110,6 +125,12 @@ bool CaptureDeviceImpl::register_device_lost_callback(tcam_device_lost_callback
     return device_->register_device_lost_callback(callback, user_data);
 }
 
+bool CaptureDeviceImpl::register_property_changed_callback(tcam_property_changed_callback callback,
+                                                           void* user_data)
+{
+    return device_->register_property_changed_callback(callback, user_data);
+}
+
 void CaptureDeviceImpl::deviceindex_lost_cb(const DeviceInfo& info, void* user_data)
 {
     auto self = (CaptureDeviceImpl*)user_data;
@@ -223,6 +244,11 @@ bool CaptureDeviceImpl::start_stream()
         return false;
     }
 
+    if (metrics_)
+    {
+        metrics_->claim();
+    }
+
     if (!device_->start_stream(shared_from_this()))
     {
         libtcam::logger()->error("Unable to start stream from device.");
@@ -246,16 +272,69 @@ void CaptureDeviceImpl::set_drop_incomplete_frames(bool b)
     device_->set_drop_incomplete_frames(b);
 }
 
+bool CaptureDeviceImpl::set_chunk_selection(const std::vector<std::string>& chunks)
+{
+    return device_->set_chunk_selection(chunks);
+}
+
 void CaptureDeviceImpl::push_image(const std::shared_ptr<ImageBuffer>& buffer)
 {
+    auto stats = buffer->get_statistics();
+
+    // backends that do not take their own timestamp
+    if (stats.dequeue_time_ns == 0)
+    {
+        stats.dequeue_time_ns = get_monotonic_time_ns();
+    }
+
     if (apply_software_properties_)
     {
+        // auto algorithms may change exposure and gain together
+        // both have to reach the device for the same image
+        property_batch_guard batch(*device_);
         property_filter_.apply(*buffer);
+        std::vector<tcam::property::batch_write_failure> failed;
+        if (auto res = batch.commit(failed); !res)
+        {
+            libtcam::logger()->warn("Unable to write auto function results: {}",
+                                    res.error().message());
+        }
+        for (const auto& f : failed)
+        {
+            libtcam::logger()->warn("Unable to write auto function result for '{}': {}",
+                                    f.name,
+                                    f.error.message());
+        }
+    }
+
+    stats.properties_done_time_ns = get_monotonic_time_ns();
+    buffer->set_statistics(stats);
+
+    if (metrics_)
+    {
+        metrics_->record_dequeue_to_push(stats.properties_done_time_ns - stats.dequeue_time_ns);
     }
 
     sink_->push_image(buffer);
 }
 
+void CaptureDeviceImpl::begin_property_batch()
+{
+    device_->begin_property_batch();
+}
+
+outcome::result<void> CaptureDeviceImpl::commit_property_batch()
+{
+    std::vector<tcam::property::batch_write_failure> failed;
+    return device_->commit_property_batch(failed);
+}
+
+outcome::result<void> CaptureDeviceImpl::commit_property_batch(
+    std::vector<tcam::property::batch_write_failure>& failed)
+{
+    return device_->commit_property_batch(failed);
+}
+
 outcome::result<tcam::framerate_info> CaptureDeviceImpl::get_framerate_info(const VideoFormat& fmt)
 {
     return device_->get_framerate_info(fmt);
@@ -24,6 +24,7 @@
 #include "VideoFormat.h"
 #include "PropertyFilter.h"
 #include "BufferPool.h"
+#include "StreamMetrics.h"
 
 #include <memory>
 #include <string>
@@ -67,10 +68,18 @@ public:
 
     bool register_device_lost_callback(tcam_device_lost_callback callback, void* user_data);
 
+    bool register_property_changed_callback(tcam_property_changed_callback callback,
+                                            void* user_data);
+
     // property related:
 
     std::vector<std::shared_ptr<tcam::property::IPropertyBase>> get_properties();
 
+    void begin_property_batch();
+    outcome::result<void> commit_property_batch();
+    outcome::result<void> commit_property_batch(
+        std::vector<tcam::property::batch_write_failure>& failed);
+
     /**
      * @return vector containing all available video format settings
      */
@@ -121,10 +130,17 @@ public:
 
     void set_drop_incomplete_frames(bool b);
 
+    bool set_chunk_selection(const std::vector<std::string>& chunks);
+
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
     std::shared_ptr<tcam::AllocatorInterface> get_allocator();
 
+    std::shared_ptr<StreamMetrics> get_metrics() const
+    {
+        return metrics_;
+    }
+
 private:
     void push_image(const std::shared_ptr<ImageBuffer>& buffer) final;
 
@@ -150,6 +166,8 @@ private:
     bool apply_software_properties_ = true;
     tcam::stream::filter::SoftwarePropertyWrapper property_filter_;
 
+    std::shared_ptr<StreamMetrics> metrics_;
+
 }; /* class CaptureDeviceImpl */
 
 } /* namespace tcam */
@@ -0,0 +1,179 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ClockFit.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tcam;
+
+namespace
+{
+
+// anything outside is not clock drift but a broken fit
+constexpr double min_slope = 0.9;
+constexpr double max_slope = 1.1;
+
+} // namespace
+
+
+ClockFit::ClockFit(size_t window, double max_deviation_ns)
+    : window_(std::max<size_t>(window, 2)), max_deviation_ns_(max_deviation_ns)
+{
+    samples_.reserve(window_);
+}
+
+
+void ClockFit::reset()
+{
+    restart(0, 0);
+    last_device_ = 0;
+}
+
+
+void ClockFit::restart(uint64_t device_ns, uint64_t host_ns)
+{
+    samples_.clear();
+    oldest_ = 0;
+
+    base_device_ = device_ns;
+    base_host_ = host_ns;
+
+    sums_ref_ = {};
+    sum_x_ = 0.0;
+    sum_y_ = 0.0;
+    sum_xx_ = 0.0;
+    sum_xy_ = 0.0;
+    sums_age_ = 0;
+
+    slope_ = 1.0;
+    offset_ = 0.0;
+}
+
+
+bool ClockFit::add(uint64_t device_ns, uint64_t host_ns)
+{
+    const bool restarted = is_new_base(device_ns, host_ns);
+    if (restarted)
+    {
+        restart(device_ns, host_ns);
+    }
+    last_device_ = device_ns;
+
+    const sample s = { (double)(device_ns - base_device_), (double)(int64_t)(host_ns - base_host_) };
+
+    if (samples_.size() < window_)
+    {
+        samples_.push_back(s);
+    }
+    else
+    {
+        add_to_sums(samples_[oldest_], -1.0);
+        samples_[oldest_] = s;
+        oldest_ = (oldest_ + 1) % window_;
+    }
+
+    if (samples_.size() == 1 || ++sums_age_ >= window_)
+    {
+        rebuild_sums();
+    }
+    else
+    {
+        add_to_sums(s, 1.0);
+    }
+
+    update_fit();
+
+    return restarted;
+}
+
+
+bool ClockFit::is_new_base(uint64_t device_ns, uint64_t host_ns) const noexcept
+{
+    if (samples_.empty() || device_ns <= last_device_)
+    {
+        return true;
+    }
+
+    const double predicted = offset_ + slope_ * (double)(device_ns - base_device_);
+    const double actual = (double)(int64_t)(host_ns - base_host_);
+
+    return std::fabs(actual - predicted) > max_deviation_ns_;
+}
+
+
+void ClockFit::add_to_sums(const sample& s, double sign)
+{
+    const double x = s.device - sums_ref_.device;
+    const double y = s.host - sums_ref_.host;
+
+    sum_x_ += sign * x;
+    sum_y_ += sign * y;
+    sum_xx_ += sign * x * x;
+    sum_xy_ += sign * x * y;
+}
+
+
+void ClockFit::rebuild_sums()
+{
+    sums_ref_ = get_sample(0);
+
+    sum_x_ = 0.0;
+    sum_y_ = 0.0;
+    sum_xx_ = 0.0;
+    sum_xy_ = 0.0;
+    for (const auto& s : samples_) { add_to_sums(s, 1.0); }
+
+    sums_age_ = 0;
+}
+
+
+void ClockFit::update_fit()
+{
+    const double n = samples_.size();
+
+    double slope = 1.0;
+    const double denominator = n * sum_xx_ - sum_x_ * sum_x_;
+    if (denominator > 0.0)
+    {
+        slope = (n * sum_xy_ - sum_x_ * sum_y_) / denominator;
+    }
+    if (slope < min_slope || slope > max_slope)
+    {
+        slope = 1.0;
+    }
+
+    slope_ = slope;
+    // the line passes through the mean of the samples
+    const double mean_x = sums_ref_.device + sum_x_ / n;
+    const double mean_y = sums_ref_.host + sum_y_ / n;
+    offset_ = mean_y - slope * mean_x;
+}
+
+
+uint64_t ClockFit::to_host(uint64_t device_ns) const noexcept
+{
+    if (samples_.empty())
+    {
+        return 0;
+    }
+
+    const double device = (double)(int64_t)(device_ns - base_device_);
+    const double host = offset_ + slope_ * device;
+
+    return base_host_ + std::llround(host);
+}
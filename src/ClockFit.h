@@ -0,0 +1,132 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+//
+// Least squares fit of a host clock over a device clock
+//
+// Fits host = offset + slope * device over the last samples.
+// The sums of the fit are updated when a sample enters or leaves the window,
+// so add costs O(1) amortized.
+// A device time that does not increase or a host time that deviates from the
+// fit by more than max_deviation_ns starts a new time base, e.g. after a camera
+// reset or a PTP step. The fit then restarts with that sample.
+//
+// Used by tcam::CameraClockEstimator and timestamp-mode=device of tcammainsrc.
+//
+class ClockFit
+{
+public:
+    ClockFit(size_t window, double max_deviation_ns);
+
+    void reset();
+
+    // returns true when the sample started a new time base
+    bool add(uint64_t device_ns, uint64_t host_ns);
+
+    // true when add would restart the fit with this sample
+    bool is_new_base(uint64_t device_ns, uint64_t host_ns) const noexcept;
+
+    bool empty() const noexcept
+    {
+        return samples_.empty();
+    }
+    size_t size() const noexcept
+    {
+        return samples_.size();
+    }
+
+    // host clock ticks per device clock tick
+    // 1.0 as long as there are not enough samples
+    double get_slope() const noexcept
+    {
+        return slope_;
+    }
+
+    // device_ns on the fitted line, 0 when there are no samples
+    uint64_t to_host(uint64_t device_ns) const noexcept;
+
+    // first sample of the current time base
+    uint64_t get_base_device() const noexcept
+    {
+        return base_device_;
+    }
+    uint64_t get_base_host() const noexcept
+    {
+        return base_host_;
+    }
+
+    // relative to get_base_device/get_base_host to keep double precision
+    struct sample
+    {
+        double device;
+        double host;
+    };
+
+    // index 0 is the oldest sample in the window
+    const sample& get_sample(size_t index) const noexcept
+    {
+        return samples_[(oldest_ + index) % samples_.size()];
+    }
+
+private:
+    void restart(uint64_t device_ns, uint64_t host_ns);
+    void add_to_sums(const sample& s, double sign);
+    // recompute the sums relative to the oldest sample
+    // limits the rounding errors that add accumulates
+    void rebuild_sums();
+    void update_fit();
+
+    const size_t window_;
+    const double max_deviation_ns_;
+
+    // ring buffer, oldest_ is the next entry to be replaced once it is full
+    std::vector<sample> samples_;
+    size_t oldest_ = 0;
+
+    uint64_t base_device_ = 0;
+    uint64_t base_host_ = 0;
+    uint64_t last_device_ = 0;
+
+    // least squares sums of the window, relative to sums_ref_
+    sample sums_ref_ = {};
+    double sum_x_ = 0.0;
+    double sum_y_ = 0.0;
+    double sum_xx_ = 0.0;
+    double sum_xy_ = 0.0;
+    // samples added since the last rebuild_sums
+    size_t sums_age_ = 0;
+
+    double slope_ = 1.0;
+    // host at device == base_device_, relative to base_host_
+    double offset_ = 0.0;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -147,6 +147,43 @@ std::shared_ptr<DeviceInterface> tcam::open_device_interface(const DeviceInfo& d
     return nullptr;
 }
 
+tcam::property_batch_guard::property_batch_guard(DeviceInterface& dev) : dev_(dev)
+{
+    dev_.begin_property_batch();
+}
+
+
+tcam::property_batch_guard::~property_batch_guard()
+{
+    if (committed_)
+    {
+        return;
+    }
+
+    std::vector<tcam::property::batch_write_failure> failed;
+    if (auto res = commit(failed); !res)
+    {
+        libtcam::logger()->warn("Unable to write properties: {}", res.error().message());
+    }
+    for (const auto& f : failed)
+    {
+        libtcam::logger()->warn("Unable to write property '{}': {}", f.name, f.error.message());
+    }
+}
+
+
+outcome::result<void> tcam::property_batch_guard::commit(
+    std::vector<tcam::property::batch_write_failure>& failed)
+{
+    if (committed_)
+    {
+        return outcome::success();
+    }
+    committed_ = true;
+    return dev_.commit_property_batch(failed);
+}
+
+
 outcome::result<tcam::framerate_info> DeviceInterface::get_framerate_info(const VideoFormat& fmt)
 {
     for (auto&& desc : get_available_video_formats())
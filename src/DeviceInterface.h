@@ -23,11 +23,13 @@
 #include "Allocator.h"
 #include "PropertyInterfaces.h"
 #include "SinkInterface.h"
+#include "StreamMetrics.h"
 #include "VideoFormat.h"
 #include "VideoFormatDescription.h"
 #include "compiler_defines.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 VISIBILITY_INTERNAL
@@ -109,13 +111,53 @@ public:
         return true;
     }
 
+    bool register_property_changed_callback(tcam_property_changed_callback callback,
+                                            void* user_data)
+    {
+        property_changed_callbacks.push_back({ callback, user_data });
+
+        return true;
+    }
+
     void set_drop_incomplete_frames(bool b)
     {
         drop_incomplete_frames_ = b;
     }
 
+    // metrics the backend reports drops and buffer usage to
+    // has to be set before start_stream
+    void set_stream_metrics(std::shared_ptr<StreamMetrics> metrics)
+    {
+        metrics_ = std::move(metrics);
+    }
+
     virtual outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt);
 
+    /**
+     * Property writes between begin and commit may be collected and sent
+     * to the device together, so that they take effect on the same image.
+     * Errors of collected writes are reported by commit,
+     * the properties the device rejected are added to failed.
+     * The default implementation writes immediately.
+     */
+    virtual void begin_property_batch() {}
+    virtual outcome::result<void> commit_property_batch(
+        std::vector<tcam::property::batch_write_failure>& /*failed*/)
+    {
+        return outcome::success();
+    }
+
+    /**
+     * Select the chunk data the device shall append to each image,
+     * e.g. "ExposureTime" or "FrameID". Takes effect with the next stream.
+     * The values are reported in tcam_stream_statistics::chunks.
+     * @return false if the device does not support one of the chunks
+     */
+    virtual bool set_chunk_selection(const std::vector<std::string>& chunks)
+    {
+        return chunks.empty();
+    }
+
 protected:
     DeviceInfo device;
 
@@ -126,8 +168,16 @@ protected:
         for (const auto& cc : lost_callbacks) { cc.callback(&dev, cc.user_data); }
     }
 
+    void notify_property_changed(const std::string& name)
+    {
+        for (const auto& cc : property_changed_callbacks) { cc.callback(name.c_str(), cc.user_data); }
+    }
+
     bool drop_incomplete_frames_ = true;
 
+    // may be nullptr
+    std::shared_ptr<StreamMetrics> metrics_;
+
 private:
     struct callback_container
     {
@@ -136,9 +186,39 @@ private:
     };
 
     std::vector<callback_container> lost_callbacks;
+
+    struct property_changed_container
+    {
+        tcam_property_changed_callback callback;
+        void* user_data;
+    };
+
+    std::vector<property_changed_container> property_changed_callbacks;
 }; /* class Camera_Interface */
 
 
+/**
+ * Keeps a property batch of a device open for its lifetime.
+ * A batch that was not committed, e.g. because of an early return or an exception,
+ * is committed when the guard is destroyed. Its errors are only logged.
+ */
+class property_batch_guard
+{
+public:
+    explicit property_batch_guard(DeviceInterface& dev);
+    ~property_batch_guard();
+
+    property_batch_guard(const property_batch_guard&) = delete;
+    property_batch_guard& operator=(const property_batch_guard&) = delete;
+
+    outcome::result<void> commit(std::vector<tcam::property::batch_write_failure>& failed);
+
+private:
+    DeviceInterface& dev_;
+    bool committed_ = false;
+};
+
+
 /**
  * @brief open the device for the given DeviceInfo
  * @param device - device description for which an interface shall be created
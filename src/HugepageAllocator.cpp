@@ -0,0 +1,242 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "HugepageAllocator.h"
+
+#include "Memory.h"
+#include "logging.h"
+
+#include <cerrno>
+#include <cstring>
+#include <linux/mempolicy.h> /* MPOL_BIND */
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace tcam;
+
+namespace
+{
+
+// buffers inside an arena start on a page boundary
+// v4l2 userptr requires that for most drivers
+constexpr size_t buffer_alignment = 4096;
+
+size_t round_up(size_t value, size_t alignment)
+{
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+bool bind_to_numa_node(void* ptr, size_t length, int node)
+{
+    constexpr size_t bits_per_long = sizeof(unsigned long) * 8;
+
+    std::vector<unsigned long> mask(node / bits_per_long + 1, 0);
+    mask.at(node / bits_per_long) |= 1UL << (node % bits_per_long);
+
+    // glibc has no wrapper, libnuma is not worth the dependency for this
+    long ret = syscall(SYS_mbind,
+                       ptr,
+                       length,
+                       MPOL_BIND,
+                       mask.data(),
+                       mask.size() * bits_per_long + 1,
+                       MPOL_MF_STRICT | MPOL_MF_MOVE);
+    return ret == 0;
+}
+
+} // namespace
+
+
+tcam::HugepageAllocator::HugepageAllocator(const hugepage_allocator_config& config)
+    : config_(config)
+{
+    if (config_.page_size == 0 || (config_.page_size & (config_.page_size - 1)) != 0)
+    {
+        libtcam::logger()->warn("Invalid hugepage size {}. Using 2 MiB.", config_.page_size);
+        config_.page_size = 2 * 1024 * 1024;
+    }
+}
+
+
+tcam::HugepageAllocator::~HugepageAllocator()
+{
+    for (auto& a : arenas_) { release_arena(a); }
+}
+
+
+void* tcam::HugepageAllocator::create_arena(size_t length, size_t buffer_count)
+{
+    const size_t stride = round_up(length, buffer_alignment);
+    size_t arena_length = round_up(stride * buffer_count, config_.page_size);
+
+    int huge_flags = MAP_HUGETLB | (__builtin_ctzll(config_.page_size) << MAP_HUGE_SHIFT);
+
+    void* ptr = mmap(nullptr,
+                     arena_length,
+                     PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | huge_flags,
+                     -1,
+                     0);
+
+    if (ptr == MAP_FAILED)
+    {
+        libtcam::logger()->info(
+            "Unable to allocate {} bytes of hugepages with page size {}: {}. Falling back to "
+            "regular pages.",
+            arena_length,
+            config_.page_size,
+            strerror(errno));
+
+        arena_length = round_up(stride * buffer_count, buffer_alignment);
+
+        ptr = mmap(
+            nullptr, arena_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (ptr == MAP_FAILED)
+        {
+            libtcam::logger()->error("mmap failed ({}): {}", errno, strerror(errno));
+            return nullptr;
+        }
+
+        // let the kernel use transparent hugepages when it can
+        madvise(ptr, arena_length, MADV_HUGEPAGE);
+    }
+
+    // binding has to happen before the first touch of the memory
+    if (config_.numa_node >= 0 && !bind_to_numa_node(ptr, arena_length, config_.numa_node))
+    {
+        libtcam::logger()->warn(
+            "Unable to bind buffer memory to numa node {}: {}", config_.numa_node, strerror(errno));
+    }
+
+    if (config_.prefault)
+    {
+        volatile char* p = static_cast<char*>(ptr);
+        for (size_t offset = 0; offset < arena_length; offset += buffer_alignment)
+        {
+            p[offset] = 0;
+        }
+    }
+
+    if (config_.lock_memory && mlock(ptr, arena_length) != 0)
+    {
+        libtcam::logger()->warn("Unable to lock buffer memory: {}", strerror(errno));
+    }
+
+    std::scoped_lock lck(mtx_);
+    arenas_.push_back({ ptr, arena_length, buffer_count });
+
+    libtcam::logger()->debug("Created buffer arena of {} bytes for {} buffer(s)",
+                             arena_length,
+                             buffer_count);
+
+    return ptr;
+}
+
+
+void tcam::HugepageAllocator::release_arena(arena& a)
+{
+    if (!a.ptr)
+    {
+        return;
+    }
+
+    if (config_.lock_memory)
+    {
+        munlock(a.ptr, a.length);
+    }
+
+    if (munmap(a.ptr, a.length) == -1)
+    {
+        libtcam::logger()->error("munmap failed ({}): {}", errno, strerror(errno));
+    }
+    a.ptr = nullptr;
+    a.length = 0;
+}
+
+
+void* tcam::HugepageAllocator::allocate(TCAM_MEMORY_TYPE t, size_t length, int /*fd*/)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR)
+    {
+        return nullptr;
+    }
+    return create_arena(length, 1);
+}
+
+
+void tcam::HugepageAllocator::free(TCAM_MEMORY_TYPE, void* ptr, size_t, int /*fd*/)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    std::scoped_lock lck(mtx_);
+
+    auto iter = std::find_if(arenas_.begin(),
+                             arenas_.end(),
+                             [ptr](const arena& a)
+                             {
+                                 auto p = static_cast<char*>(ptr);
+                                 auto begin = static_cast<char*>(a.ptr);
+                                 return p >= begin && p < begin + a.length;
+                             });
+
+    if (iter == arenas_.end())
+    {
+        libtcam::logger()->error("Memory {} is not part of any buffer arena", fmt::ptr(ptr));
+        return;
+    }
+
+    if (--iter->in_use == 0)
+    {
+        release_arena(*iter);
+        arenas_.erase(iter);
+    }
+}
+
+
+std::vector<std::shared_ptr<Memory>> tcam::HugepageAllocator::allocate(size_t buffer_count,
+                                                                       TCAM_MEMORY_TYPE t,
+                                                                       size_t length,
+                                                                       int /*fd*/)
+{
+    if (t != TCAM_MEMORY_TYPE_USERPTR || buffer_count == 0)
+    {
+        return {};
+    }
+
+    auto base = static_cast<char*>(create_arena(length, buffer_count));
+    if (!base)
+    {
+        return {};
+    }
+
+    const size_t stride = round_up(length, buffer_alignment);
+
+    std::vector<std::shared_ptr<Memory>> buffers;
+    buffers.reserve(buffer_count);
+
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        buffers.push_back(std::make_shared<Memory>(
+            shared_from_this(), TCAM_MEMORY_TYPE_USERPTR, length, base + i * stride));
+    }
+
+    return buffers;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "Allocator.h"
+
+#include <cstdio> // size_t
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tcam
+{
+
+struct hugepage_allocator_config
+{
+    // size of the hugepages to use
+    // 2 MiB and 1 GiB are supported by x86_64
+    size_t page_size = 2 * 1024 * 1024;
+    // numa node the memory will be bound to, -1 for no binding
+    int numa_node = -1;
+    // touch all pages after allocation so that no page faults occur while streaming
+    bool prefault = true;
+    // lock the memory into RAM, requires CAP_IPC_LOCK or a sufficient RLIMIT_MEMLOCK
+    bool lock_memory = false;
+};
+
+//
+// Allocator for TCAM_MEMORY_TYPE_USERPTR
+// All buffers of one allocate(buffer_count, ...) call
+// are placed in one contiguous hugepage arena.
+// If no hugepages are available, regular pages with
+// transparent hugepage advice are used instead.
+// The arena is unmapped once all buffers have been freed.
+//
+class HugepageAllocator : public AllocatorInterface,
+                          public std::enable_shared_from_this<HugepageAllocator>
+{
+private:
+    struct arena
+    {
+        void* ptr = nullptr;
+        size_t length = 0;
+        size_t in_use = 0;
+    };
+
+    hugepage_allocator_config config_;
+
+    std::mutex mtx_;
+    std::vector<arena> arenas_;
+
+    void* create_arena(size_t length, size_t buffer_count);
+    void release_arena(arena& a);
+
+public:
+    explicit HugepageAllocator(const hugepage_allocator_config& config);
+    ~HugepageAllocator();
+
+    std::vector<TCAM_MEMORY_TYPE> get_supported_memory_types() const final
+    {
+        return { TCAM_MEMORY_TYPE_USERPTR };
+    }
+
+    void* allocate(TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+    void free(TCAM_MEMORY_TYPE, void* ptr, size_t, int fd = 0) final;
+
+    std::vector<std::shared_ptr<Memory>> allocate(size_t buffer_count,
+                                                  TCAM_MEMORY_TYPE,
+                                                  size_t,
+                                                  int fd = 0) final;
+};
+
+} // namespace tcam
@@ -83,6 +83,19 @@ public:
         return buffer_->ptr();
     }
 
+    /// @name get_file_descriptor
+    /// @brief Get the dmabuf file descriptor of the internal memory
+    /// @return file descriptor; -1 if memory is not exported
+    int get_file_descriptor() const noexcept
+    {
+        return buffer_->file_descriptor();
+    }
+
+    TCAM_MEMORY_TYPE get_memory_type() const noexcept
+    {
+        return buffer_->type();
+    }
+
     /// @name get_image_buffer_size
     /// @brief Get the size of the internal memory
     /// @return size_t - size of the internal memory
@@ -114,6 +127,33 @@ public:
         statistics_ = stats;
     }
 
+    /// @name get_pool_index
+    /// @brief Slot of this buffer inside the BufferPool that created it
+    /// @return index that is stable for the lifetime of the pool; -1 if not managed by a pool
+    int get_pool_index() const noexcept
+    {
+        return pool_index_;
+    }
+
+    void set_pool_index(int index) noexcept
+    {
+        pool_index_ = index;
+    }
+
+    /// @name has_memory
+    /// @return false if the memory was released by the BufferPool, e.g. when the pool shrinks
+    bool has_memory() const noexcept
+    {
+        return buffer_ != nullptr;
+    }
+
+    /// @name set_memory
+    /// @brief Replace the underlying memory. Only to be used by BufferPool.
+    void set_memory(std::shared_ptr<tcam::Memory> memory) noexcept
+    {
+        buffer_ = memory;
+    }
+
     /// @name copy_block
     /// @brief write data to the internal buffer
     /// @param data - pointer to the data that shall be written
@@ -129,6 +169,8 @@ private:
     size_t valid_data_length_ = 0;
     std::shared_ptr<Memory> buffer_ = nullptr;
 
+    int pool_index_ = -1;
+
     const bool is_own_memory_ = false;
 };
 
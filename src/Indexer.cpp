@@ -1,6 +1,7 @@
 
 #include "Indexer.h"
 
+#include "ThreadPolicy.h"
 #include "logging.h"
 #include "utils.h"
 #include "DeviceInterface.h"
@@ -61,7 +62,7 @@ std::shared_ptr<Indexer> Indexer::get_instance()
 
 void Indexer::update_device_list_thread()
 {
-    tcam::set_thread_name("tcam_indexer");
+    tcam::apply_thread_policy(tcam::thread_role::housekeeping, "tcam_indexer");
     auto first_list = fetch_device_list_backend();
 
     std::unique_lock<std::mutex> lock(mtx_);
@@ -24,8 +24,9 @@
 tcam::Memory::Memory(std::shared_ptr<AllocatorInterface> alloc,
                      TCAM_MEMORY_TYPE t,
                      size_t length,
-                     void* ptr)
-    : type_(t), ptr_(ptr), length_(length), allocator_(alloc)
+                     void* ptr,
+                     int fd)
+    : type_(t), ptr_(ptr), length_(length), fd_(fd), allocator_(alloc)
 {
     auto types = allocator_->get_supported_memory_types();
     if (std::find(types.begin(), types.end(), t) == types.end())
@@ -49,8 +50,9 @@ tcam::Memory::~Memory()
 {
     if (ptr_ && !external_)
     {
-        allocator_->free(type_, ptr_, length_);
+        allocator_->free(type_, ptr_, length_, fd_);
         ptr_ = nullptr;
         length_ = 0;
+        fd_ = -1;
     }
 }
@@ -56,17 +56,24 @@ public:
     //   t: Memory type to use
     //   length: size of the memory block
     //   ptr: Pointer to existing memory, optional
+    //   fd: file descriptor associated with ptr, optional
+    //       ownership is transferred, it will be passed to AllocatorInterface::free
     // throws:
     //   std::runtime_error in case of fatal error
     //
     Memory(std::shared_ptr<AllocatorInterface> alloc,
            TCAM_MEMORY_TYPE t,
            size_t length,
-           void* ptr = nullptr);
+           void* ptr = nullptr,
+           int fd = -1);
 
-    // Memory(TCAM_MEMORY_TYPE t, void* ptr, size_t length)
-    //     : type_(t), ptr_(ptr), length_(length), external_(true)
-    // {}
+    //
+    // Wrap memory that is owned by somebody else, e.g. imported dma buffers
+    // The memory is not freed upon destruction and fd is not closed
+    //
+    Memory(TCAM_MEMORY_TYPE t, size_t length, void* ptr, int fd = -1)
+        : type_(t), ptr_(ptr), length_(length), external_(true), fd_(fd)
+    {}
 
     ~Memory();
 
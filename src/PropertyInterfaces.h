@@ -47,6 +47,14 @@ public:
 };
 
 
+// A property whose collected write was rejected by the device
+struct batch_write_failure
+{
+    std::string name;
+    std::error_code error;
+};
+
+
 std::shared_ptr<tcam::property::IPropertyBase> find_property(
     const std::vector<std::shared_ptr<tcam::property::IPropertyBase>>& properties,
     std::string_view name);
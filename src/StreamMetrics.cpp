@@ -0,0 +1,417 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StreamMetrics.h"
+
+#include "logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace tcam;
+
+namespace
+{
+
+std::string shm_name_for_serial(const std::string& serial)
+{
+    // shm names may not contain further slashes
+    std::string name = "/tcam-metrics-" + serial;
+    for (size_t i = 1; i < name.size(); ++i)
+    {
+        if (name[i] == '/')
+        {
+            name[i] = '_';
+        }
+    }
+    return name;
+}
+
+
+bool is_process_running(int32_t pid) noexcept
+{
+    // EPERM - the process exists but belongs to another user
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+
+void update_max(std::atomic<uint64_t>& max, uint64_t value) noexcept
+{
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current
+           && !max.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+
+uint64_t percentile(const metrics_histogram& histogram, uint64_t count, double p) noexcept
+{
+    // rank of the value we are looking for, 1 based
+    uint64_t rank = (uint64_t)(p * count + 0.5);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < metrics_histogram::bucket_count; ++i)
+    {
+        seen += histogram.buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            return metrics_histogram::highest_value_of(i);
+        }
+    }
+    return histogram.max.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+
+const char* tcam::drop_cause_to_string(drop_cause cause)
+{
+    switch (cause)
+    {
+        case drop_cause::incomplete:
+            return "incomplete";
+        case drop_cause::starvation:
+            return "starvation";
+        case drop_cause::size_mismatch:
+            return "size-mismatch";
+        case drop_cause::driver:
+            return "driver";
+        case drop_cause::other:
+            return "other";
+    }
+    return "unknown";
+}
+
+
+size_t tcam::metrics_histogram::index_of(uint64_t value) noexcept
+{
+    if (value < sub_bucket_count)
+    {
+        return value;
+    }
+
+    const unsigned msb = 63 - __builtin_clzll(value);
+    const unsigned shift = msb - sub_bucket_bits;
+
+    return (shift + 1) * sub_bucket_count + ((value >> shift) & (sub_bucket_count - 1));
+}
+
+
+uint64_t tcam::metrics_histogram::lowest_value_of(size_t index) noexcept
+{
+    if (index < sub_bucket_count)
+    {
+        return index;
+    }
+
+    const unsigned shift = index / sub_bucket_count - 1;
+    const uint64_t sub = index % sub_bucket_count;
+
+    return (sub_bucket_count + sub) << shift;
+}
+
+
+uint64_t tcam::metrics_histogram::highest_value_of(size_t index) noexcept
+{
+    if (index + 1 >= bucket_count)
+    {
+        return UINT64_MAX;
+    }
+    return lowest_value_of(index + 1) - 1;
+}
+
+
+void tcam::metrics_histogram::record(uint64_t value) noexcept
+{
+    buckets[index_of(value)].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    update_max(max, value);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+metrics_histogram_summary tcam::summarize(const metrics_histogram& histogram)
+{
+    metrics_histogram_summary ret;
+
+    ret.count = histogram.count.load(std::memory_order_relaxed);
+    if (ret.count == 0)
+    {
+        return ret;
+    }
+
+    ret.mean = histogram.sum.load(std::memory_order_relaxed) / ret.count;
+    ret.max = histogram.max.load(std::memory_order_relaxed);
+    // recording may run concurrently, count and buckets are not a consistent snapshot
+    ret.p50 = std::min(percentile(histogram, ret.count, 0.50), ret.max);
+    ret.p90 = std::min(percentile(histogram, ret.count, 0.90), ret.max);
+    ret.p99 = std::min(percentile(histogram, ret.count, 0.99), ret.max);
+    ret.p999 = std::min(percentile(histogram, ret.count, 0.999), ret.max);
+
+    return ret;
+}
+
+
+tcam::StreamMetrics::StreamMetrics(std::string serial,
+                                   std::string shm_name,
+                                   stream_metrics_data* data,
+                                   bool owns_memory,
+                                   bool created_name)
+    : serial_(std::move(serial)), shm_name_(std::move(shm_name)), data_(data),
+      owns_memory_(owns_memory), created_name_(created_name)
+{
+}
+
+
+tcam::StreamMetrics::~StreamMetrics()
+{
+    if (owns_memory_)
+    {
+        delete data_;
+    }
+    else
+    {
+        munmap(data_, sizeof(stream_metrics_data));
+    }
+}
+
+
+std::shared_ptr<StreamMetrics> tcam::StreamMetrics::open(const std::string& serial)
+{
+    const std::string name = shm_name_for_serial(serial);
+
+    bool created = true;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 && errno == EEXIST)
+    {
+        created = false;
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    }
+
+    if (fd >= 0)
+    {
+        // new memory is zero filled, which is a valid empty state
+        if (ftruncate(fd, sizeof(stream_metrics_data)) == 0)
+        {
+            void* ptr = mmap(
+                nullptr, sizeof(stream_metrics_data), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+
+            if (ptr != MAP_FAILED)
+            {
+                auto data = static_cast<stream_metrics_data*>(ptr);
+                data->magic = stream_metrics_data::magic_value;
+                data->version = stream_metrics_data::current_version;
+
+                return std::shared_ptr<StreamMetrics>(
+                    new StreamMetrics(serial, name, data, false, created));
+            }
+        }
+        else
+        {
+            close(fd);
+        }
+
+        if (created)
+        {
+            const int err = errno;
+            shm_unlink(name.c_str());
+            errno = err;
+        }
+    }
+
+    libtcam::logger()->warn(
+        "Unable to share stream metrics for {}: {}. Metrics are only available in this process.",
+        serial,
+        strerror(errno));
+
+    auto data = new (std::nothrow) stream_metrics_data {};
+    if (!data)
+    {
+        return nullptr;
+    }
+    data->magic = stream_metrics_data::magic_value;
+    data->version = stream_metrics_data::current_version;
+
+    return std::shared_ptr<StreamMetrics>(new StreamMetrics(serial, {}, data, true));
+}
+
+
+std::shared_ptr<StreamMetrics> tcam::StreamMetrics::attach(const std::string& serial)
+{
+    const std::string name = shm_name_for_serial(serial);
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(stream_metrics_data))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* ptr =
+        mmap(nullptr, sizeof(stream_metrics_data), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto data = static_cast<stream_metrics_data*>(ptr);
+    if (data->magic != stream_metrics_data::magic_value
+        || data->version != stream_metrics_data::current_version)
+    {
+        munmap(ptr, sizeof(stream_metrics_data));
+        return nullptr;
+    }
+
+    return std::shared_ptr<StreamMetrics>(new StreamMetrics(serial, name, data, false));
+}
+
+
+std::shared_ptr<StreamMetrics> tcam::StreamMetrics::open_readonly(const std::string& serial)
+{
+    const std::string name = shm_name_for_serial(serial);
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(stream_metrics_data))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    void* ptr = mmap(nullptr, sizeof(stream_metrics_data), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    auto data = static_cast<stream_metrics_data*>(ptr);
+    if (data->magic != stream_metrics_data::magic_value
+        || data->version != stream_metrics_data::current_version)
+    {
+        munmap(ptr, sizeof(stream_metrics_data));
+        return nullptr;
+    }
+
+    return std::shared_ptr<StreamMetrics>(new StreamMetrics(serial, name, data, false));
+}
+
+
+bool tcam::StreamMetrics::claim() noexcept
+{
+    const int32_t self = getpid();
+
+    int32_t owner = data_->pid.load(std::memory_order_relaxed);
+    if (owner != self && is_process_running(owner))
+    {
+        libtcam::logger()->warn("Stream metrics of {} are owned by process {}. Not resetting them.",
+                                serial_,
+                                owner);
+        return false;
+    }
+
+    // another process may claim at the same time
+    if (!data_->pid.compare_exchange_strong(owner, self, std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    reset();
+    return true;
+}
+
+
+void tcam::StreamMetrics::reset() noexcept
+{
+    // the atomics are only written with relaxed ordering,
+    // readers may see a partially reset state
+    auto clear = [](metrics_histogram& h)
+    {
+        h.count.store(0, std::memory_order_relaxed);
+        h.sum.store(0, std::memory_order_relaxed);
+        h.max.store(0, std::memory_order_relaxed);
+        for (auto& b : h.buckets) { b.store(0, std::memory_order_relaxed); }
+    };
+
+    data_->frames_delivered.store(0, std::memory_order_relaxed);
+    for (auto& d : data_->drops) { d.store(0, std::memory_order_relaxed); }
+
+    clear(data_->dequeue_to_push_ns);
+    clear(data_->handoff_wait_ns);
+    clear(data_->convert_ns);
+    clear(data_->buffers_in_flight);
+
+    data_->packets_resent.store(0, std::memory_order_relaxed);
+    data_->packets_missing.store(0, std::memory_order_relaxed);
+    data_->frames_lost.store(0, std::memory_order_relaxed);
+    data_->packet_size.store(0, std::memory_order_relaxed);
+    data_->packet_delay_ns.store(0, std::memory_order_relaxed);
+    clear(data_->packets_resent_per_frame);
+}
+
+
+void tcam::StreamMetrics::unlink() noexcept
+{
+    if (shm_name_.empty())
+    {
+        return;
+    }
+
+    // a process that only had the device open must not remove the metrics of the stream
+    int32_t self = getpid();
+    if (data_->pid.compare_exchange_strong(self, 0, std::memory_order_relaxed))
+    {
+        shm_unlink(shm_name_.c_str());
+        return;
+    }
+
+    // nobody streamed, the name would otherwise stay in /dev/shm
+    // claiming it for the moment keeps another process from claiming it in between
+    int32_t unclaimed = 0;
+    if (created_name_
+        && data_->pid.compare_exchange_strong(unclaimed, self, std::memory_order_relaxed))
+    {
+        shm_unlink(shm_name_.c_str());
+        data_->pid.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+enum class drop_cause
+{
+    // image lost packets/lines and was dropped as requested
+    incomplete = 0,
+    // no buffer was available to store or hand over the image
+    starvation,
+    // image did not have the size of the active format
+    size_mismatch,
+    // the driver skipped frame sequence numbers, the frames never reached userspace
+    driver,
+    // timeouts, transfer errors and everything else
+    other,
+};
+
+constexpr size_t drop_cause_count = 5;
+
+const char* drop_cause_to_string(drop_cause cause);
+
+//
+// Log-linear histogram, as used by HdrHistogram
+//
+// Values are grouped by their highest bit, each group is split
+// into sub_bucket_count linear buckets. The relative error of
+// a reported value is thus at most 1/sub_bucket_count.
+// Recording is a few relaxed atomic operations, no locks, no allocations.
+// All zero is a valid empty histogram.
+//
+struct metrics_histogram
+{
+    static constexpr unsigned sub_bucket_bits = 3;
+    static constexpr size_t sub_bucket_count = 1 << sub_bucket_bits;
+    static constexpr size_t bucket_count = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+    std::atomic<uint64_t> buckets[bucket_count];
+
+    void record(uint64_t value) noexcept;
+
+    static size_t index_of(uint64_t value) noexcept;
+    // smallest value that is counted in bucket index
+    static uint64_t lowest_value_of(size_t index) noexcept;
+    // largest value that is counted in bucket index
+    static uint64_t highest_value_of(size_t index) noexcept;
+};
+
+struct metrics_histogram_summary
+{
+    uint64_t count = 0;
+    uint64_t mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    uint64_t max = 0;
+};
+
+// percentiles are reported as the upper bound of their bucket
+metrics_histogram_summary summarize(const metrics_histogram& histogram);
+
+// layout of the shared memory, readers have to check magic and version
+struct stream_metrics_data
+{
+    static constexpr uint32_t magic_value = 0x7463616d; // 'tcam'
+    static constexpr uint32_t current_version = 3;
+
+    uint32_t magic;
+    uint32_t version;
+    // process that currently owns the device
+    std::atomic<int32_t> pid;
+
+    std::atomic<uint64_t> frames_delivered;
+    std::atomic<uint64_t> drops[drop_cause_count];
+
+    // backend dequeue until libtcam hands the buffer to the sink
+    metrics_histogram dequeue_to_push_ns;
+    // tcammainsrc queued the buffer until its streaming thread took it
+    metrics_histogram handoff_wait_ns;
+    // duration of tcamconvert transformations
+    metrics_histogram convert_ns;
+    // buffers delivered by the backend and not yet requeued, sampled per frame
+    metrics_histogram buffers_in_flight;
+
+    // GigE Vision transport, stays 0 for other devices
+    std::atomic<uint64_t> packets_resent;
+    std::atomic<uint64_t> packets_missing;
+    std::atomic<uint64_t> frames_lost;
+    // current stream configuration
+    std::atomic<uint64_t> packet_size;
+    std::atomic<uint64_t> packet_delay_ns;
+    // resent packets per received image
+    metrics_histogram packets_resent_per_frame;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "stream_metrics_data is shared between processes");
+
+//
+// Always-on aggregated stream metrics of one device
+//
+// The data lives in POSIX shared memory named after the device serial.
+// The process that opened the device writes to it, other processes
+// (e.g. tcam-ctrl --metrics) can map it read-only at any time.
+// Other elements of the streaming process (e.g. tcamconvert) can attach
+// to the same serial to add their measurements.
+// Only the process that claimed the metrics for its stream (see pid)
+// resets them or removes the name. A process that created the name
+// and never streamed removes it as long as nobody claimed it.
+//
+class StreamMetrics
+{
+public:
+    // maps the metrics of serial, creates them if necessary
+    // falls back to process local memory when no shared memory is available
+    static std::shared_ptr<StreamMetrics> open(const std::string& serial);
+    // maps existing metrics of serial for writing, never creates them
+    // returns nullptr if no process published metrics for serial
+    static std::shared_ptr<StreamMetrics> attach(const std::string& serial);
+    // maps existing metrics of serial read-only
+    // returns nullptr if no process published metrics for serial
+    static std::shared_ptr<StreamMetrics> open_readonly(const std::string& serial);
+
+    StreamMetrics(const StreamMetrics&) = delete;
+    StreamMetrics& operator=(const StreamMetrics&) = delete;
+
+    ~StreamMetrics();
+
+    // zero all values and claim ownership for the calling process
+    // fails and changes nothing when another running process owns the metrics
+    bool claim() noexcept;
+    // remove the shared memory name if the calling process owns the metrics
+    // or created them and no process claimed them
+    // existing mappings stay valid
+    void unlink() noexcept;
+
+    void record_dequeue_to_push(uint64_t ns) noexcept
+    {
+        data_->dequeue_to_push_ns.record(ns);
+        data_->frames_delivered.fetch_add(1, std::memory_order_relaxed);
+    }
+    void record_handoff_wait(uint64_t ns) noexcept
+    {
+        data_->handoff_wait_ns.record(ns);
+    }
+    void record_convert(uint64_t ns) noexcept
+    {
+        data_->convert_ns.record(ns);
+    }
+    void record_buffers_in_flight(uint64_t count) noexcept
+    {
+        data_->buffers_in_flight.record(count);
+    }
+    void count_drop(drop_cause cause, uint64_t n = 1) noexcept
+    {
+        data_->drops[static_cast<size_t>(cause)].fetch_add(n, std::memory_order_relaxed);
+    }
+    void set_packet_config(uint64_t packet_size, uint64_t packet_delay_ns) noexcept
+    {
+        data_->packet_size.store(packet_size, std::memory_order_relaxed);
+        data_->packet_delay_ns.store(packet_delay_ns, std::memory_order_relaxed);
+    }
+    // resent/missing - packets of one image, lost - frames since the last call
+    void record_packets(uint64_t resent, uint64_t missing, uint64_t lost) noexcept
+    {
+        data_->packets_resent_per_frame.record(resent);
+        data_->packets_resent.fetch_add(resent, std::memory_order_relaxed);
+        data_->packets_missing.fetch_add(missing, std::memory_order_relaxed);
+        data_->frames_lost.fetch_add(lost, std::memory_order_relaxed);
+    }
+
+    const stream_metrics_data& data() const noexcept
+    {
+        return *data_;
+    }
+
+    const std::string& get_serial() const noexcept
+    {
+        return serial_;
+    }
+
+    // true if the memory is visible to other processes
+    bool is_shared() const noexcept
+    {
+        return shm_name_.size() > 0;
+    }
+
+private:
+    void reset() noexcept;
+
+    StreamMetrics(std::string serial,
+                  std::string shm_name,
+                  stream_metrics_data* data,
+                  bool owns_memory,
+                  bool created_name = false);
+
+    std::string serial_;
+    // empty when process local memory is used
+    std::string shm_name_;
+    stream_metrics_data* data_ = nullptr;
+    bool owns_memory_ = false;
+    // the shared memory name did not exist before open
+    bool created_name_ = false;
+};
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ThreadPolicy.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <pthread.h>
+
+using namespace tcam;
+
+namespace
+{
+
+using policy_config = std::array<std::optional<thread_policy>, thread_role_count>;
+
+const char* role_names[thread_role_count] = { "capture", "delivery", "housekeeping" };
+
+
+std::optional<int> parse_int(const std::string& str)
+{
+    if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return {};
+    }
+    try
+    {
+        return std::stoi(str);
+    }
+    catch (const std::exception&)
+    {
+        return {};
+    }
+}
+
+
+bool parse_cpus(const std::string& str, std::vector<int>& cpus)
+{
+    for (const auto& entry : tcam::split_string(str, ","))
+    {
+        auto dash = entry.find('-');
+        auto first = parse_int(entry.substr(0, dash));
+        auto last = dash == std::string::npos ? first : parse_int(entry.substr(dash + 1));
+
+        if (!first || !last || *first > *last || *last >= CPU_SETSIZE)
+        {
+            return false;
+        }
+
+        for (int cpu = *first; cpu <= *last; ++cpu) { cpus.push_back(cpu); }
+    }
+    return !cpus.empty();
+}
+
+
+// spec - <scheduler>[:<priority>][@<cpus>]
+bool parse_policy(const std::string& spec, thread_policy& policy)
+{
+    auto at = spec.find('@');
+    std::string sched = spec.substr(0, at);
+
+    if (at != std::string::npos && !parse_cpus(spec.substr(at + 1), policy.cpus))
+    {
+        return false;
+    }
+
+    std::string prio;
+    auto colon = sched.find(':');
+    if (colon != std::string::npos)
+    {
+        prio = sched.substr(colon + 1);
+        sched = sched.substr(0, colon);
+    }
+
+    if (sched == "other" || sched.empty())
+    {
+        policy.scheduler = SCHED_OTHER;
+        return prio.empty();
+    }
+    else if (sched == "fifo")
+    {
+        policy.scheduler = SCHED_FIFO;
+    }
+    else if (sched == "rr")
+    {
+        policy.scheduler = SCHED_RR;
+    }
+    else
+    {
+        return false;
+    }
+
+    auto value = parse_int(prio);
+    if (!value
+        || *value < sched_get_priority_min(policy.scheduler)
+        || *value > sched_get_priority_max(policy.scheduler))
+    {
+        return false;
+    }
+    policy.priority = *value;
+
+    return true;
+}
+
+
+std::optional<policy_config> parse_config(const std::string& description)
+{
+    policy_config config;
+
+    for (const auto& entry : tcam::split_string(description, ";"))
+    {
+        if (entry.empty())
+        {
+            continue;
+        }
+
+        auto eq = entry.find('=');
+        if (eq == std::string::npos)
+        {
+            return {};
+        }
+
+        std::string role = entry.substr(0, eq);
+        size_t index = 0;
+        while (index < thread_role_count && role != role_names[index]) { ++index; }
+
+        thread_policy policy;
+        if (index == thread_role_count || !parse_policy(entry.substr(eq + 1), policy))
+        {
+            return {};
+        }
+        config[index] = policy;
+    }
+    return config;
+}
+
+
+struct policy_state
+{
+    std::mutex mtx;
+    policy_config config;
+
+    policy_state()
+    {
+        auto env = tcam::get_environment_variable("TCAM_THREAD_POLICY", "");
+        if (env.empty())
+        {
+            return;
+        }
+
+        auto parsed = parse_config(env);
+        if (!parsed)
+        {
+            libtcam::logger()->warn("Ignoring invalid TCAM_THREAD_POLICY '{}'", env);
+            return;
+        }
+        config = *parsed;
+    }
+};
+
+
+policy_state& get_state()
+{
+    static policy_state state;
+    return state;
+}
+
+} // namespace
+
+
+bool tcam::set_thread_policies(const std::string& description)
+{
+    auto parsed = parse_config(description);
+    if (!parsed)
+    {
+        return false;
+    }
+
+    auto& state = get_state();
+    std::scoped_lock lck(state.mtx);
+    state.config = *parsed;
+
+    return true;
+}
+
+
+std::string tcam::get_thread_policies()
+{
+    auto& state = get_state();
+    std::scoped_lock lck(state.mtx);
+
+    std::string ret;
+    for (size_t i = 0; i < thread_role_count; ++i)
+    {
+        if (!state.config[i])
+        {
+            continue;
+        }
+        const auto& p = *state.config[i];
+
+        if (!ret.empty())
+        {
+            ret += ";";
+        }
+        ret += role_names[i];
+        ret += "=";
+
+        switch (p.scheduler)
+        {
+            case SCHED_FIFO:
+                ret += "fifo:" + std::to_string(p.priority);
+                break;
+            case SCHED_RR:
+                ret += "rr:" + std::to_string(p.priority);
+                break;
+            default:
+                ret += "other";
+                break;
+        }
+
+        for (size_t c = 0; c < p.cpus.size(); ++c)
+        {
+            ret += (c == 0 ? "@" : ",") + std::to_string(p.cpus[c]);
+        }
+    }
+    return ret;
+}
+
+
+std::optional<thread_policy> tcam::get_thread_policy(thread_role role)
+{
+    auto& state = get_state();
+    std::scoped_lock lck(state.mtx);
+
+    return state.config[static_cast<size_t>(role)];
+}
+
+
+bool tcam::apply_thread_policy(thread_role role, const char* name)
+{
+    tcam::set_thread_name(name);
+
+    auto policy = get_thread_policy(role);
+    if (!policy)
+    {
+        return true;
+    }
+
+    bool ret = true;
+
+    if (!policy->cpus.empty())
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : policy->cpus) { CPU_SET(cpu, &set); }
+
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0)
+        {
+            libtcam::logger()->warn("Unable to set cpu affinity of thread {}: {}", name, strerror(err));
+            ret = false;
+        }
+    }
+
+    sched_param param = {};
+    param.sched_priority = policy->scheduler == SCHED_OTHER ? 0 : policy->priority;
+
+    int err = pthread_setschedparam(pthread_self(), policy->scheduler, &param);
+    if (err != 0)
+    {
+        // EPERM without CAP_SYS_NICE or a matching RLIMIT_RTPRIO
+        libtcam::logger()->warn("Unable to set scheduling policy of thread {}: {}", name, strerror(err));
+        ret = false;
+    }
+
+    return ret;
+}
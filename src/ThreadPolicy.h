@@ -0,0 +1,80 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <optional>
+#include <sched.h>
+#include <string>
+#include <vector>
+
+VISIBILITY_DEFAULT
+
+namespace tcam
+{
+
+enum class thread_role
+{
+    // threads that wait for images of a device, e.g. the v4l2 stream thread
+    capture = 0,
+    // threads that hand images to the sinks
+    delivery,
+    // device monitoring, device indexing, etc.
+    housekeeping,
+};
+
+constexpr size_t thread_role_count = 3;
+
+struct thread_policy
+{
+    // SCHED_OTHER, SCHED_FIFO or SCHED_RR
+    int scheduler = SCHED_OTHER;
+    // 1-99 for SCHED_FIFO and SCHED_RR, ignored for SCHED_OTHER
+    int priority = 0;
+    // empty when the thread may run on all cpus
+    std::vector<int> cpus;
+};
+
+//
+// Process wide scheduling configuration of the libtcam threads
+//
+// Each role is described as <role>=<scheduler>[:<priority>][@<cpus>],
+// roles are separated by ';'. Schedulers are other, fifo and rr,
+// cpus are a comma separated list that may contain ranges.
+// Example: capture=fifo:50@2-3;delivery=rr:10@4;housekeeping=other@0
+//
+// Roles that are not described leave their threads untouched.
+// The initial configuration is read from TCAM_THREAD_POLICY.
+// Changes apply to threads that are started afterwards.
+//
+
+// returns false and keeps the current configuration when description is invalid
+bool set_thread_policies(const std::string& description);
+// current configuration in the format set_thread_policies accepts
+std::string get_thread_policies();
+
+std::optional<thread_policy> get_thread_policy(thread_role role);
+
+// name the calling thread and apply the policy of role to it
+// name - at most 15 characters
+// returns false when a configured policy could not be applied
+bool apply_thread_policy(thread_role role, const char* name);
+
+} // namespace tcam
+
+VISIBILITY_POP
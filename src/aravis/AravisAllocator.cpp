@@ -49,7 +49,8 @@ std::vector<std::shared_ptr<tcam::Memory>> tcam::aravis::AravisAllocator::alloca
 
      for (unsigned int i = 0; i < buffer_count; ++i)
      {
-        buffer.push_back(std::make_shared<tcam::Memory>(shared_from_this(), TCAM_MEMORY_TYPE_USERPTR, length));
+        buffer.push_back(std::make_shared<tcam::Memory>(
+            shared_from_this(), TCAM_MEMORY_TYPE_USERPTR, length + padding_));
      }
 
     return buffer;
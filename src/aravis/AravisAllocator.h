@@ -40,6 +40,15 @@ public:
 
     std::vector<std::shared_ptr<Memory>> allocate(
         size_t buffer_count, TCAM_MEMORY_TYPE, size_t, int fd = 0) final;
+
+    // bytes added to every buffer, e.g. room for chunk data behind the image
+    void set_padding(size_t padding) noexcept
+    {
+        padding_ = padding;
+    }
+
+private:
+    size_t padding_ = 0;
 };
 }
 
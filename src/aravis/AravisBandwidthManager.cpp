@@ -0,0 +1,347 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AravisBandwidthManager.h"
+
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cmath>
+#include <fstream>
+#include <ifaddrs.h>
+#include <netinet/in.h>
+
+using namespace tcam::aravis;
+
+namespace
+{
+
+// IPv4 (20), UDP (8) and GVSP (8) headers inside of GevSCPSPacketSize
+const uint64_t gvsp_header_size = 36;
+// ethernet header (14), FCS (4), preamble (8) and inter frame gap (12)
+const uint64_t ethernet_overhead = 38;
+// leader and trailer packet of every frame
+const uint64_t packets_per_frame_overhead = 2;
+
+// share of the link speed that is used when TCAM_GIGE_LINK_BUDGET=auto
+// leaves room for control traffic and packet resends
+const double auto_budget_ratio = 0.9;
+
+
+// name of the interface with the IPv4 address, empty when not found
+std::string interface_name(const std::string& address)
+{
+    ifaddrs* addrs = nullptr;
+    if (getifaddrs(&addrs) != 0)
+    {
+        return {};
+    }
+
+    std::string ret;
+    for (auto a = addrs; a != nullptr; a = a->ifa_next)
+    {
+        if (a->ifa_addr == nullptr || a->ifa_addr->sa_family != AF_INET)
+        {
+            continue;
+        }
+
+        char buf[INET_ADDRSTRLEN] = {};
+        auto in = reinterpret_cast<sockaddr_in*>(a->ifa_addr);
+        if (inet_ntop(AF_INET, &in->sin_addr, buf, sizeof(buf)) && address == buf)
+        {
+            ret = a->ifa_name;
+            break;
+        }
+    }
+
+    freeifaddrs(addrs);
+    return ret;
+}
+
+
+// bytes per second, 0 when the speed is unknown
+// virtual interfaces like lo do not report a speed
+uint64_t interface_speed(const std::string& name)
+{
+    if (name.empty())
+    {
+        return 0;
+    }
+
+    std::ifstream f("/sys/class/net/" + name + "/speed");
+    long mbit = 0;
+    if (!(f >> mbit) || mbit <= 0)
+    {
+        return 0;
+    }
+    return mbit * 1000 * 1000 / 8;
+}
+
+} // namespace
+
+
+uint64_t tcam::aravis::required_bandwidth(const bandwidth_request& request)
+{
+    if (request.packet_size <= gvsp_header_size || request.framerate <= 0.0)
+    {
+        return 0;
+    }
+
+    const uint64_t data_per_packet = request.packet_size - gvsp_header_size;
+    const uint64_t packets = (request.payload + data_per_packet - 1) / data_per_packet
+                             + packets_per_frame_overhead;
+
+    return std::ceil(packets * (request.packet_size + ethernet_overhead) * request.framerate);
+}
+
+
+std::vector<uint64_t> tcam::aravis::compute_packet_delays(
+    const link_budget& link,
+    const std::vector<bandwidth_request>& requests)
+{
+    std::vector<uint64_t> delays(requests.size(), 0);
+
+    double total = 0.0;
+    for (const auto& r : requests) { total += required_bandwidth(r); }
+
+    if (link.budget == 0 || total <= 0.0)
+    {
+        return delays;
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const double required = required_bandwidth(requests.at(i));
+        if (required <= 0.0)
+        {
+            continue;
+        }
+
+        // bytes per second this stream may send
+        const double share = link.budget * (required / total);
+        const double wire_size = requests.at(i).packet_size + ethernet_overhead;
+
+        // time between two packets minus the time a packet needs on the wire
+        double delay_ns = wire_size / share * 1e9;
+        if (link.link_speed > 0)
+        {
+            delay_ns -= wire_size / link.link_speed * 1e9;
+        }
+
+        delays.at(i) = delay_ns > 0.0 ? static_cast<uint64_t>(delay_ns) : 0;
+    }
+
+    return delays;
+}
+
+
+AravisBandwidthManager::AravisBandwidthManager()
+{
+    auto env = tcam::get_environment_variable("TCAM_GIGE_LINK_BUDGET", "");
+    if (env.empty())
+    {
+        return;
+    }
+
+    if (env == "auto")
+    {
+        is_active_ = true;
+        return;
+    }
+
+    auto mbit = tcam::get_environment_variable_int("TCAM_GIGE_LINK_BUDGET");
+    if (!mbit || *mbit <= 0)
+    {
+        libtcam::logger()->warn("Ignoring invalid TCAM_GIGE_LINK_BUDGET '{}'", env);
+        return;
+    }
+
+    configured_budget_ = static_cast<uint64_t>(*mbit) * 1000 * 1000 / 8;
+    is_active_ = true;
+}
+
+
+AravisBandwidthManager& AravisBandwidthManager::get()
+{
+    static AravisBandwidthManager manager;
+    return manager;
+}
+
+
+void AravisBandwidthManager::add_stream(const void* owner,
+                                        const std::string& interface_address,
+                                        const bandwidth_request& request,
+                                        apply_func apply)
+{
+    if (!is_active_)
+    {
+        return;
+    }
+
+    std::scoped_lock update_lck(update_mtx_);
+
+    std::vector<pending_delay> pending;
+    {
+        std::scoped_lock lck(mtx_);
+
+        auto iter = std::find_if(
+            streams_.begin(), streams_.end(), [owner](const auto& s) { return s.owner == owner; });
+        if (iter != streams_.end())
+        {
+            streams_.erase(iter);
+        }
+
+        streams_.push_back({ owner, interface_address, request, std::move(apply) });
+
+        pending = rebalance(interface_address);
+    }
+
+    for (auto& p : pending) { p.apply(p.packet_delay_ns); }
+}
+
+
+void AravisBandwidthManager::remove_stream(const void* owner)
+{
+    if (!is_active_)
+    {
+        return;
+    }
+
+    std::scoped_lock update_lck(update_mtx_);
+
+    std::vector<pending_delay> pending;
+    {
+        std::scoped_lock lck(mtx_);
+
+        auto iter = std::find_if(
+            streams_.begin(), streams_.end(), [owner](const auto& s) { return s.owner == owner; });
+        if (iter == streams_.end())
+        {
+            return;
+        }
+
+        auto interface_address = iter->interface_address;
+        streams_.erase(iter);
+
+        pending = rebalance(interface_address);
+    }
+
+    for (auto& p : pending) { p.apply(p.packet_delay_ns); }
+}
+
+
+link_budget AravisBandwidthManager::get_link_budget(const std::string& interface_address)
+{
+    auto iter = budgets_.find(interface_address);
+    if (iter != budgets_.end())
+    {
+        return iter->second;
+    }
+
+    auto name = interface_name(interface_address);
+
+    link_budget link = {};
+    link.link_speed = interface_speed(name);
+
+    if (configured_budget_ > 0)
+    {
+        link.budget = configured_budget_;
+        if (link.link_speed > 0 && link.budget > link.link_speed)
+        {
+            libtcam::logger()->warn(
+                "TCAM_GIGE_LINK_BUDGET exceeds the link speed of {}. Using {} Mbit/s.",
+                name,
+                link.link_speed * 8 / 1000 / 1000);
+            link.budget = link.link_speed;
+        }
+    }
+    else
+    {
+        link.budget = link.link_speed * auto_budget_ratio;
+    }
+
+    if (link.budget == 0)
+    {
+        libtcam::logger()->warn("Unable to determine the link speed of interface {} ({}). "
+                                "Packet delays will not be managed. "
+                                "Set TCAM_GIGE_LINK_BUDGET to a value in Mbit/s.",
+                                name,
+                                interface_address);
+    }
+    else
+    {
+        libtcam::logger()->info("Bandwidth budget of interface {} ({}) is {} Mbit/s",
+                                name,
+                                interface_address,
+                                link.budget * 8 / 1000 / 1000);
+    }
+
+    budgets_.emplace(interface_address, link);
+    return link;
+}
+
+
+std::vector<AravisBandwidthManager::pending_delay> AravisBandwidthManager::rebalance(
+    const std::string& interface_address)
+{
+    auto link = get_link_budget(interface_address);
+    if (link.budget == 0)
+    {
+        return {};
+    }
+
+    std::vector<stream_entry*> entries;
+    std::vector<bandwidth_request> requests;
+    uint64_t total = 0;
+
+    for (auto& s : streams_)
+    {
+        if (s.interface_address == interface_address)
+        {
+            entries.push_back(&s);
+            requests.push_back(s.request);
+            total += required_bandwidth(s.request);
+        }
+    }
+
+    if (total > link.budget)
+    {
+        libtcam::logger()->warn("GigE streams on {} require {} Mbit/s, budget is {} Mbit/s. "
+                                "Streams are throttled and may not reach their framerate.",
+                                interface_address,
+                                total * 8 / 1000 / 1000,
+                                link.budget * 8 / 1000 / 1000);
+    }
+
+    auto delays = compute_packet_delays(link, requests);
+
+    std::vector<pending_delay> pending;
+    pending.reserve(entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        libtcam::logger()->debug("Stream {} on {}: {} Mbit/s, packet delay {} ns",
+                                 entries.at(i)->owner,
+                                 interface_address,
+                                 required_bandwidth(requests.at(i)) * 8 / 1000 / 1000,
+                                 delays.at(i));
+        pending.push_back({ entries.at(i)->apply, delays.at(i) });
+    }
+
+    return pending;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../compiler_defines.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::aravis
+{
+
+struct bandwidth_request
+{
+    // image payload in bytes
+    uint64_t payload = 0;
+    double framerate = 0.0;
+    // GevSCPSPacketSize, includes the IP, UDP and GVSP headers
+    uint32_t packet_size = 0;
+};
+
+struct link_budget
+{
+    // bytes per second all streams of an interface may use together
+    uint64_t budget = 0;
+    // bytes per second the interface can transmit
+    uint64_t link_speed = 0;
+};
+
+// bytes per second a stream occupies on the wire,
+// including protocol headers and ethernet framing
+uint64_t required_bandwidth(const bandwidth_request& request);
+
+// inter-packet delays in ns, in the order of requests
+// the budget is shared in proportion to the required bandwidth and every
+// stream is paced to its share. While the budget suffices the share is larger
+// than the required bandwidth, only bursts are spread out. When it is exceeded
+// the streams are throttled below their framerate.
+std::vector<uint64_t> compute_packet_delays(const link_budget& link,
+                                            const std::vector<bandwidth_request>& requests);
+
+//
+// Shares the bandwidth of a network interface between all GigE streams
+// that are received through it
+//
+// The budget of an interface is read from TCAM_GIGE_LINK_BUDGET.
+// The manager is inactive when the variable is not set, packet delays
+// of the cameras are left untouched in that case.
+//
+// Streams register when they start and unregister when they stop.
+// Every change recalculates the packet delays of all streams of the
+// interface and hands them to the apply functions of the streams.
+//
+// The apply functions are called without the lock that protects the
+// stream list. They may lock their device, so add_stream and remove_stream
+// must not be called while holding the lock of any device.
+//
+class AravisBandwidthManager
+{
+public:
+    using apply_func = std::function<void(uint64_t packet_delay_ns)>;
+
+    static AravisBandwidthManager& get();
+
+    bool is_active() const noexcept
+    {
+        return is_active_;
+    }
+
+    // owner - identifies the stream for remove_stream
+    // interface_address - address of the local interface the stream is received on
+    // apply is called from the threads that add and remove streams of the interface
+    void add_stream(const void* owner,
+                    const std::string& interface_address,
+                    const bandwidth_request& request,
+                    apply_func apply);
+
+    // does nothing when owner has no registered stream
+    // apply of owner is not called anymore once this returns
+    void remove_stream(const void* owner);
+
+private:
+    AravisBandwidthManager();
+
+    struct stream_entry
+    {
+        const void* owner;
+        std::string interface_address;
+        bandwidth_request request;
+        apply_func apply;
+    };
+
+    struct pending_delay
+    {
+        apply_func apply;
+        uint64_t packet_delay_ns;
+    };
+
+    // caller has to hold mtx_
+    std::vector<pending_delay> rebalance(const std::string& interface_address);
+    link_budget get_link_budget(const std::string& interface_address);
+
+    bool is_active_ = false;
+    // TCAM_GIGE_LINK_BUDGET, 0 for auto
+    uint64_t configured_budget_ = 0;
+
+    // held while delays are applied, keeps concurrent updates in order
+    // and prevents calls into streams that were removed in the meantime
+    std::mutex update_mtx_;
+    // protects streams_ and budgets_, never held while applying
+    std::mutex mtx_;
+    std::vector<stream_entry> streams_;
+    std::map<std::string, link_budget> budgets_;
+};
+
+} // namespace tcam::aravis
+
+VISIBILITY_POP
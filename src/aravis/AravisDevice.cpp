@@ -16,11 +16,15 @@
 
 #include "AravisDevice.h"
 
+#include "../ThreadPolicy.h"
 #include "../logging.h"
 #include "../utils.h"
 #include "AravisPropertyBackend.h"
 #include "AravisAllocator.h"
+#include "AravisBandwidthManager.h"
 #include "aravis_utils.h"
+#include "../tcam-network/ActionCommand.h"
+#include "../tcam-network/utils.h"
 
 #include <algorithm>
 #include <cmath>
@@ -68,11 +72,22 @@ AravisDevice::AravisDevice(const DeviceInfo& device_desc)
         arv_camera_get_device(arv_camera_), "control-lost", G_CALLBACK(device_lost), this);
 
     allocator_ = std::make_shared<tcam::aravis::AravisAllocator>();
+
+    use_pop_thread_ = tcam::get_environment_variable_int("TCAM_ARV_POP_THREAD").value_or(0) > 0;
+
+    init_clock_sync();
 }
 
 
 AravisDevice::~AravisDevice()
 {
+    stop_pop_thread();
+    stop_clock_sync();
+
+    tcam::aravis::AravisBandwidthManager::get().remove_stream(this);
+
+    g_clear_object(&chunk_parser_);
+
     if (arv_camera_ != NULL)
     {
         g_object_unref(arv_camera_);
@@ -407,6 +422,7 @@ static void restore_data_reapply(ArvCamera* camera, data_to_restore_active_forma
 outcome::result<tcam::framerate_info> tcam::AravisDevice::get_framerate_info(const VideoFormat& fmt)
 {
     std::scoped_lock lck0 { arv_camera_access_mutex_ };
+    std::scoped_lock genicam_lck { genicam_mutex_ };
 
     if (has_test_format_interface_)
     {
@@ -497,6 +513,8 @@ outcome::result<tcam::framerate_info> tcam::AravisDevice::get_framerate_info(con
 
 void AravisDevice::disable_chunk_mode()
 {
+    std::scoped_lock genicam_lck { genicam_mutex_ };
+
     GError* err = nullptr;
     arv_camera_set_chunk_mode(arv_camera_, false, &err);
     if (err)
@@ -519,9 +537,182 @@ void AravisDevice::disable_chunk_mode()
     }
 }
 
+
+namespace
+{
+
+struct chunk_description
+{
+    // ChunkSelector entry
+    const char* name;
+    // feature containing the value
+    const char* feature;
+    TCAM_CHUNK_FIELD field;
+};
+
+static const chunk_description supported_chunks[] = {
+    { "ExposureTime", "ChunkExposureTime", TCAM_CHUNK_EXPOSURE_TIME },
+    { "Gain", "ChunkGain", TCAM_CHUNK_GAIN },
+    { "FrameID", "ChunkFrameID", TCAM_CHUNK_FRAME_ID },
+    { "LineStatusAll", "ChunkLineStatusAll", TCAM_CHUNK_LINE_STATUS_ALL },
+    { "Timestamp", "ChunkTimestamp", TCAM_CHUNK_TIMESTAMP },
+};
+
+// chunk data follows the image inside the payload
+// each chunk only carries a few bytes and a small trailer
+static const size_t chunk_buffer_padding = 4096;
+
+} // namespace
+
+
+bool AravisDevice::set_chunk_selection(const std::vector<std::string>& chunks)
+{
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+
+    if (!chunks.empty() && !has_genicam_property("ChunkModeActive"))
+    {
+        libtcam::logger()->error("Device does not support chunk data.");
+        return false;
+    }
+
+    uint32_t fields = 0;
+    for (const auto& c : chunks)
+    {
+        auto desc = std::find_if(std::begin(supported_chunks),
+                                 std::end(supported_chunks),
+                                 [&c](const chunk_description& d) { return c == d.name; });
+        if (desc == std::end(supported_chunks))
+        {
+            libtcam::logger()->error("Chunk '{}' is not supported.", c);
+            return false;
+        }
+        fields |= desc->field;
+    }
+
+    chunk_selection_ = chunks;
+    chunk_fields_ = fields;
+
+    // only buffers allocated afterwards are affected
+    allocator_->set_padding(chunks.empty() ? 0 : chunk_buffer_padding);
+
+    return true;
+}
+
+
+void AravisDevice::configure_chunk_mode(size_t buffer_size)
+{
+    std::scoped_lock genicam_lck { genicam_mutex_ };
+
+    g_clear_object(&chunk_parser_);
+
+    if (chunk_selection_.empty())
+    {
+        disable_chunk_mode();
+        return;
+    }
+
+    std::string chunk_list;
+    for (const auto& c : chunk_selection_)
+    {
+        if (!chunk_list.empty())
+        {
+            chunk_list += ",";
+        }
+        chunk_list += c;
+    }
+
+    // enables ChunkModeActive and only the listed chunks
+    GError* err = nullptr;
+    arv_camera_set_chunks(arv_camera_, chunk_list.c_str(), &err);
+    if (err)
+    {
+        libtcam::logger()->warn("Unable to enable chunks '{}': {}", chunk_list, err->message);
+        g_clear_error(&err);
+        disable_chunk_mode();
+        return;
+    }
+
+    size_t payload = arv_camera_get_payload(arv_camera_, &err);
+    if (err)
+    {
+        libtcam::logger()->warn("Unable to retrieve payload with chunk data: {}", err->message);
+        g_clear_error(&err);
+        disable_chunk_mode();
+        return;
+    }
+
+    if (payload > buffer_size)
+    {
+        // e.g. buffers of an external allocator
+        libtcam::logger()->warn(
+            "Buffers ({} bytes) are too small for images with chunk data ({} bytes). Disabling chunk data.",
+            buffer_size,
+            payload);
+        disable_chunk_mode();
+        return;
+    }
+
+    chunk_parser_ = arv_camera_create_chunk_parser(arv_camera_);
+}
+
+
+tcam_chunk_data AravisDevice::read_chunk_data(ArvBuffer* buffer)
+{
+    tcam_chunk_data ret = {};
+
+    if (!chunk_parser_ || !arv_buffer_has_chunks(buffer))
+    {
+        return ret;
+    }
+
+    for (const auto& c : supported_chunks)
+    {
+        if (!(chunk_fields_ & c.field))
+        {
+            continue;
+        }
+
+        GError* err = nullptr;
+        switch (c.field)
+        {
+            case TCAM_CHUNK_EXPOSURE_TIME:
+                ret.exposure_time_us =
+                    arv_chunk_parser_get_float_value(chunk_parser_, buffer, c.feature, &err);
+                break;
+            case TCAM_CHUNK_GAIN:
+                ret.gain = arv_chunk_parser_get_float_value(chunk_parser_, buffer, c.feature, &err);
+                break;
+            case TCAM_CHUNK_FRAME_ID:
+                ret.frame_id =
+                    arv_chunk_parser_get_integer_value(chunk_parser_, buffer, c.feature, &err);
+                break;
+            case TCAM_CHUNK_LINE_STATUS_ALL:
+                ret.line_status_all =
+                    arv_chunk_parser_get_integer_value(chunk_parser_, buffer, c.feature, &err);
+                break;
+            case TCAM_CHUNK_TIMESTAMP:
+                ret.timestamp =
+                    arv_chunk_parser_get_integer_value(chunk_parser_, buffer, c.feature, &err);
+                break;
+        }
+
+        if (err)
+        {
+            // the value stays marked as invalid
+            g_clear_error(&err);
+            continue;
+        }
+        ret.valid_fields |= c.field;
+    }
+
+    return ret;
+}
+
 bool AravisDevice::set_video_format(const VideoFormat& new_format)
 {
     std::scoped_lock lck { arv_camera_access_mutex_ };
+    // properties wait while the format is changed, e.g. TriggerMode is reset in between
+    std::scoped_lock genicam_lck { genicam_mutex_ };
 
     if (is_lost_)
     {
@@ -641,6 +832,8 @@ set_video_format_finish:
 
 tcam::VideoFormat AravisDevice::read_camera_current_video_format()
 {
+    std::scoped_lock genicam_lck { genicam_mutex_ };
+
     VideoFormat format;
 
     format.set_framerate(get_framerate(this->arv_camera_));
@@ -736,6 +929,215 @@ void AravisDevice::auto_set_packet_size()
     }
 }
 
+std::string AravisDevice::get_interface_address() const
+{
+    auto device = arv_camera_get_device(arv_camera_);
+    if (!ARV_IS_GV_DEVICE(device))
+    {
+        return {};
+    }
+
+    auto address = arv_gv_device_get_interface_address(ARV_GV_DEVICE(device));
+    if (!G_IS_INET_SOCKET_ADDRESS(address))
+    {
+        return {};
+    }
+
+    gchar* str =
+        g_inet_address_to_string(g_inet_socket_address_get_address(G_INET_SOCKET_ADDRESS(address)));
+    std::string ret = str;
+    g_free(str);
+
+    return ret;
+}
+
+
+outcome::result<void> AravisDevice::send_action_command(uint32_t device_key,
+                                                        uint32_t group_key,
+                                                        uint32_t group_mask)
+{
+    auto interface_address = get_interface_address();
+    if (interface_address.empty())
+    {
+        return tcam::status::NotImplemented;
+    }
+
+    // loopback has no broadcast, e.g. when testing with arv-fake-gv-camera
+    std::string destination = "255.255.255.255";
+    if (tis::startsWith(interface_address, "127."))
+    {
+        destination = "127.0.0.1";
+    }
+
+    tis::ActionCommand cmd;
+    cmd.device_key = device_key;
+    cmd.group_key = group_key;
+    cmd.group_mask = group_mask;
+
+    try
+    {
+        tis::Socket socket(tis::fillAddr(interface_address, 0));
+        if (tis::sendActionCommand(socket, destination, cmd) < 0)
+        {
+            libtcam::logger()->error("Unable to send action command on {}: {}",
+                                     interface_address,
+                                     strerror(errno));
+            return tcam::status::UndefinedError;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        libtcam::logger()->error("Unable to send action command on {}: {}", interface_address, e.what());
+        return tcam::status::UndefinedError;
+    }
+
+    libtcam::logger()->debug("Sent action command device key {:#x} group key {:#x} mask {:#x} on {}",
+                             device_key,
+                             group_key,
+                             group_mask,
+                             interface_address);
+
+    return outcome::success();
+}
+
+
+void AravisDevice::init_clock_sync()
+{
+    auto is_available = [this](const char* name)
+    {
+        return arv_camera_is_feature_available(arv_camera_, name, nullptr);
+    };
+
+    // SFNC names first, GigE Vision 1.x cameras only offer the Gev* features
+    if (is_available("TimestampLatch") && is_available("TimestampLatchValue"))
+    {
+        latch_command_ = "TimestampLatch";
+        latch_value_ = "TimestampLatchValue";
+    }
+    else if (is_available("GevTimestampControlLatch") && is_available("GevTimestampValue"))
+    {
+        latch_command_ = "GevTimestampControlLatch";
+        latch_value_ = "GevTimestampValue";
+    }
+    else
+    {
+        libtcam::logger()->debug("Camera can not latch its time. Corrected timestamps are not available.");
+        return;
+    }
+
+    if (is_available("GevTimestampTickFrequency"))
+    {
+        gint64 freq = arv_camera_get_integer(arv_camera_, "GevTimestampTickFrequency", nullptr);
+        if (freq > 0)
+        {
+            timestamp_tick_frequency_ = freq;
+        }
+    }
+
+    clock_sync_interval_ = std::chrono::milliseconds(
+        tcam::get_environment_variable_int("TCAM_CAMERA_CLOCK_SYNC_MS").value_or(1000));
+
+    auto clock = tcam::get_environment_variable("TCAM_CAMERA_CLOCK", "realtime");
+    if (auto clock_id = tcam::CameraClockEstimator::clock_from_name(clock))
+    {
+        clock_base_ = *clock_id;
+    }
+    else
+    {
+        libtcam::logger()->warn("Ignoring invalid TCAM_CAMERA_CLOCK '{}'. Using realtime.", clock);
+    }
+}
+
+
+void AravisDevice::start_clock_sync()
+{
+    if (latch_command_.empty() || clock_sync_interval_.count() <= 0)
+    {
+        return;
+    }
+
+    // the camera time base may have been reset since the last stream
+    clock_estimator_.reset();
+
+    stop_clock_sync_ = false;
+    clock_sync_thread_ = std::thread(&AravisDevice::clock_sync_func, this);
+}
+
+
+void AravisDevice::stop_clock_sync()
+{
+    {
+        std::scoped_lock lck(clock_sync_mtx_);
+        stop_clock_sync_ = true;
+    }
+    clock_sync_cv_.notify_all();
+
+    if (clock_sync_thread_.joinable())
+    {
+        clock_sync_thread_.join();
+    }
+}
+
+
+void AravisDevice::clock_sync_func()
+{
+    tcam::apply_thread_policy(tcam::thread_role::housekeeping, "tcam_arv_clock");
+
+    std::unique_lock lck(clock_sync_mtx_);
+    while (!stop_clock_sync_)
+    {
+        lck.unlock();
+        latch_camera_time();
+        lck.lock();
+
+        clock_sync_cv_.wait_for(lck, clock_sync_interval_, [this] { return stop_clock_sync_; });
+    }
+}
+
+
+bool AravisDevice::latch_camera_time()
+{
+    std::scoped_lock lck { arv_camera_access_mutex_ };
+    // latch command and value must not be interleaved with other features
+    // property access waits for both round trips
+    std::scoped_lock genicam_lck { genicam_mutex_ };
+
+    GError* err = nullptr;
+
+    // the camera latches when it receives the command
+    // the middle of the round trip is the best guess for that
+    auto before = tcam::CameraClockEstimator::now(clock_base_);
+    arv_camera_execute_command(arv_camera_, latch_command_.c_str(), &err);
+    auto after = tcam::CameraClockEstimator::now(clock_base_);
+
+    if (err)
+    {
+        libtcam::logger()->debug("Unable to latch camera time: {}", err->message);
+        g_clear_error(&err);
+        return false;
+    }
+
+    gint64 ticks = arv_camera_get_integer(arv_camera_, latch_value_.c_str(), &err);
+    if (err)
+    {
+        libtcam::logger()->debug("Unable to read latched camera time: {}", err->message);
+        g_clear_error(&err);
+        return false;
+    }
+
+    // same conversion aravis uses for the buffer timestamps
+    uint64_t camera_ns = ticks;
+    if (timestamp_tick_frequency_ != 1'000'000'000)
+    {
+        camera_ns = (uint64_t)((double)ticks * 1e9 / timestamp_tick_frequency_);
+    }
+
+    clock_estimator_.add_sample(camera_ns, before, after);
+
+    return true;
+}
+
+
 void AravisDevice::device_lost(ArvGvDevice* device __attribute__((unused)), void* user_data)
 {
     AravisDevice* self = (AravisDevice*)user_data;
@@ -1081,10 +1483,12 @@ tcam_image_size AravisDevice::get_sensor_size() const
 
 bool AravisDevice::has_genicam_property(const char* name) const
 {
+    std::scoped_lock genicam_lck { genicam_mutex_ };
     return arv_gc_get_node(genicam_, name) != nullptr;
 }
 
 ArvGcNode* AravisDevice::get_genicam_property_node(const char* name) const
 {
+    std::scoped_lock genicam_lck { genicam_mutex_ };
     return arv_gc_get_node(genicam_, name);
 }
@@ -17,14 +17,18 @@
 #ifndef TCAM_ARAVISDEVICE_H
 #define TCAM_ARAVISDEVICE_H
 
+#include "../CameraClockEstimator.h"
 #include "../DeviceInterface.h"
 #include "AravisAllocator.h"
 #include "../FormatHandlerInterface.h"
 
 #include <arv.h>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <optional>
+#include <thread>
 
 VISIBILITY_INTERNAL
 
@@ -87,6 +91,8 @@ public:
 
     outcome::result<tcam::framerate_info> get_framerate_info(const VideoFormat& fmt) final;
 
+    bool set_chunk_selection(const std::vector<std::string>& chunks) final;
+
 private:
     tcam::VideoFormat read_camera_current_video_format();
 
@@ -100,10 +106,32 @@ private:
 
     static void aravis_new_buffer_callback(ArvStream* stream, void* user_data);
 
+    // evaluates a buffer popped from stream_
+    void handle_arv_buffer(ArvBuffer* buffer);
+
+    // TCAM_ARV_POP_THREAD
+    // images are popped by pop_thread_ instead of the "new-buffer" signal
+    // the aravis receive thread then only has to receive packets
+    bool use_pop_thread_ = false;
+    std::thread pop_thread_;
+    std::atomic<bool> stop_pop_thread_ = false;
+
+    void pop_thread_func();
+    // must not be called while holding arv_camera_access_mutex_
+    // when images can be delivered
+    void stop_pop_thread();
+
     static void device_lost(ArvGvDevice* device, void* user_data);
 
     std::recursive_mutex arv_camera_access_mutex_;
 
+    // guards every evaluation of genicam_, via arv_gc_* or arv_camera_*
+    // the nodes share caches and selectors, aravis does not lock them,
+    // so all features of the device are accessed one after another
+    // it is held for the register transfers of an access, e.g. GVCP round trips
+    // taken after arv_camera_access_mutex_
+    mutable std::recursive_mutex genicam_mutex_;
+
     ArvCamera* arv_camera_ = nullptr;
     ArvStream* stream_ = nullptr;
     ArvGc* genicam_ = nullptr;
@@ -134,12 +162,83 @@ private:
     };
 
     static void clear_buffer_info_arb_buffer(buffer_info& info);
+    static void arv_buffer_destroy_notify(void* buffer_info_ptr);
 
+    // capacity is reserved for BufferPool::get_max_count
+    // elements must never move, their address is the ArvBuffer user data
     std::vector<buffer_info> buffer_list_;
     std::mutex buffer_list_mtx_;
 
+    std::shared_ptr<BufferPool> pool_;
+    // the pool requested that the next requeued buffer is released
+    bool shrink_pending_ = false;
+
+    // add a buffer to the running stream
+    void grow_buffer_pool();
+
     long frames_delivered_ = 0;
     long frames_dropped_ = 0;
+    // arv_stream_get_statistics n_underruns already reported to metrics_
+    guint64 reported_underruns_ = 0;
+    // buffers aravis returned with ARV_BUFFER_STATUS_MISSING_PACKETS
+    // excluded from frames_lost, they are delivered or dropped as incomplete
+    guint64 incomplete_frames_ = 0;
+    // buffers aravis returned with any other failure status, e.g. timeout
+    // excluded from frames_lost, they are counted as dropped
+    guint64 failed_frames_ = 0;
+
+    // packet statistics of the running GigE stream
+    // only touched by the thread that receives the images
+    tcam_gige_statistics gige_stats_ = {};
+
+    // sample the aravis packet counters, called once per received ArvBuffer
+    void update_gige_statistics();
+
+    // maps camera_time_ns to the host clock
+    // the camera time is latched every clock_sync_interval_ by clock_sync_thread_
+    tcam::CameraClockEstimator clock_estimator_;
+    // TCAM_CAMERA_CLOCK, CLOCK_REALTIME or CLOCK_TAI
+    clockid_t clock_base_ = CLOCK_REALTIME;
+    // TCAM_CAMERA_CLOCK_SYNC_MS, 0 disables the synchronization
+    std::chrono::milliseconds clock_sync_interval_ { 1000 };
+    // TimestampLatch/TimestampLatchValue or their GigE Vision 1.x counterparts
+    // empty when the camera can not latch its time
+    std::string latch_command_;
+    std::string latch_value_;
+    // GevTimestampTickFrequency, the unit of latch_value_
+    uint64_t timestamp_tick_frequency_ = 1'000'000'000;
+
+    std::thread clock_sync_thread_;
+    std::mutex clock_sync_mtx_;
+    std::condition_variable clock_sync_cv_;
+    bool stop_clock_sync_ = false;
+
+    void init_clock_sync();
+    void start_clock_sync();
+    // must not be called while holding arv_camera_access_mutex_
+    void stop_clock_sync();
+    void clock_sync_func();
+    // adds a sample to clock_estimator_
+    bool latch_camera_time();
+
+    // GevSCPD, set by AravisBandwidthManager from other threads
+    // written with arv_camera_access_mutex_ held, read by the receiving thread
+    std::atomic<uint64_t> packet_delay_ns_ = 0;
+
+    // address of the local interface the GigE device is reached on
+    // empty for other devices
+    std::string get_interface_address() const;
+
+    // broadcast an immediate action command on the interface of the device
+    outcome::result<void> send_action_command(uint32_t device_key,
+                                              uint32_t group_key,
+                                              uint32_t group_mask);
+
+    // share the interface bandwidth with the other GigE streams
+    // requires TCAM_GIGE_LINK_BUDGET
+    // lck holds arv_camera_access_mutex_, it is released while the
+    // packet delays of all streams on the interface are updated
+    void register_stream_bandwidth(std::unique_lock<std::recursive_mutex>& lck);
     std::atomic<bool> is_lost_ = false;
 
     struct device_scaling
@@ -197,6 +296,18 @@ private:
 
     void disable_chunk_mode();
 
+    // chunks requested with set_chunk_selection, e.g. "ExposureTime"
+    std::vector<std::string> chunk_selection_;
+    // TCAM_CHUNK_FIELD bits of chunk_selection_
+    uint32_t chunk_fields_ = 0;
+    // only set while the chunks of chunk_selection_ are enabled for the stream
+    ArvChunkParser* chunk_parser_ = nullptr;
+
+    // enables the chunks of chunk_selection_ or disables chunk mode
+    // chunks stay disabled when the payload does not fit into buffer_size
+    void configure_chunk_mode(size_t buffer_size);
+    tcam_chunk_data read_chunk_data(ArvBuffer* buffer);
+
 }; /* class GigeCapture */
 
 } /* namespace tcam */
@@ -17,8 +17,10 @@
 #include "../../libs/gst-helper/include/tcamprop1.0_base/tcamprop_property_info_list.h"
 #include "../error.h"
 #include "../logging.h"
+#include "../utils.h"
 #include "AravisDevice.h"
 #include "AravisPropertyBackend.h"
+#include "aravis_genicam_cache.h"
 #include "aravis_property_impl.h"
 #include "aravis_utils.h"
 
@@ -136,6 +138,11 @@ static const aravis_property_name_map aravis_property_name_mapping_list[] =
     { "OffsetAuto", "OffsetAutoCenter", map_type::pub },
     { "IRCutFilterEnableElement", "IRCutFilterEnable", map_type::pub },
     { "ExposureAutoHighlighReduction", "ExposureAutoHighlightReduction", map_type::pub }, // This should already be there??
+    // PTP control, GigE Vision 1.x cameras use the Gev* names
+    { "GevIEEE1588", "PtpEnable", map_type::pub },
+    { "GevIEEE1588Status", "PtpStatus", map_type::pub },
+    { "GevTimestampControlLatch", "TimestampLatch", map_type::pub },
+    { "GevTimestampValue", "TimestampLatchValue", map_type::pub },
 
     // These controls get overridden by hand build implementations to either fix type issues or to flatten properties
     { "BalanceRatioSelector", map_type::priv },
@@ -282,6 +289,27 @@ void create_ordered_property_list(std::vector<node_cat_entry>& out_lst,
     out_lst.push_back(node_cat_entry { category, name, feature_node });
 }
 
+
+// resolve the cached names in document
+// returns false when the cache does not fit the document
+bool create_property_list_from_cache(std::vector<node_cat_entry>& out_lst,
+                                     ArvGc* document,
+                                     const std::vector<tcam::aravis::genicam_node_entry>& cache)
+{
+    out_lst.reserve(cache.size());
+    for (const auto& e : cache)
+    {
+        ArvGcNode* node = arv_gc_get_node(document, e.name.c_str());
+        if (!ARV_IS_GC_FEATURE_NODE(node))
+        {
+            out_lst.clear();
+            return false;
+        }
+        out_lst.push_back(node_cat_entry { e.category, e.name, ARV_GC_FEATURE_NODE(node) });
+    }
+    return true;
+}
+
 } // namespace
 
 bool tcam::aravis::is_private_setting(std::string_view name)
@@ -293,7 +321,31 @@ bool tcam::aravis::is_private_setting(std::string_view name)
 void tcam::AravisDevice::create_property_list_from_genicam_categories()
 {
     std::vector<node_cat_entry> lst;
-    create_ordered_property_list(lst, genicam_, nullptr, "Root");
+
+    std::string cache_key;
+    if (!tcam::is_environment_variable_set("TCAM_DISABLE_GENICAM_CACHE"))
+    {
+        cache_key = tcam::aravis::genicam_cache_key(arv_camera_);
+    }
+
+    std::vector<tcam::aravis::genicam_node_entry> cache;
+    if (!cache_key.empty() && tcam::aravis::load_genicam_cache(cache_key, cache)
+        && create_property_list_from_cache(lst, genicam_, cache))
+    {
+        libtcam::logger()->debug("Using cached GenICam features.");
+    }
+    else
+    {
+        create_ordered_property_list(lst, genicam_, nullptr, "Root");
+
+        if (!cache_key.empty())
+        {
+            cache.clear();
+            cache.reserve(lst.size());
+            for (const auto& e : lst) { cache.push_back({ e.category, e.name }); }
+            tcam::aravis::store_genicam_cache(cache_key, cache);
+        }
+    }
 
     auto find_node = [&](std::string_view name) -> bool
     {
@@ -438,6 +490,39 @@ void tcam::AravisDevice::generate_properties_from_genicam()
         }
     }
 
+    auto action_device_key = find_cam_property<tcam::property::IPropertyInteger>("ActionDeviceKey");
+    auto action_group_key = find_cam_property<tcam::property::IPropertyInteger>("ActionGroupKey");
+    auto action_group_mask = find_cam_property<tcam::property::IPropertyInteger>("ActionGroupMask");
+    if (action_device_key && action_group_key && action_group_mask
+        && arv_camera_is_gv_device(arv_camera_))
+    {
+        // the key can only be read back through the override
+        auto key = std::make_shared<tcam::aravis::action_device_key_override>(action_device_key);
+        for (auto* lst : { &properties_, &internal_properties_ })
+        {
+            std::replace(lst->begin(),
+                         lst->end(),
+                         std::shared_ptr<tcam::property::IPropertyBase>(action_device_key),
+                         std::shared_ptr<tcam::property::IPropertyBase>(key));
+        }
+
+        auto send = [this, backend = std::weak_ptr(backend_)](
+                        uint32_t device_key, uint32_t group_key, uint32_t group_mask)
+            -> outcome::result<void>
+        {
+            auto lck = tcam::aravis::aravis_backend_guard::acquire(backend);
+            if (!lck)
+            {
+                return tcam::status::ResourceNotLockable;
+            }
+            return send_action_command(device_key, group_key, group_mask);
+        };
+        add_property_after(properties_,
+                           "ActionGroupMask",
+                           std::make_shared<tcam::aravis::action_command_impl>(
+                               key, action_group_key, action_group_mask, send));
+    }
+
     auto focus_auto = find_cam_property<tcam::property::IPropertyCommand>("FocusAuto");
     if (focus_auto)
     {
@@ -15,10 +15,13 @@
  */
 
 #include "../ImageBuffer.h"
+#include "../ThreadPolicy.h"
 #include "../logging.h"
 #include "../utils.h"
+#include "AravisBandwidthManager.h"
 #include "AravisDevice.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -31,6 +34,12 @@ void tcam::AravisDevice::clear_buffer_info_arb_buffer(buffer_info& info)
     info.arv_buffer = nullptr;
 }
 
+void tcam::AravisDevice::arv_buffer_destroy_notify(void* buffer_info_ptr)
+{
+    auto& info = *static_cast<buffer_info*>(buffer_info_ptr);
+    clear_buffer_info_arb_buffer(info);
+}
+
 bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
 {
     auto new_list = pool->get_buffer();
@@ -39,10 +48,22 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
 
     GError* err = nullptr;
 
+    pool_ = pool;
+    shrink_pending_ = false;
+
     this->buffer_list_.clear();
-    this->buffer_list_.reserve(new_list.size());
+    this->buffer_list_.reserve(std::max(new_list.size(), pool->get_max_count()));
+
+    size_t buffer_size = new_list.front().lock()->get_image_buffer_size();
+
+    // chunk data changes the payload
+    configure_chunk_mode(buffer_size);
 
-    size_t payload = arv_camera_get_payload(this->arv_camera_, &err);
+    size_t payload = 0;
+    {
+        std::scoped_lock genicam_lck { genicam_mutex_ };
+        payload = arv_camera_get_payload(this->arv_camera_, &err);
+    }
     if (err)
     {
         libtcam::logger()->error("Unable to retrieve payload: {}", err->message);
@@ -50,12 +71,6 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
         return false;
     }
 
-    auto buffer_destroy_notfiy = [](void* buffer_info_ptr) {
-        auto& info = *static_cast<buffer_info*>(buffer_info_ptr);
-        clear_buffer_info_arb_buffer(info);
-    };
-
-    size_t buffer_size = new_list.front().lock()->get_image_buffer_size();
     if( buffer_size < payload)
     {
         libtcam::logger()->warn("Aravis payload-size ({}) > image_buffer_size ({})", payload, buffer_size);
@@ -67,7 +82,7 @@ bool AravisDevice::initialize_buffers(std::shared_ptr<BufferPool> pool)
     for (auto& info : buffer_list_)
     {
         info.arv_buffer = arv_buffer_new_full(
-            buffer_size, info.buffer->get_image_buffer_ptr(), &info, buffer_destroy_notfiy);
+            buffer_size, info.buffer->get_image_buffer_ptr(), &info, arv_buffer_destroy_notify);
     }
     return true;
 }
@@ -97,24 +112,89 @@ void AravisDevice::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
     std::scoped_lock lck0 { arv_camera_access_mutex_ };
 
-    std::scoped_lock lck { buffer_list_mtx_ };
-    for (auto& b : buffer_list_)
+    ArvBuffer* released_buffer = nullptr;
     {
-        if (b.buffer == buffer && b.arv_buffer != nullptr)
+        std::scoped_lock lck { buffer_list_mtx_ };
+
+        // buffer_list_ is built from BufferPool::get_buffer
+        // and thus indexed by the pool index
+        const int index = buffer->get_pool_index();
+        if (index >= 0 && (size_t)index < buffer_list_.size())
         {
+            auto& b = buffer_list_[index];
+            if (b.buffer == buffer && b.arv_buffer != nullptr)
+            {
+                if (shrink_pending_ && pool_ && pool_->shrink(buffer))
+                {
+                    shrink_pending_ = false;
+                    released_buffer = b.arv_buffer;
+                }
+                else
+                {
 #if !defined NDEBUG
-            b.is_queued = true;
+                    b.is_queued = true;
 #endif
-            arv_stream_push_buffer(this->stream_, b.arv_buffer);
-            return;
+                    arv_stream_push_buffer(this->stream_, b.arv_buffer);
+                    return;
+                }
+            }
         }
     }
 
+    if (released_buffer)
+    {
+        // destroy notify resets buffer_info::arv_buffer and takes buffer_list_mtx_
+        g_object_unref(released_buffer);
+        libtcam::logger()->debug("Released idle buffer. ptr={}", static_cast<void*>(buffer.get()));
+        return;
+    }
+
     // we can just drop it here
     libtcam::logger()->debug("Buffer not requeued. Already flushed from buffer_list. ptr={}.",
                  static_cast<void*>(buffer.get()));
 }
 
+void AravisDevice::grow_buffer_pool()
+{
+    auto res = pool_->grow();
+    if (!res)
+    {
+        return;
+    }
+
+    auto buffer = res.value();
+    const size_t index = buffer->get_pool_index();
+
+    std::scoped_lock lck { buffer_list_mtx_ };
+
+    if (index == buffer_list_.size())
+    {
+        if (buffer_list_.size() == buffer_list_.capacity())
+        {
+            // a reallocation would invalidate the ArvBuffer user data
+            libtcam::logger()->error("No space left for additional buffers.");
+            (void)pool_->shrink(buffer);
+            return;
+        }
+        buffer_list_.push_back(buffer_info { this, buffer });
+    }
+    else if (index > buffer_list_.size() || buffer_list_.at(index).buffer != buffer)
+    {
+        libtcam::logger()->error("Buffer pool and stream are out of sync.");
+        return;
+    }
+
+    auto& info = buffer_list_.at(index);
+    info.arv_buffer = arv_buffer_new_full(buffer->get_image_buffer_size(),
+                                          buffer->get_image_buffer_ptr(),
+                                          &info,
+                                          arv_buffer_destroy_notify);
+    arv_stream_push_buffer(stream_, info.arv_buffer);
+
+    libtcam::logger()->debug("Buffer pool grew to {} buffers.", pool_->get_active_count());
+}
+
+
 static bool set_stream_options(ArvStream* stream)
 {
 
@@ -280,7 +360,7 @@ static bool set_stream_options(ArvStream* stream)
 
 bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
 {
-    std::scoped_lock lck0 { arv_camera_access_mutex_ };
+    std::unique_lock lck0 { arv_camera_access_mutex_ };
 
     if (arv_camera_ == nullptr)
     {
@@ -307,7 +387,12 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
     {
         if (type == ARV_STREAM_CALLBACK_TYPE_INIT)
         {
-            if (!arv_make_thread_realtime(10))
+            // an explicitly configured policy replaces the default below
+            if (tcam::get_thread_policy(tcam::thread_role::capture))
+            {
+                tcam::apply_thread_policy(tcam::thread_role::capture, "tcam_arv_strm");
+            }
+            else if (!arv_make_thread_realtime(10))
             {
                 if (!arv_make_thread_high_priority(-10))
                 {
@@ -325,11 +410,15 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
         }
     };
 
-    disable_chunk_mode();
+    // chunk mode was configured by initialize_buffers
 
     GError* err = nullptr;
 
-    this->stream_ = arv_camera_create_stream(this->arv_camera_, stream_cb, NULL, &err);
+    {
+        // GigE Vision devices negotiate the packet size here
+        std::scoped_lock genicam_lck { genicam_mutex_ };
+        this->stream_ = arv_camera_create_stream(this->arv_camera_, stream_cb, NULL, &err);
+    }
 
     if (err)
     {
@@ -344,16 +433,53 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
         return false;
     }
 
+    gige_stats_ = {};
+
     if (ARV_IS_GV_STREAM(this->stream_))
     {
         set_stream_options(this->stream_);
+
+        std::unique_lock genicam_lck { genicam_mutex_ };
+
+        // packet size negotiation happens when the stream is created
+        gige_stats_.packet_size = arv_camera_gv_get_packet_size(arv_camera_, &err);
+        if (err)
+        {
+            libtcam::logger()->debug("Unable to read packet size: {}", err->message);
+            g_clear_error(&err);
+        }
+        gint64 delay = arv_camera_gv_get_packet_delay(arv_camera_, &err);
+        if (err)
+        {
+            libtcam::logger()->debug("Unable to read packet delay: {}", err->message);
+            g_clear_error(&err);
+        }
+
+        genicam_lck.unlock();
+        gige_stats_.packet_delay_ns = delay > 0 ? delay : 0;
+        packet_delay_ns_ = gige_stats_.packet_delay_ns;
+
+        libtcam::logger()->info("GigE stream uses packet size {} and packet delay {} ns",
+                                gige_stats_.packet_size,
+                                gige_stats_.packet_delay_ns);
+
+        if (metrics_)
+        {
+            metrics_->set_packet_config(gige_stats_.packet_size, gige_stats_.packet_delay_ns);
+        }
     }
 
     for (auto& buf : buffer_list_) { arv_stream_push_buffer(this->stream_, buf.arv_buffer); }
 
-    arv_stream_set_emit_signals(this->stream_, TRUE);
+    if (!use_pop_thread_)
+    {
+        arv_stream_set_emit_signals(this->stream_, TRUE);
+    }
 
-    arv_camera_set_acquisition_mode(this->arv_camera_, ARV_ACQUISITION_MODE_CONTINUOUS, &err);
+    {
+        std::scoped_lock genicam_lck { genicam_mutex_ };
+        arv_camera_set_acquisition_mode(this->arv_camera_, ARV_ACQUISITION_MODE_CONTINUOUS, &err);
+    }
 
     if (err)
     {
@@ -362,35 +488,66 @@ bool AravisDevice::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
         return false;
     }
 
-    // a work thread is not required as aravis already pushes the images asynchronously
-
-    g_signal_connect(stream_, "new-buffer", G_CALLBACK(aravis_new_buffer_callback), this);
-
     libtcam::logger()->info("Starting actual stream...");
 
     frames_delivered_ = 0;
     frames_dropped_ = 0;
+    reported_underruns_ = 0;
+    incomplete_frames_ = 0;
+    failed_frames_ = 0;
 
     sink_ = sink;
 
-    arv_camera_start_acquisition(this->arv_camera_, &err);
+    if (use_pop_thread_)
+    {
+        stop_pop_thread_ = false;
+        pop_thread_ = std::thread(&AravisDevice::pop_thread_func, this);
+    }
+    else
+    {
+        // a work thread is not required as aravis already pushes the images asynchronously
+        g_signal_connect(stream_, "new-buffer", G_CALLBACK(aravis_new_buffer_callback), this);
+    }
+
+    if (ARV_IS_GV_STREAM(this->stream_))
+    {
+        register_stream_bandwidth(lck0);
+    }
+
+    {
+        std::scoped_lock genicam_lck { genicam_mutex_ };
+        arv_camera_start_acquisition(this->arv_camera_, &err);
+    }
 
     if (err)
     {
         libtcam::logger()->error("Unable to start stream: {}", err->message);
         g_clear_error(&err);
 
+        // stop_stream joins the pop thread, which may be waiting for arv_camera_access_mutex_
+        lck0.unlock();
         stop_stream();
 
         return false;
     }
 
+    start_clock_sync();
+
     return true;
 }
 
 
 void AravisDevice::stop_stream()
 {
+    // the pop thread may wait for arv_camera_access_mutex_ while delivering
+    stop_pop_thread();
+    // latching the camera time requires arv_camera_access_mutex_
+    stop_clock_sync();
+
+    // the other streams on the interface may use the bandwidth again
+    // sets their packet delays, which requires their arv_camera_access_mutex_
+    tcam::aravis::AravisBandwidthManager::get().remove_stream(this);
+
     std::scoped_lock lck0 { arv_camera_access_mutex_ };
 
     if (arv_camera_ == NULL)
@@ -409,7 +566,10 @@ void AravisDevice::stop_stream()
         arv_stream_set_emit_signals(this->stream_, FALSE);
     }
 
-    arv_camera_stop_acquisition(arv_camera_, &err);
+    {
+        std::scoped_lock genicam_lck { genicam_mutex_ };
+        arv_camera_stop_acquisition(arv_camera_, &err);
+    }
 
     if (err)
     {
@@ -424,6 +584,9 @@ void AravisDevice::stop_stream()
         this->stream_ = NULL;
     }
 
+    // no image is evaluated anymore
+    g_clear_object(&chunk_parser_);
+
     // releasing the stream deletes all arv_buffer objects currently pending in the arv_stream, so we cannot re-use the actaul ImageBuffers here
 
     sink_.reset();
@@ -498,34 +661,197 @@ void AravisDevice::aravis_new_buffer_callback(ArvStream* stream __attribute__((u
         return;
     }
 
+    self->handle_arv_buffer(buffer);
+}
+
+
+void AravisDevice::pop_thread_func()
+{
+    tcam::apply_thread_policy(tcam::thread_role::delivery, "tcam_arv_pop");
+
+    // short enough to notice stop_stream in time
+    static const guint64 pop_timeout_us = 100'000;
+
+    while (!stop_pop_thread_)
+    {
+        ArvBuffer* buffer = arv_stream_timeout_pop_buffer(stream_, pop_timeout_us);
+        if (buffer == nullptr)
+        {
+            continue;
+        }
+
+        handle_arv_buffer(buffer);
+    }
+}
+
+
+void AravisDevice::stop_pop_thread()
+{
+    stop_pop_thread_ = true;
+
+    if (pop_thread_.joinable())
+    {
+        pop_thread_.join();
+    }
+}
+
+
+void AravisDevice::register_stream_bandwidth(std::unique_lock<std::recursive_mutex>& lck)
+{
+    auto& manager = tcam::aravis::AravisBandwidthManager::get();
+    if (!manager.is_active())
+    {
+        return;
+    }
+
+    auto interface_address = get_interface_address();
+    if (interface_address.empty())
+    {
+        libtcam::logger()->warn("Unable to determine the interface of the GigE stream. "
+                                "Packet delay will not be managed.");
+        return;
+    }
+
+    GError* err = nullptr;
+    tcam::aravis::bandwidth_request request = {};
+
+    {
+        std::scoped_lock genicam_lck { genicam_mutex_ };
+        request.payload = arv_camera_get_payload(arv_camera_, &err);
+    }
+    if (err)
+    {
+        libtcam::logger()->warn("Unable to read payload size: {}", err->message);
+        g_clear_error(&err);
+        return;
+    }
+    // in trigger mode this is an upper bound
+    request.framerate = active_video_format_.get_framerate();
+    request.packet_size = gige_stats_.packet_size;
+
+    // called from the threads that start and stop the streams of the interface
+    auto apply = [this, packet_size = request.packet_size](uint64_t delay_ns)
+    {
+        std::scoped_lock lck0 { arv_camera_access_mutex_ };
+        std::scoped_lock genicam_lck { genicam_mutex_ };
+
+        GError* err = nullptr;
+        arv_camera_gv_set_packet_delay(arv_camera_, delay_ns, &err);
+        if (err)
+        {
+            libtcam::logger()->warn("Unable to set packet delay: {}", err->message);
+            g_clear_error(&err);
+            return;
+        }
+
+        packet_delay_ns_ = delay_ns;
+
+        if (metrics_)
+        {
+            metrics_->set_packet_config(packet_size, delay_ns);
+        }
+    };
+
+    // the manager locks every device of the interface to apply the new delays
+    // holding this one would invert the lock order with the other devices
+    lck.unlock();
+    manager.add_stream(this, interface_address, request, apply);
+    lck.lock();
+}
+
+
+void AravisDevice::update_gige_statistics()
+{
+    if (!ARV_IS_GV_STREAM(stream_))
+    {
+        return;
+    }
+
+    // the counters are cumulative since the stream was created
+    guint64 n_resent = 0;
+    guint64 n_missing = 0;
+    arv_gv_stream_get_statistics(ARV_GV_STREAM(stream_), &n_resent, &n_missing);
+
+    // every failed buffer handed to us is counted as failure as well
+    // they are reported as incomplete or dropped frames, underruns as starvation
+    guint64 n_failures = 0;
+    arv_stream_get_statistics(stream_, nullptr, &n_failures, nullptr);
+    const guint64 n_seen = incomplete_frames_ + failed_frames_;
+    const guint64 n_lost = n_failures > n_seen ? n_failures - n_seen : 0;
+
+    auto delta = [](guint64 now, uint64_t before) -> uint64_t
+    {
+        return now > before ? now - before : 0;
+    };
+
+    const uint64_t resent = delta(n_resent, gige_stats_.packets_resent);
+    const uint64_t missing = delta(n_missing, gige_stats_.packets_missing);
+    const uint64_t lost = delta(n_lost, gige_stats_.frames_lost);
+
+    gige_stats_.frame_packets_resent = resent;
+    gige_stats_.frame_packets_missing = missing;
+    gige_stats_.packets_resent = n_resent;
+    gige_stats_.packets_missing = n_missing;
+    gige_stats_.frames_lost = n_lost;
+    // may be changed by the bandwidth manager while streaming
+    gige_stats_.packet_delay_ns = packet_delay_ns_.load(std::memory_order_relaxed);
+
+    if (metrics_)
+    {
+        metrics_->record_packets(resent, missing, lost);
+    }
+}
+
+
+void AravisDevice::handle_arv_buffer(ArvBuffer* buffer)
+{
     ArvBufferStatus status = arv_buffer_get_status(buffer);
 
+    if (status == ARV_BUFFER_STATUS_MISSING_PACKETS)
+    {
+        ++incomplete_frames_;
+    }
+    else if (status != ARV_BUFFER_STATUS_SUCCESS)
+    {
+        ++failed_frames_;
+    }
+
+    update_gige_statistics();
+
     if (status == ARV_BUFFER_STATUS_SUCCESS)
     {
-        self->complete_aravis_stream_buffer(buffer, false);
+        complete_aravis_stream_buffer(buffer, false);
     }
     else if (status == ARV_BUFFER_STATUS_MISSING_PACKETS)
     {
-        if (self->drop_incomplete_frames_)
+        if (drop_incomplete_frames_)
         {
             libtcam::logger()->debug("Image has missing packets. Dropping incomplete frame as requested.");
 
-            ++self->frames_dropped_;
+            ++frames_dropped_;
+            if (metrics_)
+            {
+                metrics_->count_drop(drop_cause::incomplete);
+            }
 
-            arv_stream_push_buffer(stream, buffer);
+            arv_stream_push_buffer(stream_, buffer);
         }
         else
         {
             libtcam::logger()->debug("Image has missing packets. Sending incomplete buffer as requested.");
 
-            self->complete_aravis_stream_buffer(buffer, true);
+            complete_aravis_stream_buffer(buffer, true);
         }
     }
     else
     {
-        ++self->frames_dropped_;
+        ++frames_dropped_;
+        if (metrics_)
+        {
+            metrics_->count_drop(drop_cause::other);
+        }
 
-        arv_stream_push_buffer(self->stream_, buffer);
+        arv_stream_push_buffer(stream_, buffer);
         auto ptr = translate_arv_buffer_status(status);
         if (ptr)
         {
@@ -567,12 +893,69 @@ void AravisDevice::complete_aravis_stream_buffer(ArvBuffer* buffer, bool is_inco
         size_t image_size = 0;
         arv_buffer_get_data(buffer, &image_size);
 
+        tcam_chunk_data chunks = {};
+        if (chunk_parser_)
+        {
+            chunks = read_chunk_data(buffer);
+            // the payload includes the chunks behind the image
+            image_size = std::min<size_t>(image_size, active_video_format_.get_required_buffer_size());
+        }
+
+        if (pool_)
+        {
+            gint queued_count = 0;
+            arv_stream_get_n_buffers(stream_, &queued_count, nullptr);
+
+            if (metrics_)
+            {
+                const size_t active_count = pool_->get_active_count();
+                metrics_->record_buffers_in_flight(
+                    active_count > (size_t)queued_count ? active_count - queued_count : 0);
+
+                // aravis counts frames it could not receive because no buffer was queued
+                guint64 n_underruns = 0;
+                arv_stream_get_statistics(stream_, nullptr, nullptr, &n_underruns);
+                if (n_underruns > reported_underruns_)
+                {
+                    metrics_->count_drop(drop_cause::starvation, n_underruns - reported_underruns_);
+                    reported_underruns_ = n_underruns;
+                }
+            }
+
+            switch (pool_->update_queue_level(queued_count))
+            {
+                case BufferPool::action::grow:
+                {
+                    grow_buffer_pool();
+                    break;
+                }
+                case BufferPool::action::shrink:
+                {
+                    std::scoped_lock lck { buffer_list_mtx_ };
+                    shrink_pending_ = true;
+                    break;
+                }
+                case BufferPool::action::none:
+                {
+                    break;
+                }
+            }
+        }
+
         tcam_stream_statistics stats = {};
+        if (pool_)
+        {
+            pool_->fill_statistics(stats);
+        }
         stats.capture_time_ns = arv_buffer_get_system_timestamp(buffer);
         stats.camera_time_ns = arv_buffer_get_timestamp(buffer);
+        stats.corrected_time_ns = clock_estimator_.to_host_time(stats.camera_time_ns);
         stats.frame_count = frames_delivered_;
         stats.frames_dropped = frames_dropped_;
         stats.is_damaged = is_incomplete;
+        stats.dequeue_time_ns = get_monotonic_time_ns();
+        stats.chunks = chunks;
+        stats.gige = gige_stats_;
 
         completed_buffer->set_statistics(stats);
         completed_buffer->set_valid_data_length(image_size);
@@ -34,6 +34,11 @@ std::recursive_mutex& AravisPropertyBackend::get_mutex() noexcept
     return parent_.arv_camera_access_mutex_;
 }
 
+std::recursive_mutex& AravisPropertyBackend::get_genicam_mutex() noexcept
+{
+    return parent_.genicam_mutex_;
+}
+
 tcamprop1::Visibility_t tcam::aravis::to_Visibility(ArvGcVisibility v) noexcept
 {
     switch (v)
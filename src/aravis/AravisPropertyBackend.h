@@ -39,7 +39,10 @@ class AravisPropertyBackend
 public:
     AravisPropertyBackend(AravisDevice& parent);
 
+    // device wide lock, see AravisDevice::arv_camera_access_mutex_
     std::recursive_mutex& get_mutex() noexcept;
+    // lock of the GenICam document, see AravisDevice::genicam_mutex_
+    std::recursive_mutex& get_genicam_mutex() noexcept;
 
 private:
     AravisDevice& parent_;
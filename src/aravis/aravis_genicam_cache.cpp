@@ -0,0 +1,168 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "aravis_genicam_cache.h"
+
+#include "../cache_file.h"
+#include "../logging.h"
+
+#include <sstream>
+
+namespace
+{
+
+// increase when the file layout or the meaning of its content changes
+const int cache_file_version = 1;
+const char* cache_file_magic = "tcam-genicam-cache";
+const char* cache_file_prefix = "genicam-nodes";
+
+
+// keys and categories are stored as rest of a line
+std::string sanitize(std::string str)
+{
+    for (auto& c : str)
+    {
+        if (c == '\n' || c == '\r')
+        {
+            c = ' ';
+        }
+    }
+    return str;
+}
+
+
+std::string get_string_feature(ArvDevice* dev, const char* name)
+{
+    GError* err = nullptr;
+    const char* value = arv_device_get_string_feature_value(dev, name, &err);
+    if (err)
+    {
+        g_clear_error(&err);
+        return {};
+    }
+    return value ? value : "";
+}
+
+} // namespace
+
+
+std::string tcam::aravis::genicam_cache_key(ArvCamera* camera)
+{
+    ArvDevice* dev = arv_camera_get_device(camera);
+
+    size_t xml_size = 0;
+    const char* xml = arv_device_get_genicam_xml(dev, &xml_size);
+    if (!xml || xml_size == 0)
+    {
+        return {};
+    }
+
+    std::string vendor = get_string_feature(dev, "DeviceVendorName");
+    std::string model = get_string_feature(dev, "DeviceModelName");
+    std::string firmware = get_string_feature(dev, "DeviceFirmwareVersion");
+    if (firmware.empty())
+    {
+        firmware = get_string_feature(dev, "DeviceVersion");
+    }
+
+    if (model.empty() || firmware.empty())
+    {
+        return {};
+    }
+
+    return vendor + " " + model + " fw " + firmware + " xml "
+           + to_hex_string(fnv1a_hash(xml, xml_size)) + " " + std::to_string(xml_size);
+}
+
+
+bool tcam::aravis::load_genicam_cache(const std::string& key,
+                                      std::vector<genicam_node_entry>& entries)
+{
+    auto file_name = get_cache_file_name(cache_file_prefix, key);
+    if (file_name.empty())
+    {
+        return false;
+    }
+
+    std::string content;
+    if (!load_cache_file(file_name, content))
+    {
+        return false;
+    }
+
+    std::istringstream in(content);
+    std::string line;
+
+    if (!std::getline(in, line)
+        || line != std::string(cache_file_magic) + " " + std::to_string(cache_file_version))
+    {
+        return false;
+    }
+
+    if (!std::getline(in, line) || line != "key " + sanitize(key))
+    {
+        return false;
+    }
+
+    std::vector<genicam_node_entry> tmp;
+    while (std::getline(in, line))
+    {
+        std::istringstream l(line);
+        std::string type;
+        genicam_node_entry entry;
+
+        if (!(l >> type >> entry.name) || type != "node")
+        {
+            libtcam::logger()->warn("Ignoring invalid GenICam cache {}", file_name);
+            return false;
+        }
+        l.get();
+        std::getline(l, entry.category);
+
+        tmp.push_back(std::move(entry));
+    }
+
+    if (tmp.empty())
+    {
+        return false;
+    }
+
+    entries = std::move(tmp);
+    return true;
+}
+
+
+void tcam::aravis::store_genicam_cache(const std::string& key,
+                                       const std::vector<genicam_node_entry>& entries)
+{
+    if (entries.empty())
+    {
+        return;
+    }
+
+    std::ostringstream out;
+
+    out << cache_file_magic << " " << cache_file_version << "\n";
+    out << "key " << sanitize(key) << "\n";
+
+    for (const auto& e : entries)
+    {
+        // feature names never contain whitespace
+        out << "node " << e.name << " " << sanitize(e.category) << "\n";
+    }
+
+    store_cache_file(get_cache_file_name(cache_file_prefix, key), out.str());
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../compiler_defines.h"
+
+#include <arv.h>
+#include <string>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::aravis
+{
+
+struct genicam_node_entry
+{
+    // display name of the category the feature belongs to
+    std::string category;
+    std::string name;
+};
+
+//
+// Persistent cache of the implemented GenICam features of a device
+//
+// Walking the category tree evaluates pIsImplemented of every feature,
+// which costs a register read per feature for most GigE devices.
+// The result only depends on the camera model, its firmware and the
+// GenICam xml, so it is stored under $XDG_CACHE_HOME/tiscamera/ and
+// reused by all devices that share these.
+//
+// Set TCAM_DISABLE_GENICAM_CACHE to always walk the category tree.
+//
+
+// returns an empty string when the device cannot be identified,
+// caching is not possible in that case
+std::string genicam_cache_key(ArvCamera* camera);
+
+// returns false when no valid entry for key exists
+bool load_genicam_cache(const std::string& key, std::vector<genicam_node_entry>& entries);
+
+// failures are logged and otherwise ignored
+void store_genicam_cache(const std::string& key, const std::vector<genicam_node_entry>& entries);
+
+} // namespace tcam::aravis
+
+VISIBILITY_POP
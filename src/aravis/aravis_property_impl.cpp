@@ -216,7 +216,7 @@ tcam::property::PropertyFlags arv_gc_get_tcam_flags(ArvGcFeatureNode* node,
 
 tcam::property::PropertyFlags prop_base_impl::get_flags_impl() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         return tcam::property::PropertyFlags::None;
@@ -225,9 +225,9 @@ tcam::property::PropertyFlags prop_base_impl::get_flags_impl() const
     return arv_gc_get_tcam_flags(feature_node_, access_mode_);
 }
 
-aravis_backend_guard prop_base_impl::acquire_backend_guard() const noexcept
+aravis_genicam_guard prop_base_impl::acquire_genicam_guard() const noexcept
 {
-    return aravis_backend_guard { backend_ };
+    return aravis_genicam_guard { backend_ };
 }
 
 tcamprop1::prop_static_info_str prop_base_impl::build_static_info(
@@ -265,7 +265,7 @@ AravisPropertyIntegerImpl::AravisPropertyIntegerImpl(
 
 outcome::result<int64_t> AravisPropertyIntegerImpl::get_value() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -281,7 +281,7 @@ outcome::result<int64_t> AravisPropertyIntegerImpl::get_value() const
 
 outcome::result<void> AravisPropertyIntegerImpl::set_value(int64_t new_value)
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -297,7 +297,7 @@ outcome::result<void> AravisPropertyIntegerImpl::set_value(int64_t new_value)
 
 tcamprop1::prop_range_integer AravisPropertyIntegerImpl::get_range() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         return {};
@@ -351,7 +351,7 @@ AravisPropertyDoubleImpl::AravisPropertyDoubleImpl(
 
 outcome::result<void> AravisPropertyDoubleImpl::set_value(double new_value)
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -366,7 +366,7 @@ outcome::result<void> AravisPropertyDoubleImpl::set_value(double new_value)
 
 outcome::result<double> AravisPropertyDoubleImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -381,7 +381,7 @@ outcome::result<double> AravisPropertyDoubleImpl::get_value() const
 
 tcamprop1::prop_range_float AravisPropertyDoubleImpl::get_range() const
 {
-    aravis_backend_guard lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -426,7 +426,7 @@ AravisPropertyBoolImpl::AravisPropertyBoolImpl(
 
 outcome::result<bool> AravisPropertyBoolImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -442,7 +442,7 @@ outcome::result<bool> AravisPropertyBoolImpl::get_value() const
 
 outcome::result<void> AravisPropertyBoolImpl::set_value(bool new_value)
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -470,7 +470,7 @@ AravisPropertyCommandImpl::AravisPropertyCommandImpl(
 
 outcome::result<void> AravisPropertyCommandImpl::execute()
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -524,7 +524,7 @@ outcome::result<std::string_view> AravisPropertyEnumImpl::get_default() const
 
 outcome::result<void> AravisPropertyEnumImpl::set_value(std::string_view new_value)
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -546,7 +546,7 @@ outcome::result<void> AravisPropertyEnumImpl::set_value(std::string_view new_val
 
 outcome::result<std::string_view> AravisPropertyEnumImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -579,7 +579,7 @@ AravisPropertyStringImpl::AravisPropertyStringImpl(
 
 std::error_code AravisPropertyStringImpl::set_value(std::string_view new_value)
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -594,7 +594,7 @@ std::error_code AravisPropertyStringImpl::set_value(std::string_view new_value)
 
 outcome::result<std::string> AravisPropertyStringImpl::get_value() const
 {
-    auto lck = acquire_backend_guard();
+    auto lck = acquire_genicam_guard();
     if (!lck)
     {
         libtcam::logger()->error("Unable to lock backend.");
@@ -621,7 +621,7 @@ balance_ratio_raw_to_wb_channel::balance_ratio_raw_to_wb_channel(
 
 outcome::result<double> balance_ratio_raw_to_wb_channel::get_value() const
 {
-    auto guard = aravis_backend_guard::acquire(backend_);
+    auto guard = aravis_genicam_guard::acquire(backend_);
     if (!guard)
         return tcam::status::ResourceNotLockable;
 
@@ -639,7 +639,7 @@ outcome::result<double> balance_ratio_raw_to_wb_channel::get_value() const
 
 outcome::result<void> balance_ratio_raw_to_wb_channel::set_value(double new_value)
 {
-    auto guard = aravis_backend_guard::acquire(backend_);
+    auto guard = aravis_genicam_guard::acquire(backend_);
     if (!guard)
         return tcam::status::ResourceNotLockable;
 
@@ -663,7 +663,7 @@ balance_ratio_to_wb_channel::balance_ratio_to_wb_channel(
 
 tcam::property::PropertyFlags balance_ratio_to_wb_channel::get_flags() const
 {
-    auto guard = aravis_backend_guard::acquire(backend_);
+    auto guard = aravis_genicam_guard::acquire(backend_);
     if (!guard)
         return PropertyFlags::None;
     if (auto sel_res = selector_->set_value(selector_entry_); !sel_res)
@@ -676,7 +676,7 @@ tcam::property::PropertyFlags balance_ratio_to_wb_channel::get_flags() const
 
 tcamprop1::prop_range_float balance_ratio_to_wb_channel::get_range() const
 {
-    auto guard = aravis_backend_guard::acquire(backend_);
+    auto guard = aravis_genicam_guard::acquire(backend_);
     if (!guard)
         return {};
     // We are not absolutely sure what the range is, we ask the control (e.g. cameras could provide a factor > 4.0
@@ -690,7 +690,7 @@ tcamprop1::prop_range_float balance_ratio_to_wb_channel::get_range() const
 
 outcome::result<double> balance_ratio_to_wb_channel::get_value() const
 {
-    auto guard = aravis_backend_guard::acquire(backend_);
+    auto guard = aravis_genicam_guard::acquire(backend_);
     if (!guard)
         return tcam::status::ResourceNotLockable;
     if (auto sel_res = selector_->set_value(selector_entry_); !sel_res)
@@ -707,7 +707,7 @@ outcome::result<double> balance_ratio_to_wb_channel::get_value() const
 
 outcome::result<void> balance_ratio_to_wb_channel::set_value(double new_value)
 {
-    auto guard = aravis_backend_guard::acquire(backend_);
+    auto guard = aravis_genicam_guard::acquire(backend_);
     if (!guard)
         return tcam::status::ResourceNotLockable;
     if (auto sel_res = selector_->set_value(selector_entry_); !sel_res)
@@ -792,3 +792,67 @@ std::vector<std::string> iris_auto_enum_override::get_entries() const
 {
     return std::vector<std::string> { "Off", "Continuous" };
 }
+
+
+action_device_key_override::action_device_key_override(
+    const std::shared_ptr<IPropertyInteger>& property_to_override)
+    : property_to_override_(property_to_override)
+{
+}
+
+outcome::result<int64_t> action_device_key_override::get_value() const
+{
+    std::scoped_lock lck(mtx_);
+    return value_.value_or(0);
+}
+
+outcome::result<void> action_device_key_override::set_value(int64_t new_value)
+{
+    std::scoped_lock lck(mtx_);
+
+    OUTCOME_TRY(property_to_override_->set_value(new_value));
+    value_ = new_value;
+
+    return outcome::success();
+}
+
+bool action_device_key_override::is_set() const
+{
+    std::scoped_lock lck(mtx_);
+    return value_.has_value();
+}
+
+
+action_command_impl::action_command_impl(
+    const std::shared_ptr<action_device_key_override>& device_key,
+    const std::shared_ptr<IPropertyInteger>& group_key,
+    const std::shared_ptr<IPropertyInteger>& group_mask,
+    send_func send)
+    : device_key_(device_key), group_key_(group_key), group_mask_(group_mask),
+      send_(std::move(send))
+{
+    static_info_.name = "ActionCommand";
+    static_info_.iccategory = group_key_->get_static_info().iccategory;
+    static_info_.display_name = "Action Command";
+    static_info_.description =
+        "Broadcast an action command with ActionDeviceKey, ActionGroupKey and ActionGroupMask "
+        "on the network interface of the device. All cameras with matching keys execute the action.";
+    static_info_.visibility = tcamprop1::Visibility_t::Expert;
+    static_info_.access = tcamprop1::Access_t::WO;
+}
+
+outcome::result<void> action_command_impl::execute()
+{
+    if (!device_key_->is_set())
+    {
+        // the camera would ignore the command, do not report success
+        libtcam::logger()->error("ActionCommand requires ActionDeviceKey to be set first.");
+        return tcam::status::InvalidParameter;
+    }
+
+    OUTCOME_TRY(auto device_key, device_key_->get_value());
+    OUTCOME_TRY(auto group_key, group_key_->get_value());
+    OUTCOME_TRY(auto group_mask, group_mask_->get_value());
+
+    return send_(device_key, group_key, group_mask);
+}
@@ -21,6 +21,10 @@
 #include "AravisPropertyBackend.h"
 
 #include <arv.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <tcamprop1.0_base/tcamprop_property_info.h>
 
 VISIBILITY_INTERNAL
@@ -64,6 +68,39 @@ private:
     std::recursive_mutex* backend_mtx_ = nullptr;
 };
 
+// Lock of the GenICam document
+// Keeps the backend alive, but does not lock the device, so properties
+// do not wait for device operations like buffer handling.
+// Accesses to different features of a device, including their
+// register I/O, still wait for each other.
+// Properties that combine features (e.g. selector and value) hold it
+// for the whole sequence, the lock is recursive.
+struct aravis_genicam_guard
+{
+    explicit aravis_genicam_guard(const std::weak_ptr<AravisPropertyBackend>& cam)
+        : owner_ { cam.lock() }
+    {
+        if (owner_)
+        {
+            lck_ = std::unique_lock<std::recursive_mutex> { owner_->get_genicam_mutex() };
+        }
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return owner_ != nullptr;
+    }
+
+    static aravis_genicam_guard acquire(const std::weak_ptr<AravisPropertyBackend>& cam) noexcept
+    {
+        return aravis_genicam_guard { cam };
+    }
+
+private:
+    std::shared_ptr<AravisPropertyBackend> owner_;
+    std::unique_lock<std::recursive_mutex> lck_;
+};
+
 class prop_base_impl
 {
 public:
@@ -73,7 +110,7 @@ public:
 protected:
     PropertyFlags get_flags_impl() const;
 
-    aravis_backend_guard acquire_backend_guard() const noexcept;
+    aravis_genicam_guard acquire_genicam_guard() const noexcept;
 
     tcamprop1::prop_static_info_str build_static_info(
         std::string_view category,
@@ -86,6 +123,7 @@ protected:
 
 private:
     std::weak_ptr<AravisPropertyBackend> backend_;
+    // resolved once, all accesses use the node directly
     ArvGcFeatureNode* feature_node_ = nullptr;
 
     tcamprop1::Access_t access_mode_ = tcamprop1::Access_t::RW;
@@ -426,6 +464,88 @@ private:
     std::shared_ptr<IPropertyBool> property_to_override_;
 };
 
+// ActionDeviceKey is write-only
+// remembers the written key so that ActionCommand can use it
+class action_device_key_override : public IPropertyInteger
+{
+public:
+    explicit action_device_key_override(
+        const std::shared_ptr<IPropertyInteger>& property_to_override);
+
+    tcamprop1::prop_static_info get_static_info() const final
+    {
+        return property_to_override_->get_static_info();
+    }
+    PropertyFlags get_flags() const final
+    {
+        return property_to_override_->get_flags();
+    }
+
+    std::string_view get_unit() const final
+    {
+        return property_to_override_->get_unit();
+    }
+    tcamprop1::IntRepresentation_t get_representation() const final
+    {
+        return property_to_override_->get_representation();
+    }
+    tcamprop1::prop_range_integer get_range() const final
+    {
+        return property_to_override_->get_range();
+    }
+    outcome::result<int64_t> get_default() const final
+    {
+        return 0;
+    }
+
+    // 0 until a key was written
+    outcome::result<int64_t> get_value() const final;
+    outcome::result<void> set_value(int64_t new_value) final;
+
+    // false until a key was written, the key of the device is unknown before
+    bool is_set() const;
+
+private:
+    std::shared_ptr<IPropertyInteger> property_to_override_;
+
+    mutable std::mutex mtx_;
+    std::optional<int64_t> value_;
+};
+
+// Sends an immediate action command with the keys the device is configured with
+// All cameras on the same interface with matching keys execute the action
+class action_command_impl : public IPropertyCommand
+{
+public:
+    using send_func = std::function<outcome::result<void>(
+        uint32_t device_key, uint32_t group_key, uint32_t group_mask)>;
+
+    action_command_impl(const std::shared_ptr<action_device_key_override>& device_key,
+                        const std::shared_ptr<IPropertyInteger>& group_key,
+                        const std::shared_ptr<IPropertyInteger>& group_mask,
+                        send_func send);
+
+    tcamprop1::prop_static_info get_static_info() const final
+    {
+        return static_info_.to_prop_static_info();
+    }
+    PropertyFlags get_flags() const final
+    {
+        return group_key_->get_flags();
+    }
+
+    outcome::result<void> execute() final;
+
+private:
+    tcamprop1::prop_static_info_str static_info_;
+
+    std::shared_ptr<action_device_key_override> device_key_;
+    std::shared_ptr<IPropertyInteger> group_key_;
+    std::shared_ptr<IPropertyInteger> group_mask_;
+
+    send_func send_;
+};
+
 } // namespace tcam::aravis
 
 VISIBILITY_POP
@@ -75,6 +75,14 @@ struct tcam_device_info
 typedef void (*tcam_device_lost_callback)(const struct tcam_device_info* info, void* user_data);
 
 
+/**
+ * @name property_changed_callback
+ * Called when the device reports a new value for the property name,
+ * e.g. because another process changed it.
+ */
+typedef void (*tcam_property_changed_callback)(const char* name, void* user_data);
+
+
 /**
  * @name tcam_image_size
  */
@@ -252,6 +260,49 @@ struct tcam_video_format
 };
 
 
+/**
+ * Bits of tcam_chunk_data::valid_fields
+ */
+enum TCAM_CHUNK_FIELD : uint32_t
+{
+    TCAM_CHUNK_EXPOSURE_TIME = 1 << 0,
+    TCAM_CHUNK_GAIN = 1 << 1,
+    TCAM_CHUNK_FRAME_ID = 1 << 2,
+    TCAM_CHUNK_LINE_STATUS_ALL = 1 << 3,
+    TCAM_CHUNK_TIMESTAMP = 1 << 4,
+};
+
+
+/**
+ * Values the camera appended as chunk data to an image
+ */
+struct tcam_chunk_data
+{
+    uint32_t valid_fields; // TCAM_CHUNK_FIELD bits of the values that are set
+    double exposure_time_us; // ChunkExposureTime
+    double gain; // ChunkGain
+    uint64_t frame_id; // ChunkFrameID
+    uint64_t line_status_all; // ChunkLineStatusAll
+    uint64_t timestamp; // ChunkTimestamp, in device ticks
+};
+
+
+/**
+ * GigE Vision packet statistics of a stream
+ * all values are 0 for other transports
+ */
+struct tcam_gige_statistics
+{
+    uint64_t packets_resent; // resent packets since stream start
+    uint64_t packets_missing; // packets that were not received after resend requests, since stream start
+    uint64_t frames_lost; // frames that failed for other reasons than missing packets, since stream start
+    uint32_t frame_packets_resent; // packets resent while this image was received
+    uint32_t frame_packets_missing; // packets missing while this image was received
+    uint32_t packet_size; // GevSCPSPacketSize in bytes, sampled at stream start
+    uint64_t packet_delay_ns; // inter packet delay, sampled at stream start
+};
+
+
 /**
  * Statistic container for additional image_buffer descriptions
  */
@@ -261,7 +312,17 @@ struct tcam_stream_statistics
     uint64_t frames_dropped; // number of frames that where not delivered
     uint64_t capture_time_ns; // capture time reported by lib
     uint64_t camera_time_ns; //capture time reported by camera; empty if not supported
+    uint64_t corrected_time_ns; // camera_time_ns mapped to the host clock; 0 if not available
     bool is_damaged; // flag indicating if the associated buffer had lost packages or other problems
+    uint32_t buffer_count; // number of buffers currently usable by the backend
+    uint64_t buffers_added; // number of times the buffer pool had to grow
+    uint64_t buffers_removed; // number of times idle buffers where released
+    uint64_t dequeue_time_ns; // CLOCK_MONOTONIC when the backend received the buffer; 0 if not set
+    uint64_t properties_done_time_ns; // CLOCK_MONOTONIC when software properties where applied
+    uint64_t frames_dropped_size_mismatch; // part of frames_dropped, images with unexpected size
+    bool sequence_gap; // frames were dropped directly before this one
+    tcam_chunk_data chunks; // chunk data of the image; valid_fields is 0 if there is none
+    tcam_gige_statistics gige; // packet statistics; all 0 for non GigE devices
 };
 
 
@@ -0,0 +1,185 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cache_file.h"
+
+#include "logging.h"
+#include "utils.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+const char* checksum_prefix = "checksum ";
+
+
+std::string get_cache_directory()
+{
+    std::string base = tcam::get_environment_variable("XDG_CACHE_HOME", "");
+
+    if (base.empty())
+    {
+        std::string home = tcam::get_environment_variable("HOME", "");
+        if (home.empty())
+        {
+            return {};
+        }
+        base = home + "/.cache";
+    }
+    return base + "/tiscamera";
+}
+
+
+bool create_directories(const std::string& path)
+{
+    // std::filesystem not used for backwards compatability
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1))
+    {
+        std::string sub = path.substr(0, pos);
+
+        if (mkdir(sub.c_str(), 0755) != 0 && errno != EEXIST)
+        {
+            return false;
+        }
+
+        if (pos == std::string::npos)
+        {
+            return true;
+        }
+    }
+}
+
+
+std::string checksum_of(const std::string& content)
+{
+    return tcam::to_hex_string(tcam::fnv1a_hash(content.data(), content.size()));
+}
+
+} // namespace
+
+
+uint64_t tcam::fnv1a_hash(const void* data, size_t size)
+{
+    auto ptr = static_cast<const unsigned char*>(data);
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= ptr[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+std::string tcam::to_hex_string(uint64_t value)
+{
+    char buf[17] = {};
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)value);
+    return buf;
+}
+
+
+std::string tcam::get_cache_file_name(const std::string& prefix, const std::string& key)
+{
+    auto dir = get_cache_directory();
+    if (dir.empty())
+    {
+        return {};
+    }
+    return dir + "/" + prefix + "-" + to_hex_string(fnv1a_hash(key.data(), key.size()));
+}
+
+
+bool tcam::load_cache_file(const std::string& file_name, std::string& content)
+{
+    std::ifstream file(file_name);
+    if (!file)
+    {
+        return false;
+    }
+
+    std::stringstream buf;
+    buf << file.rdbuf();
+    std::string tmp = buf.str();
+
+    // last line is the checksum of everything before it
+    auto pos = tmp.rfind(checksum_prefix);
+    if (pos == std::string::npos || (pos != 0 && tmp[pos - 1] != '\n'))
+    {
+        libtcam::logger()->warn("Ignoring invalid cache file {}", file_name);
+        return false;
+    }
+
+    std::string checksum = tmp.substr(pos + strlen(checksum_prefix));
+    checksum.erase(checksum.find_last_not_of("\n") + 1);
+    tmp.resize(pos);
+
+    if (checksum != checksum_of(tmp))
+    {
+        libtcam::logger()->warn("Ignoring invalid cache file {}", file_name);
+        return false;
+    }
+
+    content = std::move(tmp);
+    return true;
+}
+
+
+void tcam::store_cache_file(const std::string& file_name, const std::string& content)
+{
+    if (file_name.empty())
+    {
+        return;
+    }
+
+    auto dir = file_name.substr(0, file_name.find_last_of('/'));
+    if (!create_directories(dir))
+    {
+        libtcam::logger()->debug("Unable to create cache directory {}: {}", dir, strerror(errno));
+        return;
+    }
+
+    // write to a private file and rename it,
+    // concurrent readers/writers never see a partial file
+    std::string tmp_name = file_name + "." + std::to_string(getpid()) + ".tmp";
+
+    {
+        std::ofstream file(tmp_name, std::ios::trunc);
+        file << content << checksum_prefix << checksum_of(content) << "\n";
+        file.close();
+
+        if (!file)
+        {
+            libtcam::logger()->debug("Unable to write cache file {}", tmp_name);
+            unlink(tmp_name.c_str());
+            return;
+        }
+    }
+
+    if (rename(tmp_name.c_str(), file_name.c_str()) != 0)
+    {
+        libtcam::logger()->debug("Unable to write cache file {}: {}", file_name, strerror(errno));
+        unlink(tmp_name.c_str());
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "compiler_defines.h"
+
+#include <cstdint>
+#include <string>
+
+VISIBILITY_INTERNAL
+
+namespace tcam
+{
+
+//
+// Persistent cache files in $XDG_CACHE_HOME/tiscamera/
+//
+// Files end with a checksum line, content that was truncated or
+// modified is ignored when loading. Files are replaced atomically,
+// concurrent readers never see a partial file.
+//
+
+uint64_t fnv1a_hash(const void* data, size_t size);
+std::string to_hex_string(uint64_t value);
+
+// returns <cache directory>/<prefix>-<hash of key>
+// returns an empty string when no cache directory can be determined
+std::string get_cache_file_name(const std::string& prefix, const std::string& key);
+
+// content - file content without the checksum line
+// returns false when the file does not exist or its checksum does not match
+bool load_cache_file(const std::string& file_name, std::string& content);
+
+// failures are logged and otherwise ignored
+void store_cache_file(const std::string& file_name, const std::string& content);
+
+} // namespace tcam
+
+VISIBILITY_POP
@@ -57,6 +57,7 @@ enum
     PROP_TCAM_PROPERTIES_JSON,
     PROP_TCAMDEVICE,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_ALLOCATOR,
 };
 
 
@@ -166,6 +167,13 @@ static bool tcambin_create_source(GstTcamBin* self)
         return false;
     }
 
+    if (data.allocator_config_
+        && g_object_class_find_property(G_OBJECT_GET_CLASS(src_element.get()), "allocator"))
+    {
+        g_object_set(
+            G_OBJECT(src_element.get()), "allocator", data.allocator_config_.get(), NULL);
+    }
+
     gst_bin_add(GST_BIN(self), src_element.get());
 
     GstChildProxy* proxy = GST_CHILD_PROXY(self);
@@ -904,6 +912,25 @@ static void gst_tcambin_get_property(GObject* object,
             gst_value_set_structure(value, ptr.get());
             break;
         }
+        case PROP_ALLOCATOR:
+        {
+            if (state.src_element
+                && g_object_class_find_property(G_OBJECT_GET_CLASS(state.src_element.get()),
+                                                "allocator"))
+            {
+                g_object_get_property(G_OBJECT(state.src_element.get()), "allocator", value);
+            }
+            else if (state.allocator_config_)
+            {
+                gst_value_set_structure(value, state.allocator_config_.get());
+            }
+            else
+            {
+                auto ptr = gst_helper::make_ptr(gst_structure_new_empty("default"));
+                gst_value_set_structure(value, ptr.get());
+            }
+            break;
+        }
         default:
         {
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -1046,6 +1073,27 @@ static void gst_tcambin_set_property(GObject* object,
             }
             break;
         }
+        case PROP_ALLOCATOR:
+        {
+            if (!is_state_null(self))
+            {
+                GST_ERROR_OBJECT(
+                    self,
+                    "GObject property 'allocator' is not writable in state >= GST_STATE_READY.");
+                return;
+            }
+
+            auto strc = gst_value_get_structure(value);
+            if (strc)
+            {
+                state.allocator_config_ = gst_helper::make_ptr(gst_structure_copy(strc));
+            }
+            else
+            {
+                state.allocator_config_.reset();
+            }
+            break;
+        }
         default:
         {
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -1191,6 +1239,17 @@ static void gst_tcambin_class_init(GstTcamBinClass* klass)
             GST_TYPE_STRUCTURE,
             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ALLOCATOR,
+        g_param_spec_boxed("allocator",
+                           "Allocator for userptr buffers",
+                           "Selects the allocator used by the source for io-mode=userptr/auto. "
+                           "(Usage e.g.: 'gst-launch-1.0 tcambin "
+                           "allocator=hugepage,numa-node=0 ! ...')",
+                           GST_TYPE_STRUCTURE,
+                           static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     gst_element_class_add_pad_template(element_class, gst_static_pad_template_get(&src_template));
 
     gst_element_class_set_details_simple(element_class,
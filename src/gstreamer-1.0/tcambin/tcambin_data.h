@@ -29,6 +29,9 @@ struct tcambin_data
     std::string prop_init_json_;
     //
 
+    // forwarded to the source on creation
+    gst_helper::gst_ptr<GstStructure> allocator_config_;
+
     gst_helper::gst_ptr<GstPad> target_pad;
     gst_helper::gst_ptr<GstCaps> user_caps;
 
@@ -16,6 +16,7 @@
 
 #include "tcamconvert.h"
 
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
 #include "../../version.h"
 #include "tcamconvert_context.h"
 
@@ -280,6 +281,24 @@ static img::img_descriptor make_img_desc_from_input_buffer(const img::img_type&
         src_type, map_in_data); // no explicit stride mentioned, so assume linear memory
 }
 
+/**
+ * Record when the conversion of buffer started/ended in the tcam statistics meta, if present
+ */
+static void stamp_convert_time(GstBuffer* buffer, GstClockTime start, GstClockTime end)
+{
+    auto meta = gst_buffer_get_tcam_statistics_meta(buffer);
+    if (!meta)
+    {
+        return;
+    }
+
+    TcamStatistics stats;
+    tcam_statistics_meta_get_statistics(meta, &stats);
+    stats.convert_start_time_ns = start;
+    stats.convert_end_time_ns = end;
+    tcam_statistics_meta_set_statistics(meta, &stats);
+}
+
 static GstFlowReturn gst_tcamconvert_transform(GstBaseTransform* base,
                                                GstBuffer* inbuf,
                                                GstBuffer* outbuf)
@@ -287,6 +306,8 @@ static GstFlowReturn gst_tcamconvert_transform(GstBaseTransform* base,
     auto self = GST_TCAMCONVERT(base);
     auto& elem = get_gst_elem_reference(self);
 
+    const GstClockTime start = gst_util_get_timestamp();
+
     GstMapInfo map_in;
     if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READ))
     {
@@ -311,6 +332,12 @@ static GstFlowReturn gst_tcamconvert_transform(GstBaseTransform* base,
     gst_buffer_unmap(outbuf, &map_out);
     gst_buffer_unmap(inbuf, &map_in);
 
+    const GstClockTime end = gst_util_get_timestamp();
+
+    // the meta was copied to outbuf in copy_metadata
+    stamp_convert_time(outbuf, start, end);
+    elem.record_convert_time(end - start);
+
     return GST_FLOW_OK;
 }
 
@@ -318,6 +345,8 @@ static GstFlowReturn gst_tcamconvert_transform_ip(GstBaseTransform* base, GstBuf
 {
     auto& elem = get_gst_elem_reference(GST_TCAMCONVERT(base));
 
+    const GstClockTime start = gst_util_get_timestamp();
+
     GstMapInfo map_in;
     if (!gst_buffer_map(inbuf, &map_in, GST_MAP_READWRITE))
     {
@@ -331,6 +360,11 @@ static GstFlowReturn gst_tcamconvert_transform_ip(GstBaseTransform* base, GstBuf
 
     gst_buffer_unmap(inbuf, &map_in);
 
+    const GstClockTime end = gst_util_get_timestamp();
+
+    stamp_convert_time(inbuf, start, end);
+    elem.record_convert_time(end - start);
+
     return GST_FLOW_OK;
 }
 
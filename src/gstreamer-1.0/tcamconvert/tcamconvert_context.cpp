@@ -73,6 +73,18 @@ void tcamconvert::tcamconvert_context_base::init_from_source()
         }
     }
 
+    // share the stream metrics of the device, see tcam::StreamMetrics
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(src_element_ptr_.get()), "serial"))
+    {
+        gchar* serial = nullptr;
+        g_object_get(G_OBJECT(src_element_ptr_.get()), "serial", &serial, nullptr);
+        if (serial && serial[0] != '\0')
+        {
+            metrics_ = tcam::StreamMetrics::attach(serial);
+        }
+        g_free(serial);
+    }
+
     init_from_source_done_ = true;
 }
 
@@ -200,6 +212,7 @@ void tcamconvert::tcamconvert_context_base::on_device_closed()
     wb_red_.reset();
     wb_green_.reset();
     wb_blue_.reset();
+    metrics_.reset();
 }
 
 void tcamconvert::tcamconvert_context_base::on_input_pad_linked()
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "../../StreamMetrics.h"
 #include "transform_impl.h"
 
 #include <dutils_img/dutils_img.h>
@@ -48,6 +49,15 @@ public:
 
     bool try_connect_to_source(bool force);
 
+    // adds the duration of a transform to the metrics of the source device
+    void record_convert_time(uint64_t ns) noexcept
+    {
+        if (metrics_)
+        {
+            metrics_->record_convert(ns);
+        }
+    }
+
 private:
     img_filter::whitebalance_params whitebalance_params_;
 
@@ -70,6 +80,8 @@ private:
     std::unique_ptr<tcamprop1::property_interface_float>    wb_green_;
     std::unique_ptr<tcamprop1::property_interface_float>    wb_blue_;
 
+    std::shared_ptr<tcam::StreamMetrics> metrics_;
+
     GstTCamConvert* self_reference_ = nullptr;
 };
 } // namespace tcamconvert
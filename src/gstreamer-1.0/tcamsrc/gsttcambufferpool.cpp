@@ -16,6 +16,7 @@
 
 #include "gsttcambufferpool.h"
 
+#include "../../../libs/tcam-property/src/gst/meta/gstmetatcamchunks.h"
 #include "../../../libs/tcam-property/src/gst/meta/gstmetatcamstatistics.h"
 #include "gst/gstbufferpool.h"
 #include "gst/gstinfo.h"
@@ -23,10 +24,36 @@
 #include "mainsrc_device_state.h"
 #include "../tcamgstbase/tcamgstbase.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <gst/allocators/gstdmabuf.h>
+#include <unistd.h>
+
 struct tcam_pool_state
 {
     std::vector<tcam::mainsrc::buffer_info> buffer;
+    // guards entries of buffer the backend callback adds or changes while streaming
+    // against lookups from other threads
+    // the callback itself reads entries without it, it is the only writer
+    std::mutex buffer_mtx;
     bool is_mjpeg = false;
+
+    // only created when io-mode=dmabuf is used
+    GstAllocator* dmabuf_allocator = nullptr;
+
+    // io-mode=dmabuf-import
+    // buffers acquired from GstTcamBufferPool::other_pool_
+    // they are kept mapped and acquired while the stream runs
+    // and handed back to downstream when it stops
+    // index is identical with tcam::ImageBuffer::get_pool_index
+    struct imported_buffer
+    {
+        GstBuffer* buffer = nullptr;
+        GstMapInfo map = {};
+    };
+    std::vector<imported_buffer> imported;
 };
 
 #define GST_CAT_DEFAULT tcam_mainsrc_debug
@@ -35,8 +62,54 @@ struct tcam_pool_state
 G_DEFINE_TYPE(GstTcamBufferPool, gst_tcam_buffer_pool, GST_TYPE_BUFFER_POOL)
 
 
-static void statistics_to_gst_structure(const tcam::tcam_stream_statistics& stat,
-                                        GstStructure& struc)
+// GstBuffer -> tcam_pool_state::buffer index
+// the index is stored with an offset of 1, as 0 is returned for 'no data'
+static GQuark tcam_pool_index_quark()
+{
+    static GQuark quark = g_quark_from_static_string("GstTcamBufferPoolIndex");
+    return quark;
+}
+
+
+static tcam::mainsrc::buffer_info* find_buffer_info(GstTcamBufferPool* self, GstBuffer* buffer)
+{
+    auto index = GPOINTER_TO_UINT(
+        gst_mini_object_get_qdata(GST_MINI_OBJECT_CAST(buffer), tcam_pool_index_quark()));
+
+    if (index == 0 || index > self->state_->buffer.size())
+    {
+        return nullptr;
+    }
+
+    auto& info = self->state_->buffer[index - 1];
+    if (info.gst_buffer != buffer)
+    {
+        return nullptr;
+    }
+    return &info;
+}
+
+
+static tcam::mainsrc::buffer_info* find_buffer_info(GstTcamBufferPool* self,
+                                                    const std::shared_ptr<tcam::ImageBuffer>& buffer)
+{
+    const int index = buffer->get_pool_index();
+
+    if (index < 0 || (size_t)index >= self->state_->buffer.size())
+    {
+        return nullptr;
+    }
+
+    auto& info = self->state_->buffer[index];
+    if (info.tcam_buffer != buffer)
+    {
+        return nullptr;
+    }
+    return &info;
+}
+
+
+static TcamStatistics to_meta_statistics(const tcam::tcam_stream_statistics& stat)
 {
     // Disable this code when tracing is not enabled
     // if (gst_debug_category_get_threshold(GST_CAT_DEFAULT) >= GST_LEVEL_TRACE)
@@ -67,23 +140,86 @@ static void statistics_to_gst_structure(const tcam::tcam_stream_statistics& stat
 
     //     GST_TRACE("%s", test.c_str());
     // }
-    gst_structure_set(&struc,
-                      "frame_count",
-                      G_TYPE_UINT64,
-                      stat.frame_count,
-                      "frames_dropped",
-                      G_TYPE_UINT64,
-                      stat.frames_dropped,
-                      "capture_time_ns",
-                      G_TYPE_UINT64,
-                      stat.capture_time_ns,
-                      "camera_time_ns",
-                      G_TYPE_UINT64,
-                      stat.camera_time_ns,
-                      "is_damaged",
-                      G_TYPE_BOOLEAN,
-                      stat.is_damaged,
-                      nullptr);
+    TcamStatistics ret = {};
+    ret.frame_count = stat.frame_count;
+    ret.frames_dropped = stat.frames_dropped;
+    ret.capture_time_ns = stat.capture_time_ns;
+    ret.camera_time_ns = stat.camera_time_ns;
+    ret.corrected_time_ns = stat.corrected_time_ns;
+    ret.is_damaged = stat.is_damaged;
+    ret.buffer_count = stat.buffer_count;
+    ret.buffers_added = stat.buffers_added;
+    ret.buffers_removed = stat.buffers_removed;
+    ret.dequeue_time_ns = stat.dequeue_time_ns;
+    ret.properties_done_time_ns = stat.properties_done_time_ns;
+    ret.frames_dropped_size_mismatch = stat.frames_dropped_size_mismatch;
+    ret.sequence_gap = stat.sequence_gap;
+    ret.packets_resent = stat.gige.packets_resent;
+    ret.packets_missing = stat.gige.packets_missing;
+    ret.frames_lost = stat.gige.frames_lost;
+    ret.frame_packets_resent = stat.gige.frame_packets_resent;
+    ret.frame_packets_missing = stat.gige.frame_packets_missing;
+    ret.packet_size = stat.gige.packet_size;
+    ret.packet_delay_ns = stat.gige.packet_delay_ns;
+    return ret;
+}
+
+
+static GstBuffer* wrap_image_buffer(GstTcamBufferPool* self,
+                                    const std::shared_ptr<tcam::ImageBuffer>& b);
+
+
+// only called from the backend callback
+// tcam::BufferPool may add buffers while streaming, see max-camera-buffers
+// these are unused slots or slots that were shrunk before
+// and now have new memory
+// tcam_pool_state::buffer is never resized while streaming,
+// changes to entries are made under tcam_pool_state::buffer_mtx
+static tcam::mainsrc::buffer_info* update_buffer_info(GstTcamBufferPool* self,
+                                                      const std::shared_ptr<tcam::ImageBuffer>& buffer)
+{
+    auto info = find_buffer_info(self, buffer);
+
+    if (!info)
+    {
+        const int index = buffer->get_pool_index();
+        if (index < 0 || (size_t)index >= self->state_->buffer.size()
+            || self->state_->buffer[index].tcam_buffer)
+        {
+            return nullptr;
+        }
+
+        auto gst_buffer = wrap_image_buffer(self, buffer);
+
+        std::scoped_lock lck(self->state_->buffer_mtx);
+
+        auto& new_info = self->state_->buffer[index];
+        new_info.addr = buffer->get_image_buffer_ptr();
+        new_info.tcam_buffer = buffer;
+        new_info.gst_buffer = gst_buffer;
+
+        GST_DEBUG_OBJECT(self, "Added buffer with index %d.", index);
+
+        return &new_info;
+    }
+
+    if (info->addr != buffer->get_image_buffer_ptr())
+    {
+        const size_t size = buffer->get_image_buffer_size();
+
+        std::scoped_lock lck(self->state_->buffer_mtx);
+
+        gst_buffer_replace_all_memory(info->gst_buffer,
+                                      gst_memory_new_wrapped(static_cast<GstMemoryFlags>(0),
+                                                             buffer->get_image_buffer_ptr(),
+                                                             size,
+                                                             0,
+                                                             size,
+                                                             nullptr,
+                                                             nullptr));
+        info->addr = buffer->get_image_buffer_ptr();
+    }
+    return info;
 }
 
 
@@ -99,48 +235,70 @@ static void gst_tcam_buffer_pool_sh_callback(std::shared_ptr<tcam::ImageBuffer>
         return;
     }
 
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
+    const GstClockTime arrival_time = gst_util_get_timestamp();
 
-    for (auto& info : self->state_->buffer)
+    auto info_ptr = update_buffer_info(self, buffer);
+    if (!info_ptr)
     {
-        if (info.tcam_buffer == buffer)
-        {
-            auto stats = buffer->get_statistics();
-            GstMeta* meta =
-                gst_buffer_get_meta(info.gst_buffer, g_type_from_name("TcamStatisticsMetaApi"));
-            if (meta)
-            {
-                GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
+        GST_ERROR_OBJECT(self,
+                         "Received buffer with index %d that is not part of this pool.",
+                         buffer->get_pool_index());
+        // the backend would lose it for the rest of the stream
+        state->sink->requeue_buffer(buffer);
+        return;
+    }
+    auto& info = *info_ptr;
 
-                if (struc)
-                {
-                    statistics_to_gst_structure(stats, *struc);
-                }
-            }
+    auto stats = buffer->get_statistics();
+    // the GstStructure is only created when someone asks for it
+    auto meta = gst_buffer_get_tcam_statistics_meta(info.gst_buffer);
+    if (meta)
+    {
+        auto meta_stats = to_meta_statistics(stats);
+        meta_stats.queued_time_ns = gst_util_get_timestamp();
+        tcam_statistics_meta_set_statistics(meta, &meta_stats);
+    }
 
-            if (stats.is_damaged && !state->drop_incomplete_frames_)
-            {
-                GST_WARNING_OBJECT(GST_OBJECT(self), "Delivering damaged buffer.");
-                gst_buffer_set_flags(info.gst_buffer, GST_BUFFER_FLAG_CORRUPTED);
-            }
+    auto chunk_meta = gst_buffer_get_tcam_chunk_meta(info.gst_buffer);
+    if (chunk_meta)
+    {
+        TcamChunkData chunks = {};
+        // TCAM_CHUNK_FIELD and TCAM_CHUNK_DATA_* share their bits
+        chunks.valid_fields = stats.chunks.valid_fields;
+        chunks.exposure_time_us = stats.chunks.exposure_time_us;
+        chunks.gain = stats.chunks.gain;
+        chunks.frame_id = stats.chunks.frame_id;
+        chunks.line_status_all = stats.chunks.line_status_all;
+        chunks.timestamp = stats.chunks.timestamp;
+        tcam_chunk_meta_set_data(chunk_meta, &chunks);
+    }
 
-            // ubuntu 18 has gstreamer 1.14.x
-            // there set_size causes a stream termination when using mjpeg
-            // other cameras cause problems when this function is not called
-            // more modern systems seem to always need to call this
-            if (GST_VERSION_MINOR >= 15 || !self->state_->is_mjpeg)
-            {
-                gst_buffer_set_size(info.gst_buffer, info.tcam_buffer->get_valid_data_length());
-            }
-            info.pooled = false;
-            state->queue.push(info);
+    if (stats.is_damaged && !state->drop_incomplete_frames_)
+    {
+        GST_WARNING_OBJECT(GST_OBJECT(self), "Delivering damaged buffer.");
+        gst_buffer_set_flags(info.gst_buffer, GST_BUFFER_FLAG_CORRUPTED);
+    }
 
-            state->stream_cv_.notify_all();
-            break;
+    // ubuntu 18 has gstreamer 1.14.x
+    // there set_size causes a stream termination when using mjpeg
+    // other cameras cause problems when this function is not called
+    // more modern systems seem to always need to call this
+    if (GST_VERSION_MINOR >= 15 || !self->state_->is_mjpeg)
+    {
+        gst_buffer_set_size(info.gst_buffer, info.tcam_buffer->get_valid_data_length());
+    }
+    // the entry in tcam_pool_state::buffer is not touched
+    // other threads may read it while the buffer is queued
+    tcam::mainsrc::buffer_info queued = { info.addr, info.gst_buffer, info.tcam_buffer, arrival_time };
+    if (!state->queue.push(queued))
+    {
+        GST_ERROR_OBJECT(self, "Buffer queue is full. Dropping buffer.");
+        if (state->metrics_)
+        {
+            state->metrics_->count_drop(tcam::drop_cause::starvation);
         }
+        state->sink->requeue_buffer(buffer);
     }
-
-    lck.unlock();
 }
 
 
@@ -155,26 +313,29 @@ static GstFlowReturn gst_tcam_buffer_pool_acquire_buffer(GstBufferPool* pool,
 
     GstTcamBufferPool* self = GST_TCAM_BUFFER_POOL(pool);
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
-    std::unique_lock<std::mutex> lck(state->stream_mtx_);
     while (true)
     {
-        if (state->queue.empty() && state->is_streaming_)
-        {
-            // wait until new buffer arrives or stop waiting when we have to shut down
-            state->stream_cv_.wait(lck);
-        }
         if (!state->is_streaming_)
         {
             return GST_FLOW_FLUSHING;
         }
-        if (!state->queue.empty())
+
+        tcam::mainsrc::buffer_info buffer_desc;
+        if (state->queue.pop(buffer_desc))
         {
-            auto buffer_desc = state->queue.front();
-            state->queue.pop(); // remove buffer from queue
             *buffer = buffer_desc.gst_buffer;
 
+            // read by gst_tcam_buffer_pool_get_arrival_time on this thread
+            if (auto info = find_buffer_info(self, buffer_desc.gst_buffer))
+            {
+                info->arrival_time = buffer_desc.arrival_time;
+            }
+
             return GST_FLOW_OK;
         }
+
+        // wait until new buffer arrives or stop waiting when we have to shut down
+        state->queue.wait_until([state] { return !state->is_streaming_; });
     }
 
     // TOOD: return flushing only when inactive
@@ -190,21 +351,27 @@ static void gst_tcam_buffer_pool_release_buffer(GstBufferPool* pool, GstBuffer*
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
     std::unique_lock<std::mutex> lck(state->stream_mtx_);
-    for (auto& info : self->state_->buffer)
+
+    std::shared_ptr<tcam::ImageBuffer> tcam_buffer;
     {
-        if (info.gst_buffer == buffer)
-        {
-            info.pooled = true;
+        std::scoped_lock info_lck(self->state_->buffer_mtx);
 
-            if (state->sink)
-            {
-                state->sink->requeue_buffer(info.tcam_buffer);
-            }
-            else
-            {
-                GST_ERROR_OBJECT(self, "Unable to requeue buffer. Device is not open.");
-            }
+        auto info = find_buffer_info(self, buffer);
+        if (!info)
+        {
+            GST_ERROR_OBJECT(self, "Released buffer is not part of this pool.");
+            return;
         }
+        tcam_buffer = info->tcam_buffer;
+    }
+
+    if (state->sink)
+    {
+        state->sink->requeue_buffer(tcam_buffer);
+    }
+    else
+    {
+        GST_ERROR_OBJECT(self, "Unable to requeue buffer. Device is not open.");
     }
     lck.unlock();
 }
@@ -217,6 +384,93 @@ static gboolean gst_tcam_buffer_pool_set_config(GstBufferPool* /*bpool*/, GstStr
 }
 
 
+static GstBuffer* wrap_image_buffer(GstTcamBufferPool* self,
+                                    const std::shared_ptr<tcam::ImageBuffer>& b)
+{
+    void* address = b->get_image_buffer_ptr();
+    size_t size = b->get_image_buffer_size();
+
+    GstBuffer* gst_buffer = nullptr;
+
+    if (b->get_memory_type() == tcam::TCAM_MEMORY_TYPE_DMA_IMPORT)
+    {
+        // share the downstream memory, so that consumers can recognize it
+        // the GstBuffer itself has to be ours to get it back in release_buffer
+        auto& imp = self->state_->imported.at(b->get_pool_index());
+
+        gst_buffer = gst_buffer_new();
+        gst_buffer_append_memory(gst_buffer,
+                                 gst_memory_ref(gst_buffer_peek_memory(imp.buffer, 0)));
+    }
+    else if (b->get_memory_type() == tcam::TCAM_MEMORY_TYPE_DMA
+        && b->get_file_descriptor() >= 0)
+    {
+        if (!self->state_->dmabuf_allocator)
+        {
+            self->state_->dmabuf_allocator = gst_dmabuf_allocator_new();
+        }
+
+        // the GstMemory takes ownership of the fd it is given
+        // the original stays with the tcam::Memory
+        int fd = dup(b->get_file_descriptor());
+        if (fd >= 0)
+        {
+            gst_buffer = gst_buffer_new();
+            gst_buffer_append_memory(
+                gst_buffer,
+                gst_dmabuf_allocator_alloc(self->state_->dmabuf_allocator, fd, size));
+        }
+        else
+        {
+            GST_WARNING_OBJECT(
+                self,
+                "Unable to duplicate dmabuf fd: %s. Falling back to wrapped memory.",
+                strerror(errno));
+        }
+    }
+
+    if (!gst_buffer)
+    {
+        gst_buffer = gst_buffer_new_wrapped_full(
+            static_cast<GstMemoryFlags>(0), address, size, 0, size, nullptr, nullptr);
+    }
+
+    gst_buffer_set_flags(gst_buffer, GST_BUFFER_FLAG_LIVE);
+
+    // TODO: check config and add meta data that is listed there
+    auto meta = gst_buffer_add_tcam_statistics_meta(gst_buffer, nullptr);
+
+    if (!meta)
+    {
+        GST_WARNING_OBJECT(self, "Unable to add meta!");
+    }
+    else
+    {
+        auto m = (GstMeta*)meta;
+        m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
+    }
+
+    // valid_fields stays 0 as long as no chunks are selected
+    auto chunk_meta = gst_buffer_add_tcam_chunk_meta(gst_buffer);
+    if (chunk_meta)
+    {
+        auto m = (GstMeta*)chunk_meta;
+        m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
+    }
+
+    // tcam_pool_state::buffer has to mirror the BufferPool layout
+    // as ImageBuffer::get_pool_index is used for lookups
+    g_assert((size_t)b->get_pool_index() < self->state_->buffer.size());
+
+    gst_mini_object_set_qdata(GST_MINI_OBJECT_CAST(gst_buffer),
+                              tcam_pool_index_quark(),
+                              GUINT_TO_POINTER(b->get_pool_index() + 1),
+                              nullptr);
+
+    return gst_buffer;
+}
+
+
 static void prepare_gst_buffer_pool(GstTcamBufferPool* self)
 {
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
@@ -224,47 +478,98 @@ static void prepare_gst_buffer_pool(GstTcamBufferPool* self)
 
     auto tcam_buffers = state->buffer_pool->get_buffer();
 
+    // sized for all buffers the pool may grow to, before the stream starts
+    // the backend callback fills unused entries without reallocation
+    self->state_->buffer.resize(state->buffer_pool->get_max_count());
+
     for (auto& tb : tcam_buffers)
     {
         if (auto b = tb.lock())
         {
-            void* address = b->get_image_buffer_ptr();
-            size_t size = b->get_image_buffer_size();
+            auto& info = self->state_->buffer.at(b->get_pool_index());
+            info.addr = b->get_image_buffer_ptr();
+            info.tcam_buffer = b;
+            info.gst_buffer = wrap_image_buffer(self, b);
+        }
+    }
+}
 
 
-            GstBuffer* gst_buffer = gst_buffer_new_wrapped_full(
-                static_cast<GstMemoryFlags>(0), address, size, 0, size, nullptr, nullptr);
+// Start the bufferpool.The default implementation will preallocate
+// min-buffers buffers and put them in the queue.
+static void release_imported_buffers(GstTcamBufferPool* self)
+{
+    for (auto& imp : self->state_->imported)
+    {
+        gst_buffer_unmap(imp.buffer, &imp.map);
+        gst_buffer_unref(imp.buffer);
+    }
+    self->state_->imported.clear();
+}
 
-            gst_buffer_set_flags(gst_buffer, GST_BUFFER_FLAG_LIVE);
 
-            // TODO: check config and add meta data that is listed there
-            GstStructure* struc = gst_structure_new_empty("TcamStatistics");
-            auto meta = gst_buffer_add_tcam_statistics_meta(gst_buffer, struc);
+// acquire buffer_count buffers from other_pool_ and wrap their dmabuf fds
+static bool import_downstream_buffers(GstTcamBufferPool* self, size_t buffer_count)
+{
+    struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
-            if (!meta)
-            {
-                GST_WARNING_OBJECT(self, "Unable to add meta!");
-            }
-            else
-            {
-                auto m = (GstMeta*)meta;
-                m->flags = static_cast<GstMetaFlags>(m->flags | GST_META_FLAG_POOLED);
-            }
+    release_imported_buffers(self);
 
-            tcam::mainsrc::buffer_info info;
-            info.addr = address;
-            info.tcam_buffer = b;
-            info.gst_buffer = gst_buffer;
-            info.pooled = true;
+    std::vector<std::shared_ptr<tcam::Memory>> memory;
+    memory.reserve(buffer_count);
 
-            self->state_->buffer.push_back(info);
+    for (size_t i = 0; i < buffer_count; ++i)
+    {
+        GstBuffer* buffer = nullptr;
+        if (gst_buffer_pool_acquire_buffer(self->other_pool_, &buffer, NULL) != GST_FLOW_OK)
+        {
+            GST_ERROR_OBJECT(self,
+                             "Failed to import buffer from downstream pool. %" GST_PTR_FORMAT,
+                             (void*)self->other_pool_);
+            release_imported_buffers(self);
+            return false;
         }
+
+        GstMemory* mem = gst_buffer_peek_memory(buffer, 0);
+        if (gst_buffer_n_memory(buffer) != 1 || !gst_is_dmabuf_memory(mem))
+        {
+            GST_ERROR_OBJECT(self,
+                             "Downstream pool does not provide dmabuf memory. %" GST_PTR_FORMAT,
+                             (void*)self->other_pool_);
+            gst_buffer_unref(buffer);
+            release_imported_buffers(self);
+            return false;
+        }
+
+        // libtcam needs a cpu pointer for software properties and statistics
+        tcam_pool_state::imported_buffer imp;
+        imp.buffer = buffer;
+        if (!gst_buffer_map(buffer, &imp.map, GST_MAP_READWRITE))
+        {
+            GST_ERROR_OBJECT(self, "Unable to map imported dmabuf.");
+            gst_buffer_unref(buffer);
+            release_imported_buffers(self);
+            return false;
+        }
+
+        memory.push_back(std::make_shared<tcam::Memory>(tcam::TCAM_MEMORY_TYPE_DMA_IMPORT,
+                                                        imp.map.size,
+                                                        imp.map.data,
+                                                        gst_dmabuf_memory_get_fd(mem)));
+        self->state_->imported.push_back(imp);
+    }
+
+    auto res = state->buffer_pool->import_memory(memory);
+    if (!res)
+    {
+        GST_ERROR_OBJECT(self, "%s", res.error().message().c_str());
+        release_imported_buffers(self);
+        return false;
     }
+    return true;
 }
 
 
-// Start the bufferpool.The default implementation will preallocate
-// min-buffers buffers and put them in the queue.
 static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
 {
     GST_INFO("start");
@@ -274,7 +579,6 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
 
     if (self->other_pool_)
     {
-        GstBuffer* buffer = nullptr;
         if (!gst_buffer_pool_set_active(self->other_pool_, TRUE))
         {
             GST_ERROR_OBJECT(self,
@@ -282,15 +586,6 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
                              (void*)self->other_pool_);
             return FALSE;
         }
-        if (gst_buffer_pool_acquire_buffer(self->other_pool_, &buffer, NULL) != GST_FLOW_OK)
-        {
-            GST_ERROR_OBJECT(self,
-                             "Failed to import buffer from downstream pool. %" GST_PTR_FORMAT,
-                             (void*)self->other_pool_);
-            return FALSE;
-        }
-
-        gst_buffer_unref(buffer);
     }
 
     GstStructure* config = gst_buffer_pool_get_config(pool);
@@ -310,11 +605,23 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
 
     tcam::TCAM_MEMORY_TYPE buffer_type = tcam::mainsrc::io_mode_to_memory_type(state->io_mode_);
 
+    if (buffer_type == tcam::TCAM_MEMORY_TYPE_DMA_IMPORT && !self->other_pool_)
+    {
+        // warning was already printed in decide_allocation
+        buffer_type = tcam::TCAM_MEMORY_TYPE_MMAP;
+    }
+
     tcam::tcam_video_format format;
 
     tcam::mainsrc::caps_to_format(*caps, format);
 
-    state->buffer_pool = std::make_shared<tcam::BufferPool>(buffer_type, dev->get_allocator());
+    auto allocator = dev->get_allocator();
+    if (buffer_type == tcam::TCAM_MEMORY_TYPE_USERPTR && state->userptr_allocator_)
+    {
+        allocator = state->userptr_allocator_;
+    }
+
+    state->buffer_pool = std::make_shared<tcam::BufferPool>(buffer_type, allocator);
 
     auto alloc_res =
         state->buffer_pool->configure(tcam::VideoFormat(format), state->imagesink_buffers_);
@@ -326,11 +633,22 @@ static gboolean gst_tcam_buffer_pool_start(GstBufferPool* pool)
         return FALSE;
     }
 
+    if (buffer_type == tcam::TCAM_MEMORY_TYPE_DMA_IMPORT
+        && !import_downstream_buffers(self, state->imagesink_buffers_))
+    {
+        return FALSE;
+    }
+
+    // the backend may add buffers up to max-camera-buffers while streaming
+    // tcam::BufferPool ignores values smaller than camera-buffers
+    // every buffer has to fit into device_state::queue and the table of prepare_gst_buffer_pool
+    state->buffer_pool->set_max_count(
+        std::min((size_t)std::max(state->max_imagesink_buffers_, 0), state->queue.capacity()));
+
     // prefer user config
-    // we do not want to allocate new buffers while running
-    // and we have no reason to
+    // buffers are only added when the backend starves
     min_buffers = state->imagesink_buffers_;
-    max_buffers = state->imagesink_buffers_;
+    max_buffers = std::max(state->imagesink_buffers_, state->max_imagesink_buffers_);
 
     gst_buffer_pool_config_set_params(config, caps, size, min_buffers, max_buffers);
 
@@ -370,7 +688,11 @@ static gboolean gst_tcam_buffer_pool_stop(GstBufferPool* pool)
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
     state->stop_stream();
-    state->stream_cv_.notify_all();
+
+    // the device does not write into the imported memory anymore
+    // buffers that are still downstream keep their own reference to it
+    // a restart imports new buffers, see gst_tcam_buffer_pool_start
+    release_imported_buffers(self);
 
     return TRUE;
 }
@@ -382,7 +704,10 @@ void gst_tcam_buffer_pool_delete_buffer(GstTcamBufferPool* self)
     for (const auto& b : self->state_->buffer)
     {
         //GST_INFO("buffer refcount: %d sh_ptr usecount: %ld", b.gst_buffer->mini_object.refcount, b.tcam_buffer.use_count());
-        gst_buffer_unref(b.gst_buffer);
+        if (b.gst_buffer)
+        {
+            gst_buffer_unref(b.gst_buffer);
+        }
     }
     struct device_state* state = GST_TCAM_MAINSRC(self->src_element)->device;
 
@@ -393,6 +718,10 @@ void gst_tcam_buffer_pool_delete_buffer(GstTcamBufferPool* self)
     }
     self->state_->buffer.clear();
     state->device_->free_stream();
+
+    // tcam buffers referencing the imported memory are gone
+    // hand the memory back to downstream
+    release_imported_buffers(self);
 }
 
 
@@ -402,6 +731,15 @@ static void gst_tcam_buffer_pool_dispose(GObject* object)
 
     auto self = GST_TCAM_BUFFER_POOL(object);
 
+    if (self->state_ && self->state_->dmabuf_allocator)
+    {
+        gst_object_unref(self->state_->dmabuf_allocator);
+    }
+    if (self->other_pool_)
+    {
+        gst_object_unref(self->other_pool_);
+        self->other_pool_ = nullptr;
+    }
     delete self->state_;
     self->state_ = nullptr;
 
@@ -463,6 +801,18 @@ GstBufferPool* gst_tcam_buffer_pool_new(GstElement* src, GstCaps* caps)
     return GST_BUFFER_POOL(pool);
 }
 
+GstClockTime gst_tcam_buffer_pool_get_arrival_time(GstTcamBufferPool* self, GstBuffer* buffer)
+{
+    // only called on the streaming thread, acquire_buffer wrote the arrival time
+    auto info = find_buffer_info(self, buffer);
+    if (!info)
+    {
+        return GST_CLOCK_TIME_NONE;
+    }
+    return info->arrival_time;
+}
+
+
 void gst_tcam_buffer_pool_set_other_pool(GstTcamBufferPool* pool, GstBufferPool* other_pool)
 {
     g_return_if_fail(!gst_buffer_pool_is_active(GST_BUFFER_POOL(pool)));
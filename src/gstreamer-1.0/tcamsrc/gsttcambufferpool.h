@@ -60,4 +60,8 @@ void gst_tcam_buffer_pool_set_other_pool(GstTcamBufferPool* pool, GstBufferPool*
 
 void gst_tcam_buffer_pool_delete_buffer(GstTcamBufferPool* self);
 
+// gst_util_get_timestamp when the backend delivered buffer
+// GST_CLOCK_TIME_NONE if buffer is not part of the pool
+GstClockTime gst_tcam_buffer_pool_get_arrival_time(GstTcamBufferPool* self, GstBuffer* buffer);
+
 G_END_DECLS
@@ -18,6 +18,7 @@
 
 #include "../../../libs/gst-helper/include/tcamprop1.0_gobject/tcam_property_serialize.h"
 #include "../../../libs/tcam-property/src/tcam-property-1.0.h"
+#include "../../ThreadPolicy.h"
 #include "../../logging.h"
 #include "../tcamgstbase/tcamgstbase.h"
 #include "../tcamgstbase/tcamgststrings.h"
@@ -28,6 +29,8 @@
 #include "mainsrc_tcamprop_impl.h"
 #include "tcambind.h"
 
+#include <algorithm>
+
 #define GST_TCAM_MAINSRC_DEFAULT_N_BUFFERS 10
 
 GST_DEBUG_CATEGORY(tcam_mainsrc_debug);
@@ -58,8 +61,8 @@ GType gst_tcam_io_mode_get_type(void)
             { GST_TCAM_IO_AUTO, "GST_TCAM_IO_AUTO", "auto" },
             { GST_TCAM_IO_MMAP, "GST_TCAM_IO_MMAP", "mmap" },
             { GST_TCAM_IO_USERPTR, "GST_TCAM_IO_USERPTR", "userptr" },
-            //{ GST_TCAM_IO_DMABUF, "GST_TCAM_IO_DMABUF", "dmabuf" },
-            //{ GST_TCAM_IO_DMABUF_IMPORT, "GST_TCAM_IO_DMABUF_IMPORT", "dmabuf-import" },
+            { GST_TCAM_IO_DMABUF, "GST_TCAM_IO_DMABUF", "dmabuf" },
+            { GST_TCAM_IO_DMABUF_IMPORT, "GST_TCAM_IO_DMABUF_IMPORT", "dmabuf-import" },
 
             { 0, NULL, NULL }
         };
@@ -69,6 +72,25 @@ GType gst_tcam_io_mode_get_type(void)
 }
 
 
+GType gst_tcam_timestamp_mode_get_type(void)
+{
+    static GType tcam_timestamp_mode = 0;
+
+    if (!tcam_timestamp_mode)
+    {
+        static const GEnumValue timestamp_modes[] = {
+            { GST_TCAM_TIMESTAMP_PIPELINE, "GST_TCAM_TIMESTAMP_PIPELINE", "pipeline" },
+            { GST_TCAM_TIMESTAMP_DEVICE, "GST_TCAM_TIMESTAMP_DEVICE", "device" },
+
+            { 0, NULL, NULL }
+        };
+        tcam_timestamp_mode =
+            g_enum_register_static("GstTcamTimestampMode", timestamp_modes);
+    }
+    return tcam_timestamp_mode;
+}
+
+
 enum
 {
     SIGNAL_DEVICE_OPEN,
@@ -82,10 +104,16 @@ enum
     PROP_SERIAL,
     PROP_DEVICE_TYPE,
     PROP_CAMERA_BUFFERS,
+    PROP_MAX_CAMERA_BUFFERS,
     PROP_NUM_BUFFERS,
     PROP_IO_MODE,
     PROP_DROP_INCOMPLETE_BUFFER,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_ALLOCATOR,
+    PROP_TIMESTAMP_MODE,
+    PROP_STREAM_METRICS,
+    PROP_THREAD_POLICY,
+    PROP_CHUNKS,
 };
 
 static guint gst_tcammainsrc_signals[SIGNAL_LAST] = {
@@ -371,6 +399,7 @@ static void gst_tcam_mainsrc_device_lost_callback(const tcam::tcam_device_info*
                                    ("serial", G_TYPE_STRING, serial.c_str(), nullptr));
 
     self->device->is_streaming_ = false;
+    self->device->notify_stream_state();
 
     // the device is considered lost.
     // might as well inform via all possible channels to keep
@@ -392,6 +421,15 @@ static void gst_tcam_mainsrc_device_lost_callback(const tcam::tcam_device_info*
     // gst_tcam_mainsrc_stop(GST_BASE_SRC(self));
 }
 
+static void gst_tcam_mainsrc_property_changed_callback(const char* name, void* user_data)
+{
+    GstTcamMainSrc* self = (GstTcamMainSrc*)user_data;
+
+    // may be called from the stream thread, posting is thread safe
+    GstStructure* s = gst_structure_new("tcam-property-changed", "name", G_TYPE_STRING, name, nullptr);
+    gst_element_post_message(GST_ELEMENT(self), gst_message_new_element(GST_OBJECT(self), s));
+}
+
 static bool gst_tcam_mainsrc_init_camera(GstTcamMainSrc* self)
 {
     if (!self->device->open_camera())
@@ -403,6 +441,8 @@ static bool gst_tcam_mainsrc_init_camera(GstTcamMainSrc* self)
     // no need for explicit cleanup
     self->device->device_->register_device_lost_callback(gst_tcam_mainsrc_device_lost_callback,
                                                          self);
+    self->device->device_->register_property_changed_callback(
+        gst_tcam_mainsrc_property_changed_callback, self);
 
     // emit a signal to let other elements/users know that a device has been opened
     // and properties, etc are now usable
@@ -441,13 +481,14 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         case GST_STATE_CHANGE_READY_TO_PAUSED:
         {
             self->device->n_buffers_delivered_ = 0;
+            self->device->timestamp_mapper_.reset();
             ret = GST_STATE_CHANGE_NO_PREROLL;
             break;
         }
         case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
         {
             self->device->is_streaming_ = true;
-            self->device->stream_cv_.notify_all();
+            self->device->notify_stream_state();
             break;
         }
         default:
@@ -470,7 +511,7 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
         case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
         {
             self->device->is_streaming_ = false;
-            self->device->stream_cv_.notify_all();
+            self->device->notify_stream_state();
             ret = GST_STATE_CHANGE_NO_PREROLL;
             break;
         }
@@ -517,6 +558,64 @@ static GstStateChangeReturn gst_tcam_mainsrc_change_state(GstElement* element,
 }
 
 
+// sets PTS/DTS of buffer from the device timestamp in the statistics meta
+// arrival times of the buffers are used to follow offset and skew
+// between device clock and pipeline clock
+static void apply_device_timestamp(GstTcamMainSrc* self, GstBufferPool* pool, GstBuffer* buffer)
+{
+    auto meta = gst_buffer_get_tcam_statistics_meta(buffer);
+    if (!meta)
+    {
+        return;
+    }
+
+    // camera_time_ns is only available for some backends (GigE)
+    // capture_time_ns is the driver timestamp otherwise
+    uint64_t device_time = meta->statistics.camera_time_ns;
+    if (device_time == 0)
+    {
+        device_time = meta->statistics.capture_time_ns;
+    }
+
+    const GstClockTime arrival_time =
+        gst_tcam_buffer_pool_get_arrival_time(GST_TCAM_BUFFER_POOL(pool), buffer);
+
+    if (device_time == 0 || !GST_CLOCK_TIME_IS_VALID(arrival_time))
+    {
+        return;
+    }
+
+    GstClock* clock = gst_element_get_clock(GST_ELEMENT(self));
+    if (!clock)
+    {
+        return;
+    }
+
+    // move the arrival time into the pipeline clock
+    const GstClockTime clock_now = gst_clock_get_time(clock);
+    const GstClockTime now = gst_util_get_timestamp();
+    gst_object_unref(clock);
+
+    const GstClockTime delay = now > arrival_time ? now - arrival_time : 0;
+    if (clock_now < delay)
+    {
+        return;
+    }
+
+    const GstClockTime capture_time =
+        self->device->timestamp_mapper_.map(device_time, clock_now - delay);
+    const GstClockTime base_time = gst_element_get_base_time(GST_ELEMENT(self));
+
+    if (capture_time < base_time)
+    {
+        return;
+    }
+
+    GST_BUFFER_PTS(buffer) = capture_time - base_time;
+    GST_BUFFER_DTS(buffer) = GST_BUFFER_PTS(buffer);
+}
+
+
 static GstFlowReturn gst_tcam_mainsrc_create(GstPushSrc* push_src, GstBuffer** buffer)
 {
     GstTcamMainSrc* self = GST_TCAM_MAINSRC(push_src);
@@ -556,6 +655,26 @@ start_create:
             goto start_create;
         }
 
+        auto meta = gst_buffer_get_tcam_statistics_meta(*buffer);
+        if (meta)
+        {
+            TcamStatistics stats;
+            tcam_statistics_meta_get_statistics(meta, &stats);
+            stats.acquired_time_ns = gst_util_get_timestamp();
+            tcam_statistics_meta_set_statistics(meta, &stats);
+
+            if (self->device->metrics_ && stats.queued_time_ns != 0)
+            {
+                self->device->metrics_->record_handoff_wait(stats.acquired_time_ns
+                                                            - stats.queued_time_ns);
+            }
+        }
+
+        if (self->device->timestamp_mode_ == GST_TCAM_TIMESTAMP_DEVICE)
+        {
+            apply_device_timestamp(self, src_pool, *buffer);
+        }
+
         gst_object_unref(src_pool);
     }
     /* TODO: check why aravis throws an incomplete buffer error
@@ -981,11 +1100,42 @@ static void gst_tcam_mainsrc_set_property(GObject* object,
             }
             break;
         }
+        case PROP_MAX_CAMERA_BUFFERS:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'max-camera-buffers' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.max_imagesink_buffers_ = g_value_get_int(value);
+            break;
+        }
         case PROP_IO_MODE:
         {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'io-mode' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
             state.io_mode_ = (GstTcamIOMode)g_value_get_enum(value);
             break;
         }
+        case PROP_TIMESTAMP_MODE:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'timestamp-mode' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+            state.timestamp_mode_ = (GstTcamTimestampMode)g_value_get_enum(value);
+            break;
+        }
         case PROP_NUM_BUFFERS:
         {
             if (!is_state_ready_or_lower(self))
@@ -1015,6 +1165,59 @@ static void gst_tcam_mainsrc_set_property(GObject* object,
             self->device->set_tcam_properties(strc);
             break;
         }
+        case PROP_ALLOCATOR:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'allocator' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+
+            auto strc = gst_value_get_structure(value);
+            if (!state.set_allocator_config(strc))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "Unknown allocator '%s'. Valid are 'default' and 'hugepage'.",
+                                 gst_structure_get_name(strc));
+            }
+            break;
+        }
+        case PROP_THREAD_POLICY:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'thread-policy' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+
+            const char* str = g_value_get_string(value);
+            if (!tcam::set_thread_policies(str ? str : ""))
+            {
+                GST_ERROR_OBJECT(self, "Invalid thread-policy '%s'.", str);
+            }
+            break;
+        }
+        case PROP_CHUNKS:
+        {
+            if (!is_state_ready_or_lower(self))
+            {
+                GST_ERROR_OBJECT(self,
+                                 "GObject property 'chunks' is not writable in state >= "
+                                 "GST_STATE_PAUSED.");
+                return;
+            }
+
+            const char* str = g_value_get_string(value);
+            if (!state.set_chunk_selection(str ? str : ""))
+            {
+                GST_ERROR_OBJECT(self, "Device does not support chunks '%s'.", str);
+            }
+            break;
+        }
         default:
         {
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -1051,6 +1254,11 @@ static void gst_tcam_mainsrc_get_property(GObject* object,
             g_value_set_int(value, state.imagesink_buffers_);
             break;
         }
+        case PROP_MAX_CAMERA_BUFFERS:
+        {
+            g_value_set_int(value, state.max_imagesink_buffers_);
+            break;
+        }
         case PROP_NUM_BUFFERS:
         {
             g_value_set_int(value, state.n_buffers_);
@@ -1061,6 +1269,11 @@ static void gst_tcam_mainsrc_get_property(GObject* object,
             g_value_set_enum(value, state.io_mode_);
             break;
         }
+        case PROP_TIMESTAMP_MODE:
+        {
+            g_value_set_enum(value, state.timestamp_mode_);
+            break;
+        }
         case PROP_DROP_INCOMPLETE_BUFFER:
         {
             g_value_set_boolean(value, state.drop_incomplete_frames_);
@@ -1072,6 +1285,28 @@ static void gst_tcam_mainsrc_get_property(GObject* object,
             gst_value_set_structure(value, ptr.get());
             break;
         }
+        case PROP_ALLOCATOR:
+        {
+            gst_helper::gst_ptr<GstStructure> ptr = state.get_allocator_config();
+            gst_value_set_structure(value, ptr.get());
+            break;
+        }
+        case PROP_STREAM_METRICS:
+        {
+            gst_helper::gst_ptr<GstStructure> ptr = state.get_stream_metrics();
+            gst_value_set_structure(value, ptr.get());
+            break;
+        }
+        case PROP_THREAD_POLICY:
+        {
+            g_value_set_string(value, tcam::get_thread_policies().c_str());
+            break;
+        }
+        case PROP_CHUNKS:
+        {
+            g_value_set_string(value, state.get_chunk_selection().c_str());
+            break;
+        }
         default:
         {
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -1133,13 +1368,53 @@ static gboolean tcam_mainsrc_decide_allocation(GstBaseSrc* base_src, GstQuery* q
             self->pool = nullptr;
         }
         self->pool = gst_tcam_buffer_pool_new(GST_ELEMENT(self), caps);
-        unsigned int size = 10;
+        unsigned int size = tcam::VideoFormat(format).get_required_buffer_size();
 
         auto* config = gst_buffer_pool_get_config(self->pool);
 
-        gst_buffer_pool_config_set_params(config, caps, tcam::VideoFormat(format).get_required_buffer_size(), 10, 10);
+        gst_buffer_pool_config_set_params(
+            config,
+            caps,
+            size,
+            self->device->imagesink_buffers_,
+            std::max(self->device->imagesink_buffers_, self->device->max_imagesink_buffers_));
         gst_buffer_pool_set_config(self->pool, config);
 
+        // dmabuf-import captures into the memory of the pool proposed by downstream
+        // it has to be taken before our pool replaces it in the query
+        if (self->device->io_mode_ == GST_TCAM_IO_DMABUF_IMPORT)
+        {
+            GstBufferPool* downstream_pool = nullptr;
+            if (gst_query_get_n_allocation_pools(query))
+            {
+                gst_query_parse_nth_allocation_pool(
+                    query, 0, &downstream_pool, nullptr, nullptr, nullptr);
+            }
+
+            if (downstream_pool)
+            {
+                auto* ds_config = gst_buffer_pool_get_config(downstream_pool);
+                gst_buffer_pool_config_set_params(ds_config,
+                                                  caps,
+                                                  tcam::VideoFormat(format).get_required_buffer_size(),
+                                                  self->device->imagesink_buffers_,
+                                                  0);
+                if (!gst_buffer_pool_set_config(downstream_pool, ds_config))
+                {
+                    GST_WARNING_OBJECT(self, "Downstream pool did not accept the config as is.");
+                }
+
+                gst_tcam_buffer_pool_set_other_pool(GST_TCAM_BUFFER_POOL(self->pool),
+                                                    downstream_pool);
+                gst_object_unref(downstream_pool);
+            }
+            else
+            {
+                GST_WARNING_OBJECT(
+                    self, "io-mode=dmabuf-import requires a pool from downstream. Using mmap.");
+            }
+        }
+
         if (gst_query_get_n_allocation_pools(query))
         {
             gst_query_set_nth_allocation_pool(
@@ -1203,6 +1478,18 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
                          GST_TCAM_MAINSRC_DEFAULT_N_BUFFERS,
                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MAX_CAMERA_BUFFERS,
+        g_param_spec_int("max-camera-buffers",
+                         "Maximum Number of Buffers",
+                         "Number of buffers the stream may grow to when running out of "
+                         "buffers (0 = fixed camera-buffers). Only used with io-mode=userptr.",
+                         0,
+                         256,
+                         0,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     g_object_class_install_property(
         gobject_class,
         PROP_IO_MODE,
@@ -1213,6 +1500,17 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
                           0,
                           static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TIMESTAMP_MODE,
+        g_param_spec_enum("timestamp-mode",
+                          "Timestamp Mode",
+                          "Source of buffer timestamps. 'device' maps the device timestamp "
+                          "into the pipeline clock, independent of delivery delays",
+                          GST_TYPE_TCAM_TIMESTAMP_MODE,
+                          GST_TCAM_TIMESTAMP_PIPELINE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     g_object_class_install_property(
         gobject_class,
         PROP_NUM_BUFFERS,
@@ -1248,6 +1546,57 @@ static void gst_tcam_mainsrc_class_init(GstTcamMainSrcClass* klass)
             GST_TYPE_STRUCTURE,
             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ALLOCATOR,
+        g_param_spec_boxed(
+            "allocator",
+            "Allocator for userptr buffers",
+            "Selects the allocator used for io-mode=userptr/auto. "
+            "'default' or 'hugepage' with the optional fields page-size, numa-node, "
+            "prefault and mlock. "
+            "(Usage e.g.: 'gst-launch-1.0 tcammainsrc "
+            "allocator=hugepage,page-size=2097152,numa-node=0,mlock=true ! ...')",
+            GST_TYPE_STRUCTURE,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STREAM_METRICS,
+        g_param_spec_boxed(
+            "stream-metrics",
+            "Aggregated stream metrics",
+            "Histograms of the buffer latencies and buffer usage and the dropped frames by cause "
+            "since the device was opened. Latencies are in nanoseconds.",
+            GST_TYPE_STRUCTURE,
+            static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_THREAD_POLICY,
+        g_param_spec_string(
+            "thread-policy",
+            "Scheduling of the capture threads",
+            "Scheduler, priority and cpus of the tcam threads, applies to all devices of the process. "
+            "Roles are capture, delivery and housekeeping, schedulers other, fifo and rr. "
+            "(Usage e.g.: 'gst-launch-1.0 tcammainsrc "
+            "thread-policy=\"capture=fifo:50@2-3;delivery=rr:10@4\" ! ...')",
+            nullptr,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CHUNKS,
+        g_param_spec_string(
+            "chunks",
+            "GenICam chunk data",
+            "Comma separated list of chunks the device appends to each image. "
+            "Supported are ExposureTime, Gain, FrameID, LineStatusAll and Timestamp. "
+            "The values are attached to the buffers as TcamChunkMeta. "
+            "(Usage e.g.: 'gst-launch-1.0 tcammainsrc chunks=\"ExposureTime,FrameID\" ! ...')",
+            nullptr,
+            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     gst_tcammainsrc_signals[SIGNAL_DEVICE_OPEN] = g_signal_new("device-open",
                                                                G_TYPE_FROM_CLASS(klass),
                                                                G_SIGNAL_RUN_LAST,
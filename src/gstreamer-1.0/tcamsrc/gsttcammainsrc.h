@@ -44,10 +44,21 @@ typedef enum
     GST_TCAM_IO_AUTO = 0,
     GST_TCAM_IO_MMAP = 1,
     GST_TCAM_IO_USERPTR = 2,
-    //GST_TCAM_IO_DMABUF = 3,
-    //GST_TCAM_IO_DMABUF_IMPORT = 4,
+    GST_TCAM_IO_DMABUF = 3,
+    GST_TCAM_IO_DMABUF_IMPORT = 4,
 } GstTcamIOMode;
 
+#define GST_TYPE_TCAM_TIMESTAMP_MODE (gst_tcam_timestamp_mode_get_type())
+GType gst_tcam_timestamp_mode_get_type(void);
+
+typedef enum
+{
+    // timestamps are set by GstBaseSrc, see do-timestamp
+    GST_TCAM_TIMESTAMP_PIPELINE = 0,
+    // timestamps are derived from the device timestamp
+    GST_TCAM_TIMESTAMP_DEVICE = 1,
+} GstTcamTimestampMode;
+
 struct _GstTcamMainSrc
 {
     GstPushSrc element;
@@ -23,6 +23,7 @@
 #include "../../public_utils.h"
 #include "../tcamgstbase/tcamgstbase.h"
 #include "../tcamgstbase/tcamgstjson.h"
+#include "gsttcammainsrc.h"
 #include "tcambind.h"
 #include "tcamsrc_tcamprop_impl.h"
 
@@ -30,6 +31,7 @@
 #include <gst-helper/gst_ptr.h>
 #include <gst-helper/helper_functions.h>
 #include <gst/gst.h>
+#include <optional>
 #include <unistd.h>
 
 using namespace tcam;
@@ -47,6 +49,9 @@ struct tcamsrc_state
     tcam::TCAM_DEVICE_TYPE device_type = TCAM_DEVICE_TYPE_UNKNOWN;
 
     int cam_buffers = 10;
+    int max_cam_buffers = 0;
+    GstTcamIOMode io_mode = GST_TCAM_IO_AUTO;
+    GstTcamTimestampMode timestamp_mode = GST_TCAM_TIMESTAMP_PIPELINE;
     bool drop_incomplete_frames = true;
     bool do_timestamp = false;
     int num_buffers = -1;
@@ -54,6 +59,11 @@ struct tcamsrc_state
     gst_helper::gst_ptr<GstStructure> prop_init_gststructure_;
     std::string prop_init_json_;
 
+    gst_helper::gst_ptr<GstStructure> allocator_config_;
+    // unset when the configuration of the source element shall be used
+    std::optional<std::string> thread_policy_;
+    std::optional<std::string> chunks_;
+
     bool is_open() const noexcept
     {
         return active_source != nullptr;
@@ -95,12 +105,19 @@ enum
     PROP_SERIAL,
     PROP_DEVICE_TYPE,
     PROP_CAMERA_BUFFERS,
+    PROP_MAX_CAMERA_BUFFERS,
+    PROP_IO_MODE,
+    PROP_TIMESTAMP_MODE,
     PROP_NUM_BUFFERS,
     PROP_DO_TIMESTAMP,
     PROP_DROP_INCOMPLETE_BUFFER,
     PROP_TCAM_PROPERTIES_JSON,
     PROP_TCAMDEVICE,
     PROP_TCAM_PROPERTIES_GSTSTRUCT,
+    PROP_ALLOCATOR,
+    PROP_STREAM_METRICS,
+    PROP_THREAD_POLICY,
+    PROP_CHUNKS,
 };
 
 static tcamsrc::tcamsrc_state& get_element_state(GstTcamSrc* self)
@@ -299,6 +316,23 @@ static gboolean open_source_element(GstTcamSrc* self)
     // manually set all properties to ensure they are correctly applied
     apply_element_property(self, PROP_CAMERA_BUFFERS, &val, nullptr);
 
+    g_value_set_int(&val, state.max_cam_buffers);
+    apply_element_property(self, PROP_MAX_CAMERA_BUFFERS, &val, nullptr);
+
+    GValue val_enum = G_VALUE_INIT;
+
+    g_value_init(&val_enum, GST_TYPE_TCAM_IO_MODE);
+    g_value_set_enum(&val_enum, state.io_mode);
+
+    apply_element_property(self, PROP_IO_MODE, &val_enum, nullptr);
+    g_value_unset(&val_enum);
+
+    g_value_init(&val_enum, GST_TYPE_TCAM_TIMESTAMP_MODE);
+    g_value_set_enum(&val_enum, state.timestamp_mode);
+
+    apply_element_property(self, PROP_TIMESTAMP_MODE, &val_enum, nullptr);
+    g_value_unset(&val_enum);
+
     // g_value_reset(&val);
     // g_value_init(&val, G_TYPE_INT);
     g_value_set_int(&val, state.num_buffers);
@@ -320,6 +354,33 @@ static gboolean open_source_element(GstTcamSrc* self)
 
     apply_element_property(self, PROP_DO_TIMESTAMP, &val_bool, nullptr);
 
+    if (state.allocator_config_)
+    {
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, GST_TYPE_STRUCTURE);
+        gst_value_set_structure(&tmp, state.allocator_config_.get());
+        apply_element_property(self, PROP_ALLOCATOR, &tmp, nullptr);
+        g_value_unset(&tmp);
+    }
+
+    if (state.thread_policy_)
+    {
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, G_TYPE_STRING);
+        g_value_set_string(&tmp, state.thread_policy_->c_str());
+        apply_element_property(self, PROP_THREAD_POLICY, &tmp, nullptr);
+        g_value_unset(&tmp);
+    }
+
+    if (state.chunks_)
+    {
+        GValue tmp = G_VALUE_INIT;
+        g_value_init(&tmp, G_TYPE_STRING);
+        g_value_set_string(&tmp, state.chunks_->c_str());
+        apply_element_property(self, PROP_CHUNKS, &tmp, nullptr);
+        g_value_unset(&tmp);
+    }
+
     if (state.prop_init_gststructure_)
     {
         GValue tmp = G_VALUE_INIT;
@@ -511,6 +572,68 @@ static void apply_element_property(GstTcamSrc* self,
 
             break;
         }
+        case PROP_MAX_CAMERA_BUFFERS:
+        {
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "max-camera-buffers"))
+                {
+                    g_object_set_property(
+                        G_OBJECT(state.active_source.get()), "max-camera-buffers", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self,
+                                    "Used source element does not support 'max-camera-buffers'.");
+                }
+            }
+            else
+            {
+                state.max_cam_buffers = g_value_get_int(value);
+            }
+
+            break;
+        }
+        case PROP_IO_MODE:
+        {
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "io-mode"))
+                {
+                    g_object_set_property(G_OBJECT(state.active_source.get()), "io-mode", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self, "Used source element does not support 'io-mode'.");
+                }
+            }
+            else
+            {
+                state.io_mode = (GstTcamIOMode)g_value_get_enum(value);
+            }
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "timestamp-mode"))
+                {
+                    g_object_set_property(
+                        G_OBJECT(state.active_source.get()), "timestamp-mode", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self,
+                                    "Used source element does not support 'timestamp-mode'.");
+                }
+            }
+            else
+            {
+                state.timestamp_mode = (GstTcamTimestampMode)g_value_get_enum(value);
+            }
+            break;
+        }
         case PROP_NUM_BUFFERS:
         {
             if (state.is_open())
@@ -629,6 +752,73 @@ static void apply_element_property(GstTcamSrc* self,
             }
             break;
         }
+        case PROP_ALLOCATOR:
+        {
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "allocator"))
+                {
+                    g_object_set_property(G_OBJECT(state.active_source.get()), "allocator", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self, "Used source element does not support 'allocator'.");
+                }
+            }
+            else
+            {
+                auto strc = gst_value_get_structure(value);
+                if (strc)
+                {
+                    state.allocator_config_ = gst_helper::make_ptr(gst_structure_copy(strc));
+                }
+                else
+                {
+                    state.allocator_config_.reset();
+                }
+            }
+            break;
+        }
+        case PROP_THREAD_POLICY:
+        {
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "thread-policy"))
+                {
+                    g_object_set_property(G_OBJECT(state.active_source.get()), "thread-policy", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self, "Used source element does not support 'thread-policy'.");
+                }
+            }
+            else
+            {
+                const char* str = g_value_get_string(value);
+                state.thread_policy_ = str ? str : "";
+            }
+            break;
+        }
+        case PROP_CHUNKS:
+        {
+            if (state.is_open())
+            {
+                if (active_source_has_property(self, "chunks"))
+                {
+                    g_object_set_property(G_OBJECT(state.active_source.get()), "chunks", value);
+                }
+                else
+                {
+                    GST_INFO_OBJECT(self, "Used source element does not support 'chunks'.");
+                }
+            }
+            else
+            {
+                const char* str = g_value_get_string(value);
+                state.chunks_ = str ? str : "";
+            }
+            break;
+        }
         default:
         {
             G_OBJECT_WARN_INVALID_PROPERTY_ID(G_OBJECT(self), prop_id, pspec);
@@ -703,6 +893,44 @@ static void gst_tcam_src_get_property(GObject* object,
             }
             break;
         }
+        case PROP_MAX_CAMERA_BUFFERS:
+        {
+            if (state.is_open() && active_source_has_property(self, "max-camera-buffers"))
+            {
+                g_object_get_property(
+                    G_OBJECT(state.active_source.get()), "max-camera-buffers", value);
+            }
+            else
+            {
+                g_value_set_int(value, state.max_cam_buffers);
+            }
+            break;
+        }
+        case PROP_IO_MODE:
+        {
+            if (state.is_open() && active_source_has_property(self, "io-mode"))
+            {
+                g_object_get_property(G_OBJECT(state.active_source.get()), "io-mode", value);
+            }
+            else
+            {
+                g_value_set_enum(value, state.io_mode);
+            }
+            break;
+        }
+        case PROP_TIMESTAMP_MODE:
+        {
+            if (state.is_open() && active_source_has_property(self, "timestamp-mode"))
+            {
+                g_object_get_property(
+                    G_OBJECT(state.active_source.get()), "timestamp-mode", value);
+            }
+            else
+            {
+                g_value_set_enum(value, state.timestamp_mode);
+            }
+            break;
+        }
         case PROP_NUM_BUFFERS:
         {
             if (state.is_open())
@@ -799,6 +1027,60 @@ static void gst_tcam_src_get_property(GObject* object,
             }
             break;
         }
+        case PROP_ALLOCATOR:
+        {
+            if (state.is_open() && active_source_has_property(self, "allocator"))
+            {
+                g_object_get_property(G_OBJECT(state.active_source.get()), "allocator", value);
+            }
+            else if (!state.allocator_config_.empty())
+            {
+                gst_value_set_structure(value, state.allocator_config_.get());
+            }
+            else
+            {
+                auto ptr = gst_helper::make_ptr(gst_structure_new_empty("default"));
+                gst_value_set_structure(value, ptr.get());
+            }
+            break;
+        }
+        case PROP_STREAM_METRICS:
+        {
+            if (state.is_open() && active_source_has_property(self, "stream-metrics"))
+            {
+                g_object_get_property(G_OBJECT(state.active_source.get()), "stream-metrics", value);
+            }
+            else
+            {
+                auto ptr = gst_helper::make_ptr(gst_structure_new_empty("tcam-stream-metrics"));
+                gst_value_set_structure(value, ptr.get());
+            }
+            break;
+        }
+        case PROP_THREAD_POLICY:
+        {
+            if (state.is_open() && active_source_has_property(self, "thread-policy"))
+            {
+                g_object_get_property(G_OBJECT(state.active_source.get()), "thread-policy", value);
+            }
+            else
+            {
+                g_value_set_string(value, state.thread_policy_.value_or("").c_str());
+            }
+            break;
+        }
+        case PROP_CHUNKS:
+        {
+            if (state.is_open() && active_source_has_property(self, "chunks"))
+            {
+                g_object_get_property(G_OBJECT(state.active_source.get()), "chunks", value);
+            }
+            else
+            {
+                g_value_set_string(value, state.chunks_.value_or("").c_str());
+            }
+            break;
+        }
         default:
         {
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -916,6 +1198,35 @@ static void gst_tcam_src_class_init(GstTcamSrcClass* klass)
                          256,
                          10,
                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_MAX_CAMERA_BUFFERS,
+        g_param_spec_int("max-camera-buffers",
+                         "Maximum Number of Buffers",
+                         "Number of buffers the stream may grow to when running out of "
+                         "buffers (0 = fixed camera-buffers). Only used with io-mode=userptr.",
+                         0,
+                         256,
+                         0,
+                         static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_IO_MODE,
+        g_param_spec_enum("io-mode",
+                          "IO Mode",
+                          "Memory type used for image buffers. Only supported by tcammainsrc.",
+                          GST_TYPE_TCAM_IO_MODE,
+                          GST_TCAM_IO_AUTO,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+    g_object_class_install_property(
+        gobject_class,
+        PROP_TIMESTAMP_MODE,
+        g_param_spec_enum("timestamp-mode",
+                          "Timestamp Mode",
+                          "Source of buffer timestamps. Only supported by tcammainsrc.",
+                          GST_TYPE_TCAM_TIMESTAMP_MODE,
+                          GST_TCAM_TIMESTAMP_PIPELINE,
+                          static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
     g_object_class_install_property(
         gobject_class,
         PROP_NUM_BUFFERS,
@@ -981,6 +1292,51 @@ static void gst_tcam_src_class_init(GstTcamSrcClass* klass)
             GST_TYPE_STRUCTURE,
             static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
 
+    g_object_class_install_property(
+        gobject_class,
+        PROP_ALLOCATOR,
+        g_param_spec_boxed("allocator",
+                           "Allocator for userptr buffers",
+                           "Selects the allocator used for io-mode=userptr/auto. "
+                           "Forwarded to tcammainsrc. "
+                           "(Usage e.g.: 'gst-launch-1.0 tcamsrc "
+                           "allocator=hugepage,numa-node=0 ! ...')",
+                           GST_TYPE_STRUCTURE,
+                           static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_STREAM_METRICS,
+        g_param_spec_boxed("stream-metrics",
+                           "Aggregated stream metrics",
+                           "Histograms of the buffer latencies and buffer usage and the dropped "
+                           "frames by cause since the device was opened. Forwarded from tcammainsrc.",
+                           GST_TYPE_STRUCTURE,
+                           static_cast<GParamFlags>(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_THREAD_POLICY,
+        g_param_spec_string("thread-policy",
+                            "Scheduling of the capture threads",
+                            "Scheduler, priority and cpus of the tcam threads. "
+                            "Forwarded to tcammainsrc. "
+                            "(Usage e.g.: 'gst-launch-1.0 tcamsrc "
+                            "thread-policy=\"capture=fifo:50@2-3\" ! ...')",
+                            nullptr,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+        gobject_class,
+        PROP_CHUNKS,
+        g_param_spec_string("chunks",
+                            "GenICam chunk data",
+                            "Comma separated list of chunks attached to the buffers as TcamChunkMeta. "
+                            "Forwarded to tcammainsrc. "
+                            "(Usage e.g.: 'gst-launch-1.0 tcamsrc chunks=\"ExposureTime,Gain\" ! ...')",
+                            nullptr,
+                            static_cast<GParamFlags>(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
     gst_tcamsrc_signals[SIGNAL_DEVICE_OPEN] = g_signal_new("device-open",
                                                            G_TYPE_FROM_CLASS(klass),
                                                            G_SIGNAL_RUN_LAST,
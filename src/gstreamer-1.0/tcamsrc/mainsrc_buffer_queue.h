@@ -0,0 +1,145 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tcam::mainsrc
+{
+
+//
+// Bounded single producer, single consumer queue
+//
+// Used to hand filled buffers from the backend callback
+// to GstBufferPool::acquire_buffer.
+// push/pop never block and never take a lock.
+// The producer only enters the kernel when the consumer
+// is actually sleeping in wait().
+//
+template<typename T, size_t Capacity> class buffer_queue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity has to be a power of two");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t)
+                      && std::atomic<uint32_t>::is_always_lock_free,
+                  "futex requires a plain 32 bit word");
+
+    static constexpr size_t mask_ = Capacity - 1;
+    static constexpr size_t cache_line_ = 64;
+
+    std::array<T, Capacity> ring_ = {};
+
+    // next element to pop, only written by the consumer
+    alignas(cache_line_) std::atomic<size_t> head_ = 0;
+    // next free slot, only written by the producer
+    alignas(cache_line_) std::atomic<size_t> tail_ = 0;
+
+    // futex word, incremented for every wake up
+    alignas(cache_line_) std::atomic<uint32_t> wake_seq_ = 0;
+    std::atomic<bool> consumer_waiting_ = false;
+
+    uint32_t* futex_word() noexcept
+    {
+        return reinterpret_cast<uint32_t*>(&wake_seq_);
+    }
+
+public:
+    static constexpr size_t capacity() noexcept
+    {
+        return Capacity;
+    }
+
+    bool empty() const noexcept
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // producer side
+    // returns false when the queue is full
+    bool push(const T& value) noexcept
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail - head_.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+
+        ring_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+
+        // pairs with the fence in wait_until
+        // either the consumer sees the new tail or we see it waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting_.load(std::memory_order_relaxed))
+        {
+            wake();
+        }
+        return true;
+    }
+
+    // consumer side
+    // returns false when the queue is empty
+    bool pop(T& value) noexcept
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        value = ring_[head & mask_];
+        // do not keep references alive in unused slots
+        ring_[head & mask_] = T {};
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side
+    // sleeps until an element is available, wake() is called or stop returns true
+    // may return spuriously, callers have to check the queue again
+    template<typename Predicate> void wait_until(Predicate stop) noexcept
+    {
+        const uint32_t seq = wake_seq_.load(std::memory_order_acquire);
+
+        consumer_waiting_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (empty() && !stop())
+        {
+            syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE, seq, nullptr, nullptr, 0);
+        }
+
+        consumer_waiting_.store(false, std::memory_order_relaxed);
+    }
+
+    // wakes the consumer, e.g. after the condition given to wait_until changed
+    void wake() noexcept
+    {
+        wake_seq_.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    }
+};
+
+} // namespace tcam::mainsrc
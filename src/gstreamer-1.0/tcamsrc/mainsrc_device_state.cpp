@@ -17,6 +17,7 @@
 #include "mainsrc_device_state.h"
 
 #include "../../logging.h"
+#include "../../utils.h"
 #include "mainsrc_tcamprop_impl.h"
 #include "tcambind.h"
 #include "../tcamgstbase/tcamgststrings.h"
@@ -40,10 +41,14 @@ tcam::TCAM_MEMORY_TYPE tcam::mainsrc::io_mode_to_memory_type(GstTcamIOMode mode)
         {
             return tcam::TCAM_MEMORY_TYPE_MMAP;
         }
-        // case GST_TCAM_IO_DMABUF:
-        //     return tcam::TCAM_MEMORY_TYPE_DMA;
-        // case GST_TCAM_IO_DMABUF_IMPORT:
-        //     return tcam::TCAM_MEMORY_TYPE_DMA_IMPORT;
+        case GST_TCAM_IO_DMABUF:
+        {
+            return tcam::TCAM_MEMORY_TYPE_DMA;
+        }
+        case GST_TCAM_IO_DMABUF_IMPORT:
+        {
+            return tcam::TCAM_MEMORY_TYPE_DMA_IMPORT;
+        }
     }
     return tcam::TCAM_MEMORY_TYPE_USERPTR;
 }
@@ -57,10 +62,9 @@ GstTcamIOMode tcam::mainsrc::memory_type_to_io_mode(tcam::TCAM_MEMORY_TYPE t)
         case tcam::TCAM_MEMORY_TYPE_MMAP:
             return GST_TCAM_IO_MMAP;
         case tcam::TCAM_MEMORY_TYPE_DMA:
-        //     return GST_TCAM_IO_DMABUF;
+            return GST_TCAM_IO_DMABUF;
         case tcam::TCAM_MEMORY_TYPE_DMA_IMPORT:
-            break;
-        //     return GST_TCAM_IO_DMABUF_IMPORT;
+            return GST_TCAM_IO_DMABUF_IMPORT;
     }
     return GST_TCAM_IO_USERPTR;
 }
@@ -177,6 +181,200 @@ gst_helper::gst_ptr<GstStructure> device_state::get_tcam_properties() noexcept
     return ptr;
 }
 
+bool device_state::set_allocator_config(const GstStructure* strc) noexcept
+{
+    if (!strc || gst_structure_has_name(strc, "default"))
+    {
+        allocator_config_ = {};
+        userptr_allocator_ = nullptr;
+        return true;
+    }
+
+    if (!gst_structure_has_name(strc, "hugepage"))
+    {
+        return false;
+    }
+
+    tcam::hugepage_allocator_config config;
+
+    int int_val = 0;
+    gboolean bool_val = FALSE;
+
+    if (gst_structure_get_int(strc, "page-size", &int_val) && int_val > 0)
+    {
+        config.page_size = int_val;
+    }
+    if (gst_structure_get_int(strc, "numa-node", &int_val))
+    {
+        config.numa_node = int_val;
+    }
+    if (gst_structure_get_boolean(strc, "prefault", &bool_val))
+    {
+        config.prefault = bool_val;
+    }
+    if (gst_structure_get_boolean(strc, "mlock", &bool_val))
+    {
+        config.lock_memory = bool_val;
+    }
+
+    allocator_config_ = gst_helper::make_ptr(gst_structure_copy(strc));
+    userptr_allocator_ = std::make_shared<tcam::HugepageAllocator>(config);
+
+    return true;
+}
+
+
+gst_helper::gst_ptr<GstStructure> device_state::get_allocator_config() const noexcept
+{
+    if (allocator_config_.empty())
+    {
+        return gst_helper::make_ptr(gst_structure_new_empty("default"));
+    }
+    return gst_helper::make_ptr(gst_structure_copy(allocator_config_.get()));
+}
+
+
+static std::vector<std::string> to_chunk_list(const std::string& chunks)
+{
+    std::vector<std::string> ret;
+    for (auto& c : tcam::split_string(chunks, ","))
+    {
+        if (!c.empty())
+        {
+            ret.push_back(c);
+        }
+    }
+    return ret;
+}
+
+
+bool device_state::set_chunk_selection(const std::string& chunks) noexcept
+{
+    std::lock_guard lck { device_open_mutex_ };
+
+    if (device_ && !device_->set_chunk_selection(to_chunk_list(chunks)))
+    {
+        return false;
+    }
+    chunks_ = chunks;
+    return true;
+}
+
+
+std::string device_state::get_chunk_selection() const noexcept
+{
+    std::lock_guard lck { device_open_mutex_ };
+
+    return chunks_;
+}
+
+
+static GstStructure* histogram_to_structure(const char* name,
+                                            const tcam::metrics_histogram& histogram)
+{
+    const auto summary = tcam::summarize(histogram);
+
+    return gst_structure_new(name,
+                             "count",
+                             G_TYPE_UINT64,
+                             summary.count,
+                             "mean",
+                             G_TYPE_UINT64,
+                             summary.mean,
+                             "p50",
+                             G_TYPE_UINT64,
+                             summary.p50,
+                             "p90",
+                             G_TYPE_UINT64,
+                             summary.p90,
+                             "p99",
+                             G_TYPE_UINT64,
+                             summary.p99,
+                             "p999",
+                             G_TYPE_UINT64,
+                             summary.p999,
+                             "max",
+                             G_TYPE_UINT64,
+                             summary.max,
+                             nullptr);
+}
+
+
+gst_helper::gst_ptr<GstStructure> device_state::get_stream_metrics() noexcept
+{
+    std::shared_ptr<tcam::StreamMetrics> metrics;
+    {
+        std::lock_guard<std::mutex> lck(stream_mtx_);
+        metrics = metrics_;
+    }
+
+    if (!metrics)
+    {
+        return gst_helper::make_ptr(gst_structure_new_empty("tcam-stream-metrics"));
+    }
+
+    const auto& data = metrics->data();
+
+    auto ret = gst_helper::make_ptr(
+        gst_structure_new("tcam-stream-metrics",
+                          "serial",
+                          G_TYPE_STRING,
+                          metrics->get_serial().c_str(),
+                          "frames-delivered",
+                          G_TYPE_UINT64,
+                          (guint64)data.frames_delivered.load(std::memory_order_relaxed),
+                          nullptr));
+
+    for (size_t i = 0; i < tcam::drop_cause_count; ++i)
+    {
+        const std::string field =
+            std::string("drops-") + tcam::drop_cause_to_string(static_cast<tcam::drop_cause>(i));
+        gst_structure_set(ret.get(),
+                          field.c_str(),
+                          G_TYPE_UINT64,
+                          (guint64)data.drops[i].load(std::memory_order_relaxed),
+                          nullptr);
+    }
+
+    // GigE Vision transport, all 0 for other devices
+    gst_structure_set(ret.get(),
+                      "packets-resent",
+                      G_TYPE_UINT64,
+                      (guint64)data.packets_resent.load(std::memory_order_relaxed),
+                      "packets-missing",
+                      G_TYPE_UINT64,
+                      (guint64)data.packets_missing.load(std::memory_order_relaxed),
+                      "frames-lost",
+                      G_TYPE_UINT64,
+                      (guint64)data.frames_lost.load(std::memory_order_relaxed),
+                      "packet-size",
+                      G_TYPE_UINT64,
+                      (guint64)data.packet_size.load(std::memory_order_relaxed),
+                      "packet-delay-ns",
+                      G_TYPE_UINT64,
+                      (guint64)data.packet_delay_ns.load(std::memory_order_relaxed),
+                      nullptr);
+
+    const std::pair<const char*, const tcam::metrics_histogram*> histograms[] = {
+        { "dequeue-to-push-ns", &data.dequeue_to_push_ns },
+        { "handoff-wait-ns", &data.handoff_wait_ns },
+        { "convert-ns", &data.convert_ns },
+        { "buffers-in-flight", &data.buffers_in_flight },
+        { "packets-resent-per-frame", &data.packets_resent_per_frame },
+    };
+
+    for (const auto& [name, histogram] : histograms)
+    {
+        GValue val = G_VALUE_INIT;
+        g_value_init(&val, GST_TYPE_STRUCTURE);
+        g_value_take_boxed(&val, histogram_to_structure("histogram", *histogram));
+        gst_structure_take_value(ret.get(), name, &val);
+    }
+
+    return ret;
+}
+
+
 std::string device_state::get_device_serial() const noexcept
 {
     std::lock_guard lck { device_open_mutex_ };
@@ -237,6 +435,7 @@ void device_state::stop_stream()
         device_->stop_stream();
     }
     is_streaming_ = false;
+    notify_stream_state();
 }
 
 
@@ -246,10 +445,9 @@ void device_state::stop_and_clear()
     {
         device_->stop_stream();
     }
-    while (!queue.empty())
+    tcam::mainsrc::buffer_info ptr;
+    while (queue.pop(ptr))
     {
-        auto ptr = queue.front();
-        queue.pop();
         if (sink)
         {
             sink->requeue_buffer(ptr.tcam_buffer);
@@ -269,6 +467,7 @@ void device_state::close()
         stop_and_clear();
 
         device_ = nullptr;
+        metrics_ = nullptr;
         sink = nullptr;
         all_caps_.reset();
     }
@@ -307,6 +506,29 @@ void device_state::populate_tcamprop_interface()
 
 void device_state::apply_properties(const GstStructure& strct)
 {
+    tcamprop1_gobj::apply_batch_functions batch;
+    if (device_)
+    {
+        // all settings reach the device at once and apply to the same image
+        batch.begin = [this]() { device_->begin_property_batch(); };
+        batch.commit = [this]()
+        {
+            std::vector<tcam::property::batch_write_failure> failed;
+            auto res = device_->commit_property_batch(failed);
+            if (!res && failed.empty())
+            {
+                GST_WARNING_OBJECT(parent_,
+                                   "Failed to write properties to the device: '%s'",
+                                   res.error().message().c_str());
+            }
+
+            // reported through the error function of apply_properties
+            std::vector<tcamprop1_gobj::batch_failure> ret;
+            for (auto& f : failed) { ret.push_back({ std::move(f.name), f.error }); }
+            return ret;
+        };
+    }
+
     tcamprop1_gobj::apply_properties(
         TCAM_PROPERTY_PROVIDER(parent_),
         strct,
@@ -316,7 +538,8 @@ void device_state::apply_properties(const GstStructure& strct)
                                "Failed to init property named '%s' due to: '%s'",
                                prop_name.c_str(),
                                err.message);
-        });
+        },
+        batch);
 }
 
 bool device_state::open_camera()
@@ -345,7 +568,20 @@ bool device_state::open_camera()
         return false;
     }
 
+    // before any buffer is allocated, chunks may require bigger buffers
+    if (!dev->set_chunk_selection(to_chunk_list(chunks_)))
+    {
+        GST_ELEMENT_ERROR(parent_,
+                          RESOURCE,
+                          SETTINGS,
+                          ("Device does not support chunks '%s'.", chunks_.c_str()),
+                          (NULL));
+        close();
+        return false;
+    }
+
     device_ = dev;
+    metrics_ = dev->get_metrics();
     all_caps_ = caps;
 
     GST_DEBUG_OBJECT(
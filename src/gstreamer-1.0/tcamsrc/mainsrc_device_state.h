@@ -19,12 +19,12 @@
 #include "../../tcam.h"
 #include "gsttcambufferpool.h"
 #include "gsttcammainsrc.h"
+#include "mainsrc_buffer_queue.h"
+#include "mainsrc_timestamp_mapper.h"
 
-#include <condition_variable>
 #include <gst-helper/helper_functions.h>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <tcamprop1.0_base/tcamprop_property_interface.h>
 #include <tcamprop1.0_gobject/tcam_property_provider.h>
@@ -46,7 +46,9 @@ struct buffer_info
     void* addr = nullptr;
     GstBuffer* gst_buffer = nullptr;
     std::shared_ptr<tcam::ImageBuffer> tcam_buffer;
-    bool pooled;
+    // gst_util_get_timestamp when the backend delivered the buffer
+    // passed through device_state::queue, only the streaming thread writes it into the pool
+    GstClockTime arrival_time = GST_CLOCK_TIME_NONE;
 };
 
 //std::vector<buffer_info> get_buffer_collection(GstTcamBufferPool* pool);
@@ -97,15 +99,50 @@ public: // data members currently still used in gstmainsrc.cpp, maybe move them
     GstTcamIOMode io_mode_ = GST_TCAM_IO_AUTO;
 
 public: // streaming stuff
+    // guards sink against close() while buffers are released
+    // not taken for the per frame handoff, that is done via queue
     std::mutex stream_mtx_;
-    std::condition_variable stream_cv_;
     std::atomic<bool> is_streaming_ = false;
 
-    std::queue<tcam::mainsrc::buffer_info> queue;
+    // filled buffers, pushed by the backend callback, popped in acquire_buffer
+    // capacity is the maximum of camera-buffers/max-camera-buffers
+    tcam::mainsrc::buffer_queue<tcam::mainsrc::buffer_info, 256> queue;
+
+    // metrics of device_, nullptr when no device is open
+    std::shared_ptr<tcam::StreamMetrics> metrics_;
+
+    // wakes the consumer of queue, call after changing is_streaming_
+    void notify_stream_state() noexcept
+    {
+        queue.wake();
+    }
 
 public: // sink init properties, should be moved into this object
     int imagesink_buffers_ = 10;
+    // upper limit for buffers added while streaming, <= imagesink_buffers_ disables growing
+    int max_imagesink_buffers_ = 0;
     bool drop_incomplete_frames_ = true;
+    GstTcamTimestampMode timestamp_mode_ = GST_TCAM_TIMESTAMP_PIPELINE;
+
+public: // only used by the streaming thread, see timestamp-mode=device
+    tcam::mainsrc::timestamp_mapper timestamp_mapper_;
+
+public: // allocator used for userptr buffers, nullptr means the device default
+    std::shared_ptr<tcam::AllocatorInterface> userptr_allocator_;
+
+    // returns false if the structure describes no known allocator
+    bool set_allocator_config(const GstStructure* strc) noexcept;
+    gst_helper::gst_ptr<GstStructure> get_allocator_config() const noexcept;
+
+public: // GenICam chunks, comma separated list of ChunkSelector entries
+    // applied to the open device or on the next open
+    // returns false when the open device does not support the selection
+    bool set_chunk_selection(const std::string& chunks) noexcept;
+    std::string get_chunk_selection() const noexcept;
+
+public: // aggregated stream metrics, see tcam::StreamMetrics
+    // returns an empty structure when no device is open
+    gst_helper::gst_ptr<GstStructure> get_stream_metrics() noexcept;
 
 public: // members used for num-buffers functionality
     int n_buffers_ = -1;
@@ -154,6 +191,9 @@ private:
     tcam::TCAM_DEVICE_TYPE device_type_to_open_ = tcam::TCAM_DEVICE_TYPE_UNKNOWN;
     gst_helper::gst_ptr<GstStructure> prop_init_;
 
+    gst_helper::gst_ptr<GstStructure> allocator_config_;
+
+    std::string chunks_;
 
     // cache for the device caps
     gst_helper::gst_ptr<GstCaps> all_caps_;
@@ -17,6 +17,7 @@
 #include "mainsrc_gst_device_provider.h"
 
 #include "../../DeviceIndex.h"
+#include "../../ThreadPolicy.h"
 #include "../../logging.h"
 #include "../../utils.h"
 #include "mainsrc_gst_device.h"
@@ -163,7 +164,7 @@ static void run_update_logic(std::unique_lock<std::mutex>& /*lck*/,
 
 static void update_device_list(TcamMainSrcDeviceProvider* self)
 {
-    tcam::set_thread_name( "tcam_gstdevlst" );
+    tcam::apply_thread_policy(tcam::thread_role::housekeeping, "tcam_gstdevlst");
     std::unique_lock<std::mutex> lck( self->state->mtx_ );
     while (self->state->run_updates_)
     {
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mainsrc_timestamp_mapper.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// device timestamps that deviate more than this from the current fit
+// are considered a discontinuity, e.g. a camera reset
+constexpr double max_deviation_ns = 1'000'000'000.0;
+
+// the envelope candidates are kept for a skew this much below the fitted one
+// the larger it is, the more candidates are kept and the less often they are rebuilt
+constexpr double envelope_skew_margin = 0.000'01;
+
+} // namespace
+
+
+tcam::mainsrc::timestamp_mapper::timestamp_mapper(size_t window_size)
+    : fit_(window_size, max_deviation_ns)
+{
+}
+
+
+void tcam::mainsrc::timestamp_mapper::reset()
+{
+    fit_.reset();
+    envelope_.clear();
+    envelope_skew_ = 1.0;
+    last_result_ = 0;
+}
+
+
+void tcam::mainsrc::timestamp_mapper::rebuild_envelope()
+{
+    envelope_.clear();
+
+    for (size_t i = 0; i < fit_.size(); ++i) { update_envelope(fit_.get_sample(i)); }
+}
+
+
+void tcam::mainsrc::timestamp_mapper::update_envelope(const sample& s)
+{
+    while (!envelope_.empty()
+           && envelope_.back().host - envelope_skew_ * envelope_.back().device
+                  >= s.host - envelope_skew_ * s.device)
+    {
+        envelope_.pop_back();
+    }
+    envelope_.push_back(s);
+}
+
+
+uint64_t tcam::mainsrc::timestamp_mapper::map(uint64_t device_ns, uint64_t host_ns)
+{
+    if (fit_.add(device_ns, host_ns))
+    {
+        envelope_.clear();
+        envelope_skew_ = 1.0;
+    }
+
+    // drop the candidates that left the window
+    // device times are unique and increasing within the window
+    const double oldest = fit_.get_sample(0).device;
+    while (!envelope_.empty() && envelope_.front().device < oldest) { envelope_.pop_front(); }
+
+    const sample& s = fit_.get_sample(fit_.size() - 1);
+    update_envelope(s);
+
+    const double skew = fit_.get_slope();
+
+    // a sample that is not in envelope_ has a later sample with a smaller residual
+    // for envelope_skew_, that stays true for every larger skew
+    if (skew < envelope_skew_ || skew > envelope_skew_ + 2 * envelope_skew_margin)
+    {
+        envelope_skew_ = skew - envelope_skew_margin;
+        rebuild_envelope();
+    }
+
+    // move the line to the earliest arrival
+    double offset = INFINITY;
+    for (const auto& e : envelope_) { offset = std::min(offset, e.host - skew * e.device); }
+
+    const double mapped = offset + skew * s.device;
+
+    uint64_t result = fit_.get_base_host();
+    if (mapped >= 0.0)
+    {
+        result += (uint64_t)std::llround(mapped);
+    }
+    else
+    {
+        result -= std::min(result, (uint64_t)std::llround(-mapped));
+    }
+
+    if (result <= last_result_)
+    {
+        result = last_result_ + 1;
+    }
+    last_result_ = result;
+
+    return result;
+}
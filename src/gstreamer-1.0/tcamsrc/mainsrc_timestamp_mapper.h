@@ -0,0 +1,79 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../../ClockFit.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+namespace tcam::mainsrc
+{
+
+//
+// Maps device timestamps into a host clock
+//
+// Each frame provides the device timestamp and the host time it arrived at.
+// A tcam::ClockFit over the last samples estimates offset and skew
+// between both clocks. As arrival times only contain positive delays
+// (transfer, scheduling), the fit is moved to the lower envelope of the
+// samples. The result follows the device timing without the host jitter.
+//
+// map is called for every frame on the streaming thread.
+// The earliest arrival is searched in a short queue of candidates,
+// instead of a pass over the whole window.
+//
+class timestamp_mapper
+{
+public:
+    explicit timestamp_mapper(size_t window_size = 512);
+
+    // forget all samples, e.g. on stream start
+    void reset();
+
+    // device_ns - timestamp reported by the device
+    // host_ns - time the frame arrived at, in the clock the result shall be in
+    // returns the device timestamp in the host clock
+    // results are strictly increasing until the next reset
+    uint64_t map(uint64_t device_ns, uint64_t host_ns);
+
+    // host clock ticks per device clock tick
+    double get_skew() const noexcept
+    {
+        return fit_.get_slope();
+    }
+
+private:
+    using sample = ClockFit::sample;
+
+    void update_envelope(const sample& s);
+    // recompute the envelope queue for envelope_skew_
+    void rebuild_envelope();
+
+    ClockFit fit_;
+
+    // candidates for the earliest arrival, host - skew * device is smallest
+    // holds every sample that has no later sample with a smaller
+    // host - envelope_skew_ * device, which covers every skew >= envelope_skew_
+    std::deque<sample> envelope_;
+    double envelope_skew_ = 1.0;
+
+    uint64_t last_result_ = 0;
+};
+
+} // namespace tcam::mainsrc
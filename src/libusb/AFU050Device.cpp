@@ -360,6 +360,13 @@ void tcam::AFU050Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buf)
 {
     std::scoped_lock lck { buffer_list_mtx_ };
 
+    const int index = buf->get_pool_index();
+    if (index >= 0 && (size_t)index < buffer_list_.size() && buffer_list_[index].buffer == buf)
+    {
+        buffer_list_[index].is_queued = true;
+        return;
+    }
+
     for (auto& b : buffer_list_)
     {
         if (b.buffer->get_image_buffer_ptr() == buf->get_image_buffer_ptr())
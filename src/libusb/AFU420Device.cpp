@@ -658,6 +658,14 @@ void AFU420Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
     buffer->set_valid_data_length(0);
 
     std::scoped_lock lck { buffers_mutex_ };
+
+    const int index = buffer->get_pool_index();
+    if (index >= 0 && (size_t)index < buffer_list_.size() && buffer_list_[index].buffer == buffer)
+    {
+        buffer_list_[index].is_queued = true;
+        return;
+    }
+
     for (auto& b : buffer_list_)
     {
         if (buffer == b.buffer)
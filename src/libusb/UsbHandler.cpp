@@ -16,6 +16,7 @@
 
 #include "UsbHandler.h"
 
+#include "../ThreadPolicy.h"
 #include "../logging.h"
 #include "../utils.h"
 
@@ -282,7 +283,7 @@ std::vector<DeviceInfo> UsbHandler::get_device_list()
 
 void UsbHandler::handle_events()
 {
-    tcam::set_thread_name("tcam_usbhand");
+    tcam::apply_thread_policy(tcam::thread_role::capture, "tcam_usbhand");
     struct timeval tv = {};
     tv.tv_usec = 200; // #TODO this seems to be an excessively short wake timeout
     while (run_event_thread)
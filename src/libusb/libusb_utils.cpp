@@ -3,6 +3,7 @@
 
 #include "libusb_utils.h"
 
+#include "../ThreadPolicy.h"
 #include "../utils.h"
 #include "UsbHandler.h"
 
@@ -60,7 +61,7 @@ void libusb::deliver_thread::start(const std::shared_ptr<IImageBufferSink>& sink
 
 void libusb::deliver_thread::thread_main()
 {
-    tcam::set_thread_name("tcam-usb-dlv");
+    tcam::apply_thread_policy(tcam::thread_role::delivery, "tcam-usb-dlv");
 
     while (true)
     {
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ActionCommand.h"
+
+#include "gigevision.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace tis
+{
+
+int sendActionCommand(Socket& socket,
+                      const std::string& destination,
+                      const ActionCommand& command,
+                      int expected_acks)
+{
+    static std::atomic<unsigned short> request_id = 1;
+
+    unsigned short id = request_id++;
+    if (id == 0)
+    {
+        // 0 is not a valid request id
+        id = request_id++;
+    }
+
+    Packet::CMD_ACTION packet = Packet::CMD_ACTION();
+
+    size_t size = sizeof(Packet::CMD_ACTION);
+    if (command.action_time == 0)
+    {
+        size -= sizeof(packet.action_time_high) + sizeof(packet.action_time_low);
+    }
+
+    packet.header.magic = 0x42;
+    packet.header.flag = expected_acks > 0 ? Flags::NEEDACK : 0;
+    packet.header.command = htons(Commands::ACTION_CMD);
+    packet.header.length = htons(size - sizeof(Packet::COMMAND_HEADER));
+    packet.header.req_id = htons(id);
+
+    packet.device_key = htonl(command.device_key);
+    packet.group_key = htonl(command.group_key);
+    packet.group_mask = htonl(command.group_mask);
+
+    if (command.action_time != 0)
+    {
+        packet.header.flag |= Flags::SCHEDULED_ACTION;
+        packet.action_time_high = htonl(command.action_time >> 32);
+        packet.action_time_low = htonl(command.action_time & 0xFFFFFFFF);
+    }
+
+    int acks = 0;
+
+    auto callback = [id, expected_acks, &acks](void* msg) -> int {
+        auto ack = (Packet::ACK_ACTION*)msg;
+
+        if (ntohs(ack->header.answer) == Commands::ACTION_ACK
+            && ntohs(ack->header.ack_id) == id && ntohs(ack->header.status) == Status::SUCCESS)
+        {
+            acks++;
+        }
+
+        if (acks >= expected_acks)
+        {
+            return Socket::SendAndReceiveSignals::END;
+        }
+        return Socket::SendAndReceiveSignals::CONTINUE;
+    };
+
+    try
+    {
+        if (expected_acks > 0)
+        {
+            socket.sendAndReceive(destination, &packet, size, callback, true);
+        }
+        else
+        {
+            socket.sendAndReceive(destination, &packet, size, NULL, true);
+        }
+    }
+    catch (SocketSendToException&)
+    {
+        return -1;
+    }
+
+    return acks;
+}
+
+
+ActionGroup::ActionGroup(uint32_t device_key, uint32_t group_key, uint32_t group_mask)
+{
+    command.device_key = device_key;
+    command.group_key = group_key;
+    command.group_mask = group_mask;
+}
+
+
+bool ActionGroup::addCamera(std::shared_ptr<Camera> camera, bool configure)
+{
+    if (!camera)
+    {
+        return false;
+    }
+
+    if (configure
+        && !camera->setActionConfiguration(
+            command.device_key, command.group_key, command.group_mask))
+    {
+        return false;
+    }
+
+    removeCamera(camera->getSerialNumber());
+    cameras.push_back(camera);
+
+    return true;
+}
+
+
+void ActionGroup::removeCamera(const std::string& serial)
+{
+    cameras.erase(std::remove_if(cameras.begin(),
+                                 cameras.end(),
+                                 [&serial](const std::shared_ptr<Camera>& cam) {
+                                     return cam->getSerialNumber() == serial;
+                                 }),
+                  cameras.end());
+}
+
+
+camera_list ActionGroup::getCameras() const
+{
+    return cameras;
+}
+
+
+int ActionGroup::fire(uint64_t action_time, bool acknowledge)
+{
+    ActionCommand cmd = command;
+    cmd.action_time = action_time;
+
+    // one packet per interface reaches all cameras connected to it
+    std::map<std::string, camera_list> interfaces;
+    for (auto& cam : cameras) { interfaces[cam->getInterfaceName()].push_back(cam); }
+
+    auto destination = [](const camera_list& list) -> std::string {
+        // loopback has no broadcast, e.g. when testing with arv-fake-gv-camera
+        if (startsWith(list.front()->getCurrentIP(), "127."))
+        {
+            return "127.0.0.1";
+        }
+        return "255.255.255.255";
+    };
+
+    if (!acknowledge)
+    {
+        bool failed = false;
+        for (auto& inf : interfaces)
+        {
+            if (sendActionCommand(*inf.second.front()->getSocket(), destination(inf.second), cmd) < 0)
+            {
+                failed = true;
+            }
+        }
+        return failed ? -1 : 0;
+    }
+
+    // waiting for acknowledges must not delay the other interfaces
+    std::atomic<int> acks = 0;
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> thread_list;
+    thread_list.reserve(interfaces.size());
+
+    for (auto& inf : interfaces)
+    {
+        auto socket = inf.second.front()->getSocket();
+        int expected = inf.second.size();
+
+        thread_list.push_back(
+            std::thread([socket, dest = destination(inf.second), expected, &cmd, &acks, &failed]() {
+                int ret = sendActionCommand(*socket, dest, cmd, expected);
+                if (ret < 0)
+                {
+                    failed = true;
+                }
+                else
+                {
+                    acks += ret;
+                }
+            }));
+    }
+
+    for (auto& thr : thread_list) { thr.join(); }
+
+    if (failed)
+    {
+        return -1;
+    }
+    return acks;
+}
+
+} /* namespace tis */
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _ACTIONCOMMAND_H_
+#define _ACTIONCOMMAND_H_
+
+#include "Camera.h"
+#include "Socket.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "../compiler_defines.h"
+
+VISIBILITY_DEFAULT
+
+namespace tis
+{
+
+/// @struct ActionCommand
+/// @brief GigE Vision action command
+///
+/// A camera executes the action when device_key and group_key match
+/// the configuration of one of its action signals and group_mask
+/// shares at least one bit with the mask of that signal.
+struct ActionCommand
+{
+    uint32_t device_key = 0;
+    uint32_t group_key = 0;
+    uint32_t group_mask = 0;
+
+    /// 0 executes the action on reception, otherwise the camera timestamp
+    /// (e.g. PTP time in ns) at which the action is executed
+    uint64_t action_time = 0;
+};
+
+/// @name sendActionCommand
+/// @param socket - socket bound to the interface the cameras are reachable on
+/// @param destination - broadcast address or address of a single camera
+/// @param command - action that shall be sent
+/// @param expected_acks - number of acknowledges to wait for; 0 requests none
+/// @return number of received acknowledges; -1 if the command could not be sent
+int sendActionCommand(Socket& socket,
+                      const std::string& destination,
+                      const ActionCommand& command,
+                      int expected_acks = 0);
+
+/// @class ActionGroup
+/// @brief Cameras that are triggered together by one action command
+///
+/// The action command is broadcast once per network interface,
+/// all cameras of the group receive the same packet.
+/// Loopback has no broadcast, cameras with a 127.x address are addressed directly.
+/// For cameras on different interfaces a scheduled action_time
+/// should be used to remove the skew between the interfaces.
+class ActionGroup
+{
+private:
+    ActionCommand command;
+
+    camera_list cameras;
+
+public:
+    ActionGroup(uint32_t device_key, uint32_t group_key, uint32_t group_mask);
+
+    /// @name addCamera
+    /// @param camera - camera that shall be added
+    /// @param configure - write the keys to action signal 0 of the camera;
+    ///                    requires control over the camera, disable when the
+    ///                    camera is configured via GenICam by the streaming application
+    /// @return true on success
+    bool addCamera(std::shared_ptr<Camera> camera, bool configure = true);
+
+    /// @name removeCamera
+    /// @param serial - serial number of the camera that shall be removed
+    void removeCamera(const std::string& serial);
+
+    /// @name getCameras
+    /// @return cameras in this group
+    camera_list getCameras() const;
+
+    /// @name fire
+    /// @param action_time - 0 for immediate execution, camera timestamp otherwise
+    /// @param acknowledge - wait for the acknowledges of the cameras
+    /// @return number of cameras that acknowledged the action; 0 if acknowledge is false;
+    ///         -1 if the command could not be sent on one of the interfaces
+    int fire(uint64_t action_time = 0, bool acknowledge = false);
+};
+
+} /* namespace tis */
+
+VISIBILITY_POP
+
+#endif /* _ACTIONCOMMAND_H_ */
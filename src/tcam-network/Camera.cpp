@@ -585,6 +585,58 @@ bool Camera::setHeartbeatTimeout(uint32_t timeout)
 }
 
 
+bool Camera::supportsActionCommands()
+{
+    uint32_t data = 0;
+    try
+    {
+        if (!this->sendReadRegister(Register::GVCP_SUPPORTED_COMMANDS_REGISTER, &data))
+        {
+            return false;
+        }
+    }
+    catch (const std::exception& exc)
+    {
+        std::cerr << exc.what() << std::endl;
+        return false;
+    }
+
+    return data & Register::GVCP_SUPPORTS_ACTION;
+}
+
+
+bool Camera::setActionConfiguration(uint32_t device_key,
+                                    uint32_t group_key,
+                                    uint32_t group_mask,
+                                    unsigned int signal)
+{
+    if (!isControlled)
+    {
+        if (!this->getControl())
+        {
+            return false;
+        }
+    }
+
+    const uint32_t offset = signal * Register::ACTION_SIGNAL_STRIDE;
+
+    bool retv = false;
+    try
+    {
+        retv = this->sendWriteRegister(Register::ACTION_DEVICE_KEY_REGISTER, device_key)
+               && this->sendWriteRegister(Register::ACTION_GROUP_KEY_REGISTER + offset, group_key)
+               && this->sendWriteRegister(Register::ACTION_GROUP_MASK_REGISTER + offset,
+                                          group_mask);
+    }
+    catch (const std::exception& exc)
+    {
+        std::cerr << exc.what() << std::endl;
+    }
+
+    return retv;
+}
+
+
 bool Camera::getControl()
 {
     bool retv = false;
@@ -221,6 +221,24 @@ public:
     /// @return true if hearbeat could be set
     bool setHeartbeatTimeout(uint32_t timeout);
 
+    /// @name supportsActionCommands
+    /// @return true if the camera reacts to ACTION_CMD packets
+    bool supportsActionCommands();
+
+    /// @name setActionConfiguration
+    /// @param device_key - key all action commands for this camera have to contain
+    /// @param group_key - group the action signal belongs to
+    /// @param group_mask - bits of the group mask the action signal reacts to
+    /// @param signal - index of the action signal that shall be configured
+    /// @return true on success
+    /// @brief Requires control over the camera.
+    /// The camera has to be configured to use the action signal as trigger source
+    /// (e.g. TriggerSource=Action0) via GenICam.
+    bool setActionConfiguration(uint32_t device_key,
+                                uint32_t group_key,
+                                uint32_t group_mask,
+                                unsigned int signal = 0);
+
     /// @name sendReadMemory
     /// @param address - address that shall be read
     /// @param value - pointer to container that shall be filled
@@ -46,6 +46,8 @@ static const unsigned int EVENT_CMD = 0xC0;
 static const unsigned int EVENT_ACK = 0xC1;
 static const unsigned int EVENTDATA_CMD = 0xC2;
 static const unsigned int EVENTDATA_ACK = 0xC3;
+static const unsigned int ACTION_CMD = 0x100;
+static const unsigned int ACTION_ACK = 0x101;
 static const unsigned int INVALID_COMMAND = 0xFF;
 
 } /* namespace Commands */
@@ -55,6 +57,8 @@ namespace Flags
 
 static const unsigned int NEEDACK = 0x1;
 static const unsigned int RETRYCMD = 0x2;
+// ACTION_CMD contains action_time
+static const unsigned int SCHEDULED_ACTION = 0x80;
 
 } /* namespace Flags */
 
@@ -120,11 +124,17 @@ static const unsigned int NUM_STREAM_CHANNELS_REGISTER = 0x0904;
 static const unsigned int GVCP_SUPPORTED_COMMANDS_REGISTER = 0x0934;
 static const unsigned int GVCP_SUPPORTS_WRITEMEM = 0x00000002;
 static const unsigned int GVCP_SUPPORTS_CONCATENATION = 0x00000001;
+static const unsigned int GVCP_SUPPORTS_ACTION = 0x00000040;
 static const unsigned int HEARTBEAT_TIMEOUT_REGISTER = 0x0938;
 static const unsigned int CONTROLCHANNEL_PRIVELEGE_REGISTER = 0x0A00;
 static const unsigned int CONTROLCHAN_PRIV_MONITOR = 0x00000004;
 static const unsigned int CONTROLCHAN_PRIV_CONTROL = 0x00000002;
 static const unsigned int CONTROLCHAN_PRIV_EXCLUSIVE = 0x00000001;
+static const unsigned int ACTION_DEVICE_KEY_REGISTER = 0x090C;
+// action signal n uses ACTION_GROUP_KEY_REGISTER + n * ACTION_SIGNAL_STRIDE
+static const unsigned int ACTION_GROUP_KEY_REGISTER = 0x9800;
+static const unsigned int ACTION_GROUP_MASK_REGISTER = 0x9804;
+static const unsigned int ACTION_SIGNAL_STRIDE = 0x10;
 
 } /* namespace Register */
 
@@ -238,6 +248,19 @@ typedef struct
     uint32_t StaticGateway;
 } CMD_FORCEIP;
 
+typedef struct
+{
+    COMMAND_HEADER header;
+
+    uint32_t device_key;
+    uint32_t group_key;
+    uint32_t group_mask;
+
+    // only sent with Flags::SCHEDULED_ACTION
+    uint32_t action_time_high;
+    uint32_t action_time_low;
+} CMD_ACTION;
+
 // acknowledge structures
 
 typedef struct ACK_DISCOVERY
@@ -314,6 +337,12 @@ typedef struct
 
 } ACK_WRITEMEM;
 
+typedef struct
+{
+    ACK_HEADER header;
+
+} ACK_ACTION;
+
 } /* namespace Packet */
 
 #endif /* _GIGEVISION_H_ */
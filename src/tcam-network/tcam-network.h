@@ -3,6 +3,7 @@
 #ifndef TCAM_NETWORK_H
 #define TCAM_NETWORK_H
 
+#include "ActionCommand.h"
 #include "Camera.h"
 #include "NetworkInterface.h"
 #include "utils.h"
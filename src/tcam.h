@@ -25,8 +25,10 @@
 #include "CaptureDevice.h"
 #include "DeviceInfo.h"
 #include "BufferPool.h"
+#include "HugepageAllocator.h"
 #include "ImageBuffer.h"
 #include "ImageSink.h"
+#include "StreamMetrics.h"
 #include "base_types.h"
 #include "public_utils.h"
 #include "version.h"
@@ -29,6 +29,7 @@
 #include <pthread.h>
 #include <signal.h> // kill
 #include <sys/ioctl.h>
+#include <time.h>
 
 using namespace tcam;
 
@@ -290,3 +291,11 @@ int set_thread_name(const std::string& name, pthread_t thrd /*= pthread_self()*/
     assert(name.size() <= 16);
     return set_thread_name(name.c_str(), thrd);
 }
+
+
+uint64_t tcam::get_monotonic_time_ns() noexcept
+{
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
@@ -116,6 +116,15 @@ std::optional<int> get_environment_variable_int(const std::string& name);
 int set_thread_name(const char* name, pthread_t thrd = pthread_self());
 int set_thread_name(const std::string& name, pthread_t thrd = pthread_self());
 
+/**
+ * @brief current CLOCK_MONOTONIC time
+ *
+ * Same clock gst_util_get_timestamp uses, values can be compared
+ * with timestamps taken in the gstreamer elements.
+ * @return nanoseconds
+ */
+uint64_t get_monotonic_time_ns() noexcept;
+
 } /* namespace tcam */
 
 VISIBILITY_POP
@@ -21,8 +21,10 @@
 #include "../logging.h"
 #include "../utils.h"
 
+#include <fcntl.h> /* O_RDWR O_CLOEXEC */
 #include <linux/videodev2.h>
 #include <sys/mman.h> /* mmap PROT_READ*/
+#include <unistd.h> /* close */
 
 using namespace tcam;
 
@@ -76,6 +78,23 @@ void tcam::V4L2Allocator::query_supported_memory_types()
     if (reqbufs(fd_, req, "mmap"))
     {
         memory_types_.push_back(TCAM_MEMORY_TYPE_MMAP);
+
+        // dma export works on mmap buffers
+        // check if the driver is able to export them
+        struct v4l2_exportbuffer expbuf = {};
+        expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = 0;
+
+        if (tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) == 0)
+        {
+            memory_types_.push_back(TCAM_MEMORY_TYPE_DMA);
+            close(expbuf.fd);
+        }
+        else
+        {
+            libtcam::logger()->info("Device does not support dma export");
+        }
+
         req.count = 0;
         tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
     }
@@ -85,9 +104,7 @@ void tcam::V4L2Allocator::query_supported_memory_types()
 
     if (reqbufs(fd_, req, "DMA"))
     {
-        //memory_types_.push_back(TCAM_MEMORY_TYPE_DMA);
-        //memory_types_.push_back(TCAM_MEMORY_TYPE_DMA_IMPORT);
-        // TODO: implement dma support
+        memory_types_.push_back(TCAM_MEMORY_TYPE_DMA_IMPORT);
         req.count = 0;
         tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
     }
@@ -136,10 +153,9 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     req.memory = V4L2_MEMORY_MMAP;
 
-    if (-1 == tcam_xioctl(fd_, VIDIOC_REQBUFS, &req))
+    if (!reqbufs(fd_, req, "mmap"))
     {
-            libtcam::logger()->error("VIDIOC_REQBUFS {}", strerror(errno));
-
+        return {};
     }
 
     if (req.count != buffer_count)
@@ -148,6 +164,19 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
         return {};
     }
 
+    // the position in the returned vector has to match the v4l2 buffer index
+    // like allocate_dma, give up completely instead of skipping a buffer
+    auto abort = [this, &buffers, &req]()
+    {
+        // unmaps everything mapped so far
+        buffers.clear();
+
+        req.count = 0;
+        tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
+
+        return std::vector<std::shared_ptr<Memory>> {};
+    };
+
     for (unsigned int n_buffers = 0; n_buffers < buffer_count; ++n_buffers)
     {
         struct v4l2_buffer buf = {};
@@ -156,6 +185,12 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
         buf.memory = V4L2_MEMORY_MMAP;
         buf.index = n_buffers;
 
+        if (tcam_xioctl(fd_, VIDIOC_QUERYBUF, &buf) == -1)
+        {
+            libtcam::logger()->error("VIDIOC_QUERYBUF failed for buffer {}: {}", n_buffers, strerror(errno));
+            return abort();
+        }
+
         auto ptr =
             (unsigned char*)mmap(NULL,
                                  buffer_size,
@@ -167,7 +202,7 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
         if (ptr == MAP_FAILED)
         {
             libtcam::logger()->error("MMAP failed for buffer {}. Aborting. {}", n_buffers, strerror(errno));
-            continue;
+            return abort();
         }
 
         libtcam::logger()->trace("New mmap buffer {} {}", n_buffers, fmt::ptr(ptr));
@@ -194,64 +229,92 @@ std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_mmap(size_t length,
 }
 
 
-std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_dma(size_t /*length*/,
-                                                                 int fd,
+std::vector<std::shared_ptr<Memory>> V4L2Allocator::allocate_dma(size_t length,
                                                                  size_t buffer_count)
 {
-    struct v4l2_requestbuffers rqbufs = {};
-    rqbufs.count = buffer_count;
-    rqbufs.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    rqbufs.memory = V4L2_MEMORY_DMABUF;
-
-    if (tcam_xioctl(fd_, VIDIOC_REQBUFS, &rqbufs) == -1)
+    // dma export
+    // the driver allocates mmap buffers that are then exported as dmabuf.
+    // the mapping is kept so that software properties, etc. still have cpu access
+    if (buffer_count < 2)
     {
-        if (EINVAL == errno)
-        {
-            fprintf(stderr,
-                    "does not support "
-                    "dma\n");
-            exit(EXIT_FAILURE);
-        }
-        else
-        {
-            libtcam::logger()->error("VIDIOC_REQBUFS");
-        }
+        libtcam::logger()->error("Insufficient buffer memory for dma");
+        return {};
     }
 
-    struct v4l2_exportbuffer expbuf;
+    struct v4l2_requestbuffers req = {};
+
+    req.count = buffer_count;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+
+    if (!reqbufs(fd_, req, "dma export"))
+    {
+        return {};
+    }
 
-    memset(&expbuf, 0, sizeof(expbuf));
-    expbuf.type = rqbufs.type;
-    expbuf.index = 0;// index;
-    if (tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) == -1)
+    if (req.count != buffer_count)
     {
-        perror("VIDIOC_EXPBUF");
-        //return -1;
+        libtcam::logger()->error("Can only allocate {} dma buffer. Aborting.", req.count);
+        return {};
     }
 
-    //int dmafd = expbuf.fd;
+    std::vector<std::shared_ptr<Memory>> buffers;
+    buffers.reserve(buffer_count);
 
-    // this is queueing
+    // the position in the returned vector has to match the v4l2 buffer index
+    // a missing buffer would shift all following ones, so give up completely
+    auto abort = [this, &buffers, &req]()
+    {
+        // unmaps and closes everything exported so far
+        buffers.clear();
+
+        req.count = 0;
+        tcam_xioctl(fd_, VIDIOC_REQBUFS, &req);
+
+        return std::vector<std::shared_ptr<Memory>> {};
+    };
 
     for (unsigned int i = 0; i < buffer_count; ++i)
     {
         struct v4l2_buffer buf = {};
 
-        buf.index = i;
         buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_DMABUF;
-        //buf.m.fd = buffer[i].dbuf_fd;
-        buf.m.fd = fd;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
 
-        if (tcam_xioctl(fd_, VIDIOC_QBUF, &buf) == -1)
+        if (tcam_xioctl(fd_, VIDIOC_QUERYBUF, &buf) == -1)
         {
-            // TODO: error handling
+            libtcam::logger()->error("VIDIOC_QUERYBUF failed for buffer {}: {}", i, strerror(errno));
+            return abort();
         }
-    }
 
+        struct v4l2_exportbuffer expbuf = {};
 
+        expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = i;
+        expbuf.flags = O_RDWR | O_CLOEXEC;
 
-    return {};
+        if (tcam_xioctl(fd_, VIDIOC_EXPBUF, &expbuf) == -1)
+        {
+            libtcam::logger()->error("VIDIOC_EXPBUF failed for buffer {}: {}", i, strerror(errno));
+            return abort();
+        }
+
+        auto ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, buf.m.offset);
+
+        if (ptr == MAP_FAILED)
+        {
+            libtcam::logger()->error("MMAP failed for dma buffer {}. {}", i, strerror(errno));
+            close(expbuf.fd);
+            return abort();
+        }
+
+        libtcam::logger()->trace("New dma buffer {} fd: {} {}", i, expbuf.fd, fmt::ptr(ptr));
+        buffers.push_back(std::make_shared<Memory>(
+            shared_from_this(), TCAM_MEMORY_TYPE_DMA, length, ptr, expbuf.fd));
+    }
+
+    return buffers;
 }
 
 
@@ -285,8 +348,14 @@ void tcam::V4L2Allocator::free_mmap(void* ptr, size_t length)
 }
 
 
-void tcam::V4L2Allocator::free_dma(std::vector<std::shared_ptr<ImageBuffer>> /*buffer_collection*/)
+void tcam::V4L2Allocator::free_dma(void* ptr, size_t length, int fd)
 {
+    free_mmap(ptr, length);
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
 }
 
 
@@ -300,7 +369,7 @@ void* tcam::V4L2Allocator::allocate(TCAM_MEMORY_TYPE /*type*/,
 }
 
 
-void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length, int /*fd*/)
+void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length, int fd)
 {
     switch(type)
     {
@@ -316,12 +385,13 @@ void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length,
         }
         case TCAM_MEMORY_TYPE_DMA:
         {
-            //free_dma(std::vector<std::shared_ptr<ImageBuffer>>)
+            free_dma(ptr, length, fd);
             break;
         }
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            libtcam::logger()->error("Explicitely not supported");
+            // imported memory is owned by the exporter
+            // tcam::Memory marks it as external, nothing to free
             break;
         }
     }
@@ -329,7 +399,7 @@ void tcam::V4L2Allocator::free(TCAM_MEMORY_TYPE type, void* ptr, size_t length,
 
 
 std::vector<std::shared_ptr<Memory>> tcam::V4L2Allocator::allocate(
-    size_t buffer_count, TCAM_MEMORY_TYPE type, size_t length, int fd)
+    size_t buffer_count, TCAM_MEMORY_TYPE type, size_t length, int /*fd*/)
 {
 
     switch (type)
@@ -344,7 +414,7 @@ std::vector<std::shared_ptr<Memory>> tcam::V4L2Allocator::allocate(
         }
         case TCAM_MEMORY_TYPE_DMA:
         {
-            return allocate_dma(length, buffer_count, fd);
+            return allocate_dma(length, buffer_count);
         }
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
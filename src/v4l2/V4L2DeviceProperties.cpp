@@ -111,12 +111,15 @@ void tcam::V4l2Device::generate_properties(const std::vector<v4l2_queryctrl>& qc
 
         if (prop_ptr)
         {
+            p_property_backend->enable_cache(qctrl);
+
             if (map_info.mapping_type_ == mapping_type::internal)
             {
                 m_internal_properties.push_back(prop_ptr);
             }
             else
             {
+                m_control_names[qctrl.id] = std::string(prop_ptr->get_name());
                 m_properties.push_back( prop_ptr );
             }
         }
@@ -140,6 +143,16 @@ void tcam::V4l2Device::update_dependency_information()
         if (dependent_names.empty())
             continue;
 
+        // e.g. the device changes ExposureTime while ExposureAuto is active
+        for (const auto& [v4l2_id, name] : m_control_names)
+        {
+            if (std::find(dependent_names.begin(), dependent_names.end(), name)
+                != dependent_names.end())
+            {
+                p_property_backend->disable_cache(v4l2_id);
+            }
+        }
+
         std::vector<std::weak_ptr<tcam::property::PropertyLock>> dependencies_to_include;
         for (const auto& name : dependent_names)
         {
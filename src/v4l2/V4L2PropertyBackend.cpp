@@ -19,18 +19,105 @@
 #include "../logging.h"
 #include "../utils.h"
 
+#include <algorithm>
 #include <linux/videodev2.h>
 
 
 tcam::v4l2::V4L2PropertyBackend::V4L2PropertyBackend(int fd) : p_fd(fd) {}
 
 
-static outcome::result<int64_t> v4l2_control_ioctl(int fd, unsigned int request, v4l2_control* ctrl)
+static std::error_code errno_to_status(int err)
 {
-    auto ret = tcam::tcam_xioctl(fd, request, ctrl);
+    switch (err)
+    {
+        case EBUSY:
+        {
+            return tcam::status::DeviceAccessBlocked;
+        }
+        case EINTR:
+        {
+            return tcam::status::UndefinedError;
+        }
+        case ERANGE:
+        {
+            return tcam::status::PropertyValueOutOfBounds;
+        }
+        case ETIMEDOUT:
+        {
+            return tcam::status::Timeout;
+        }
+    }
+    return tcam::status::UndefinedError;
+}
+
+
+int tcam::v4l2::V4L2PropertyBackend::xioctl(unsigned int request, void* arg)
+{
+    return tcam::tcam_xioctl(p_fd, request, arg);
+}
+
+
+static void set_ext_value(v4l2_ext_control& ctrl, int64_t value, bool is_int64)
+{
+    if (is_int64)
+    {
+        ctrl.value64 = value;
+    }
+    else
+    {
+        ctrl.value = value;
+    }
+}
+
+
+static int64_t get_ext_value(const v4l2_ext_control& ctrl, bool is_int64)
+{
+    return is_int64 ? ctrl.value64 : ctrl.value;
+}
+
+
+bool tcam::v4l2::V4L2PropertyBackend::is_int64(uint32_t v4l2_id)
+{
+    std::scoped_lock lck(p_mtx);
+    return p_int64_controls.count(v4l2_id) > 0;
+}
+
+
+outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::control_ioctl(unsigned int request,
+                                                                        uint32_t v4l2_id,
+                                                                        int64_t value)
+{
+    int ret = 0;
+    int64_t result = 0;
+
+    if (is_int64(v4l2_id))
+    {
+        // v4l2_control::value is 32 bit, VIDIOC_S_CTRL rejects these controls
+        v4l2_ext_control ctrl = {};
+        ctrl.id = v4l2_id;
+        ctrl.value64 = value;
+
+        v4l2_ext_controls ext = {};
+        ext.which = V4L2_CTRL_WHICH_CUR_VAL;
+        ext.count = 1;
+        ext.controls = &ctrl;
+
+        ret = xioctl(request == VIDIOC_S_CTRL ? VIDIOC_S_EXT_CTRLS : VIDIOC_G_EXT_CTRLS, &ext);
+        result = ctrl.value64;
+    }
+    else
+    {
+        v4l2_control ctrl = {};
+        ctrl.id = v4l2_id;
+        ctrl.value = value;
+
+        ret = xioctl(request, &ctrl);
+        result = ctrl.value;
+    }
+
     if (ret >= 0)
     {
-        return ctrl->value;
+        return result;
     }
 
     std::string_view action = "GET";
@@ -41,46 +128,375 @@ static outcome::result<int64_t> v4l2_control_ioctl(int fd, unsigned int request,
 
     libtcam::logger()->error(
         "ioctl returned {} reported error while {} ({}): {}", ret, action, errno, strerror(errno));
-    switch (errno)
+    return errno_to_status(errno);
+}
+
+
+outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::write_control(int v4l2_id,
+                                                                            int64_t new_value)
+{
+    const bool is_64 = is_int64(v4l2_id);
     {
-        case EBUSY:
+        std::scoped_lock lck(p_mtx);
+
+        auto b = p_batches.find(std::this_thread::get_id());
+        if (b != p_batches.end())
         {
-            return tcam::status::DeviceAccessBlocked;
+            auto& controls = b->second.controls;
+            auto iter = std::find_if(controls.begin(),
+                                     controls.end(),
+                                     [v4l2_id](const auto& c) { return c.id == (__u32)v4l2_id; });
+            if (iter != controls.end())
+            {
+                set_ext_value(*iter, new_value, is_64);
+            }
+            else
+            {
+                v4l2_ext_control ctrl = {};
+                ctrl.id = v4l2_id;
+                set_ext_value(ctrl, new_value, is_64);
+                controls.push_back(ctrl);
+            }
+            return new_value;
         }
-        case EINTR:
+    }
+
+    auto ret = control_ioctl(VIDIOC_S_CTRL, v4l2_id, new_value);
+    if (ret)
+    {
+        // the driver reports the value it actually uses
+        update_cache(v4l2_id, ret.value());
+    }
+    else
+    {
+        invalidate_cache(v4l2_id);
+    }
+    // a failed write may have been applied partially
+    invalidate_dependent_cache(v4l2_id);
+    return ret;
+}
+
+
+outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::read_control(int v4l2_id)
+{
+    const bool is_64 = is_int64(v4l2_id);
+    {
+        std::scoped_lock lck(p_mtx);
+
+        // the device does not know about collected values yet
+        auto b = p_batches.find(std::this_thread::get_id());
+        if (b != p_batches.end())
         {
-            return tcam::status::UndefinedError;
+            for (const auto& c : b->second.controls)
+            {
+                if (c.id == (__u32)v4l2_id)
+                {
+                    return get_ext_value(c, is_64);
+                }
+            }
         }
-        case ERANGE:
+    }
+
+    if (!p_events_watched)
+    {
+        // nobody waits on the fd, pick up changes now
+        // this only asks the kernel, the device is not involved
+        handle_events();
+    }
+
+    {
+        std::scoped_lock lck(p_mtx);
+
+        auto iter = p_cache.find(v4l2_id);
+        if (iter != p_cache.end() && iter->second.valid && !iter->second.inactive)
         {
-            return tcam::status::PropertyValueOutOfBounds;
+            return iter->second.value;
         }
-        case ETIMEDOUT:
+    }
+
+    auto ret = control_ioctl(VIDIOC_G_CTRL, v4l2_id);
+    if (ret)
+    {
+        update_cache(v4l2_id, ret.value());
+    }
+    return ret;
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::enable_cache(const v4l2_queryctrl& qctrl)
+{
+    if (qctrl.flags & V4L2_CTRL_FLAG_UPDATE)
+    {
+        std::scoped_lock lck(p_mtx);
+        p_update_controls.insert(qctrl.id);
+    }
+    if (qctrl.type == V4L2_CTRL_TYPE_INTEGER64)
+    {
+        std::scoped_lock lck(p_mtx);
+        p_int64_controls.insert(qctrl.id);
+    }
+
+    // uvcvideo marks controls the device updates on its own (auto update capability)
+    // as volatile, those have to be read every time
+    if (qctrl.type == V4L2_CTRL_TYPE_BUTTON
+        || (qctrl.flags & (V4L2_CTRL_FLAG_VOLATILE | V4L2_CTRL_FLAG_WRITE_ONLY)))
+    {
+        return;
+    }
+
+    struct v4l2_event_subscription sub = {};
+    sub.type = V4L2_EVENT_CTRL;
+    sub.id = qctrl.id;
+
+    if (xioctl(VIDIOC_SUBSCRIBE_EVENT, &sub) == -1)
+    {
+        libtcam::logger()->trace("Control {:#x} does not send events. Not caching it.", qctrl.id);
+        return;
+    }
+
+    cache_entry entry = {};
+    entry.inactive = qctrl.flags & V4L2_CTRL_FLAG_INACTIVE;
+
+    std::scoped_lock lck(p_mtx);
+    p_cache.emplace(qctrl.id, entry);
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::disable_cache(uint32_t v4l2_id)
+{
+    {
+        std::scoped_lock lck(p_mtx);
+        if (p_cache.erase(v4l2_id) == 0)
         {
-            return tcam::status::Timeout;
+            return;
         }
     }
-    return tcam::status::UndefinedError;
+
+    struct v4l2_event_subscription sub = {};
+    sub.type = V4L2_EVENT_CTRL;
+    sub.id = v4l2_id;
+
+    xioctl(VIDIOC_UNSUBSCRIBE_EVENT, &sub);
+
+    libtcam::logger()->trace("Control {:#x} is changed by the device. Not caching it.", v4l2_id);
 }
 
 
-outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::write_control(int v4l2_id,
-                                                                            int new_value)
+void tcam::v4l2::V4L2PropertyBackend::set_control_changed_callback(control_changed_callback cb)
+{
+    std::scoped_lock lck(p_mtx);
+    p_changed_cb = std::move(cb);
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::handle_events()
+{
+    struct v4l2_event ev = {};
+
+    // the fd is non-blocking, DQEVENT fails with ENOENT when nothing is pending
+    while (xioctl(VIDIOC_DQEVENT, &ev) == 0)
+    {
+        if (ev.type != V4L2_EVENT_CTRL)
+        {
+            continue;
+        }
+
+        if (ev.u.ctrl.changes & V4L2_EVENT_CTRL_CH_FLAGS)
+        {
+            // e.g. the auto control of the cluster was switched
+            std::scoped_lock lck(p_mtx);
+
+            auto iter = p_cache.find(ev.id);
+            if (iter != p_cache.end())
+            {
+                iter->second.inactive = ev.u.ctrl.flags & V4L2_CTRL_FLAG_INACTIVE;
+                iter->second.valid = false;
+            }
+        }
+
+        if (!(ev.u.ctrl.changes & V4L2_EVENT_CTRL_CH_VALUE))
+        {
+            continue;
+        }
+
+        const int64_t value =
+            ev.u.ctrl.type == V4L2_CTRL_TYPE_INTEGER64 ? ev.u.ctrl.value64 : ev.u.ctrl.value;
+
+        control_changed_callback cb;
+        {
+            std::scoped_lock lck(p_mtx);
+
+            auto iter = p_cache.find(ev.id);
+            if (iter == p_cache.end())
+            {
+                continue;
+            }
+            if (iter->second.valid && iter->second.value == value)
+            {
+                continue;
+            }
+            iter->second.valid = true;
+            iter->second.value = value;
+            cb = p_changed_cb;
+        }
+
+        if (cb)
+        {
+            cb(ev.id, value);
+        }
+    }
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::update_cache(uint32_t v4l2_id, int64_t value)
 {
-    struct v4l2_control ctrl = {};
-    ctrl.id = v4l2_id;
-    ctrl.value = new_value;
+    std::scoped_lock lck(p_mtx);
 
-    return v4l2_control_ioctl(p_fd, VIDIOC_S_CTRL, &ctrl);
+    auto iter = p_cache.find(v4l2_id);
+    if (iter != p_cache.end())
+    {
+        iter->second.valid = true;
+        iter->second.value = value;
+    }
 }
 
 
-outcome::result<int64_t> tcam::v4l2::V4L2PropertyBackend::read_control(int v4l2_id)
+void tcam::v4l2::V4L2PropertyBackend::invalidate_cache(uint32_t v4l2_id)
 {
-    struct v4l2_control ctrl = {};
-    ctrl.id = v4l2_id;
+    std::scoped_lock lck(p_mtx);
 
-    return v4l2_control_ioctl(p_fd, VIDIOC_G_CTRL, &ctrl);
+    auto iter = p_cache.find(v4l2_id);
+    if (iter != p_cache.end())
+    {
+        iter->second.valid = false;
+    }
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::invalidate_dependent_cache(uint32_t v4l2_id)
+{
+    std::scoped_lock lck(p_mtx);
+
+    if (p_update_controls.count(v4l2_id) == 0)
+    {
+        return;
+    }
+
+    for (auto& [id, entry] : p_cache)
+    {
+        if (id != v4l2_id)
+        {
+            entry.valid = false;
+        }
+    }
+}
+
+
+void tcam::v4l2::V4L2PropertyBackend::begin_batch()
+{
+    std::scoped_lock lck(p_mtx);
+    p_batches[std::this_thread::get_id()].depth++;
+}
+
+
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::commit_batch(
+    std::vector<batch_failure>* failed)
+{
+    std::vector<v4l2_ext_control> controls;
+    {
+        std::scoped_lock lck(p_mtx);
+
+        auto b = p_batches.find(std::this_thread::get_id());
+        if (b == p_batches.end())
+        {
+            return outcome::success();
+        }
+        if (--b->second.depth > 0)
+        {
+            return outcome::success();
+        }
+        controls.swap(b->second.controls);
+        p_batches.erase(b);
+    }
+
+    if (controls.empty())
+    {
+        return outcome::success();
+    }
+    return write_batch(controls, failed);
+}
+
+
+tcam::v4l2::V4L2PropertyBackend::batch_guard::~batch_guard()
+{
+    if (auto res = commit(); !res)
+    {
+        libtcam::logger()->warn("Unable to write collected controls: {}", res.error().message());
+    }
+}
+
+
+outcome::result<void> tcam::v4l2::V4L2PropertyBackend::write_batch(
+    std::vector<v4l2_ext_control>& controls,
+    std::vector<batch_failure>* failed)
+{
+    struct v4l2_ext_controls ext = {};
+    // controls of different classes may be mixed
+    ext.which = V4L2_CTRL_WHICH_CUR_VAL;
+    ext.count = controls.size();
+    ext.controls = controls.data();
+    // drivers set this to the failing control, keep it out of range for ioctl that fail before
+    ext.error_idx = ext.count;
+
+    if (xioctl(VIDIOC_S_EXT_CTRLS, &ext) >= 0)
+    {
+        libtcam::logger()->debug("Wrote {} controls with one VIDIOC_S_EXT_CTRLS", controls.size());
+        for (const auto& c : controls) { update_cache(c.id, get_ext_value(c, is_int64(c.id))); }
+        for (const auto& c : controls) { invalidate_dependent_cache(c.id); }
+        return outcome::success();
+    }
+
+    // older kernels/drivers may not accept mixed classes or ext controls at all
+    // the driver may have applied a part, writing everything again does no harm
+    // and tells which of the controls the device rejects
+    if (ext.error_idx < ext.count)
+    {
+        libtcam::logger()->debug(
+            "VIDIOC_S_EXT_CTRLS failed for control {:#x} ({}): {}. Writing controls separately.",
+            uint32_t(controls.at(ext.error_idx).id),
+            errno,
+            strerror(errno));
+    }
+    else
+    {
+        libtcam::logger()->debug("VIDIOC_S_EXT_CTRLS failed ({}): {}. Writing controls separately.",
+                                 errno,
+                                 strerror(errno));
+    }
+
+    outcome::result<void> ret = outcome::success();
+    for (const auto& c : controls)
+    {
+        auto res = control_ioctl(VIDIOC_S_CTRL, c.id, get_ext_value(c, is_int64(c.id)));
+        if (res)
+        {
+            update_cache(c.id, res.value());
+        }
+        else
+        {
+            invalidate_cache(c.id);
+            if (failed)
+            {
+                failed->push_back({ c.id, res.error() });
+            }
+            if (ret)
+            {
+                ret = res.error();
+            }
+        }
+    }
+    for (const auto& c : controls) { invalidate_dependent_cache(c.id); }
+    return ret;
 }
 
 
@@ -93,7 +509,7 @@ auto tcam::v4l2::V4L2PropertyBackend::get_menu_entries(int v4l2_id, int max)
         v4l2_querymenu qmenu = {};
         qmenu.id = v4l2_id;
         qmenu.index = i;
-        if (tcam_xioctl(p_fd, VIDIOC_QUERYMENU, &qmenu))
+        if (xioctl(VIDIOC_QUERYMENU, &qmenu))
         {
             continue;
         }
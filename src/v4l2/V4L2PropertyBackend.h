@@ -19,6 +19,13 @@
 #include "../error.h"
 #include "v4l2_genicam_conversion.h"
 
+#include <atomic>
+#include <functional>
+#include <linux/videodev2.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 
 namespace tcam::v4l2
@@ -28,14 +35,149 @@ class V4L2PropertyBackend
 {
 public:
     explicit V4L2PropertyBackend(int fd);
+    virtual ~V4L2PropertyBackend() = default;
 
-    outcome::result<int64_t> write_control(int v4l2_id, int new_value);
+    outcome::result<int64_t> write_control(int v4l2_id, int64_t new_value);
 
     outcome::result<int64_t> read_control(int v4l2_id);
 
     std::vector<tcam::v4l2::menu_entry> get_menu_entries(int v4l2_id, int max);
+
+    /**
+     * Writes until commit_batch are only collected and read_control
+     * returns the collected values.
+     * commit_batch sends all of them with one VIDIOC_S_EXT_CTRLS.
+     * Batches nest, only the outermost commit_batch writes.
+     * A batch only collects the writes of the thread that began it.
+     * Controls the device rejected are added to failed.
+     * Use batch_guard, so that an early return does not leave the batch open.
+     */
+    struct batch_failure
+    {
+        uint32_t v4l2_id;
+        std::error_code error;
+    };
+
+    void begin_batch();
+    outcome::result<void> commit_batch(std::vector<batch_failure>* failed = nullptr);
+
+    /**
+     * Keeps a batch open for its lifetime.
+     * A batch that was not committed is committed when the guard is destroyed,
+     * its errors are only logged.
+     */
+    class batch_guard
+    {
+    public:
+        explicit batch_guard(V4L2PropertyBackend& backend) : backend_(backend)
+        {
+            backend_.begin_batch();
+        }
+        ~batch_guard();
+
+        batch_guard(const batch_guard&) = delete;
+        batch_guard& operator=(const batch_guard&) = delete;
+
+        outcome::result<void> commit(std::vector<batch_failure>* failed = nullptr)
+        {
+            if (committed_)
+            {
+                return outcome::success();
+            }
+            committed_ = true;
+            return backend_.commit_batch(failed);
+        }
+
+    private:
+        V4L2PropertyBackend& backend_;
+        bool committed_ = false;
+    };
+
+    /**
+     * Keep the value of the control in memory.
+     * The value is kept coherent through V4L2_EVENT_CTRL.
+     * Volatile controls and controls that do not send events are always read from the device.
+     * So are controls the driver marks inactive, e.g. slaves of an active auto control.
+     * Writing a control with V4L2_CTRL_FLAG_UPDATE invalidates all cached values.
+     * V4L2_CTRL_TYPE_INTEGER64 controls are remembered, their values need value64.
+     */
+    void enable_cache(const v4l2_queryctrl& qctrl);
+
+    /**
+     * The device changes the control on its own,
+     * e.g. ExposureTime while ExposureAuto is active.
+     * It is always read from the device, even if it sends events.
+     */
+    void disable_cache(uint32_t v4l2_id);
+
+    using control_changed_callback = std::function<void(uint32_t v4l2_id, int64_t new_value)>;
+
+    // called for value changes the device reports, not for own writes
+    void set_control_changed_callback(control_changed_callback cb);
+
+    /**
+     * Dequeue all pending control events.
+     * Has to be called when the fd signals EPOLLPRI.
+     */
+    void handle_events();
+
+    // true while the stream thread calls handle_events
+    // otherwise read_control looks for events itself
+    void set_events_watched(bool watched)
+    {
+        p_events_watched = watched;
+    }
+
+protected:
+    // every ioctl of the backend goes through here
+    virtual int xioctl(unsigned int request, void* arg);
+
 private:
+    // VIDIOC_G_CTRL or VIDIOC_S_CTRL, through the ext ioctls for 64 bit controls
+    outcome::result<int64_t> control_ioctl(unsigned int request, uint32_t v4l2_id, int64_t value = 0);
+
+    // takes p_mtx
+    bool is_int64(uint32_t v4l2_id);
+
+    outcome::result<void> write_batch(std::vector<v4l2_ext_control>& controls,
+                                      std::vector<batch_failure>* failed);
+
+    void update_cache(uint32_t v4l2_id, int64_t value);
+    void invalidate_cache(uint32_t v4l2_id);
+    // after writing v4l2_id, other controls may have changed
+    void invalidate_dependent_cache(uint32_t v4l2_id);
+
     int p_fd = 0;
+
+    struct batch
+    {
+        int depth = 0;
+        // in the order they were written, one entry per control
+        std::vector<v4l2_ext_control> controls;
+    };
+
+    // guards p_batches, p_cache, p_update_controls, p_int64_controls and p_changed_cb
+    std::mutex p_mtx;
+    std::map<std::thread::id, batch> p_batches;
+
+    struct cache_entry
+    {
+        bool valid = false;
+        int64_t value = 0;
+        // V4L2_CTRL_FLAG_INACTIVE, the device controls the value
+        bool inactive = false;
+    };
+
+    // only contains controls that send events
+    std::map<uint32_t, cache_entry> p_cache;
+    // controls with V4L2_CTRL_FLAG_UPDATE
+    std::set<uint32_t> p_update_controls;
+    // V4L2_CTRL_TYPE_INTEGER64 controls, they do not fit v4l2_control::value
+    std::set<uint32_t> p_int64_controls;
+
+    control_changed_callback p_changed_cb;
+
+    std::atomic<bool> p_events_watched { false };
 };
 
 } // namespace tcam::property
@@ -0,0 +1,684 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "V4L2Reactor.h"
+
+#include "../ThreadPolicy.h"
+#include "../logging.h"
+#include "../utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <libudev.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace tcam::v4l2;
+
+namespace
+{
+
+// tasks a delivery_queue runs before it lets other devices use the worker
+constexpr int max_tasks_per_run = 4;
+
+constexpr int max_events = 16;
+
+std::vector<int> parse_cpu_list(const std::string& str)
+{
+    std::vector<int> ret;
+    for (const auto& s : tcam::split_string(str, ","))
+    {
+        if (s.empty())
+        {
+            continue;
+        }
+        try
+        {
+            ret.push_back(std::stoi(s));
+        }
+        catch (const std::exception&)
+        {
+            libtcam::logger()->warn("Ignoring invalid cpu '{}' in TCAM_V4L2_REACTOR_CPUS.", s);
+        }
+    }
+    return ret;
+}
+
+std::chrono::steady_clock::time_point deadline_from(int timeout_ms)
+{
+    if (timeout_ms <= 0)
+    {
+        return std::chrono::steady_clock::time_point::max();
+    }
+    return std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+}
+
+} // namespace
+
+
+tcam::v4l2::V4L2Reactor::delivery_queue::delivery_queue(V4L2Reactor& reactor) : reactor_(reactor)
+{
+}
+
+
+void tcam::v4l2::V4L2Reactor::delivery_queue::post(std::function<void()> task,
+                                                   std::function<void()> on_cancel)
+{
+    {
+        std::scoped_lock lck(mtx_);
+        tasks_.push_back({ std::move(task), std::move(on_cancel) });
+
+        if (scheduled_)
+        {
+            return;
+        }
+        scheduled_ = true;
+    }
+    reactor_.schedule(shared_from_this());
+}
+
+
+void tcam::v4l2::V4L2Reactor::delivery_queue::cancel()
+{
+    std::unique_lock lck(mtx_);
+
+    std::deque<entry> canceled;
+    canceled.swap(tasks_);
+
+    // outside the lock, a handler may post or cancel again
+    lck.unlock();
+    for (auto& e : canceled)
+    {
+        if (e.on_cancel)
+        {
+            e.on_cancel();
+        }
+    }
+    lck.lock();
+
+    if (running_in_ == std::this_thread::get_id())
+    {
+        return;
+    }
+    cv_.wait(lck, [this] { return !scheduled_; });
+}
+
+
+void tcam::v4l2::V4L2Reactor::delivery_queue::run()
+{
+    std::unique_lock lck(mtx_);
+
+    running_in_ = std::this_thread::get_id();
+
+    for (int i = 0; i < max_tasks_per_run && !tasks_.empty(); ++i)
+    {
+        auto task = std::move(tasks_.front().task);
+        tasks_.pop_front();
+
+        lck.unlock();
+        task();
+        lck.lock();
+    }
+
+    running_in_ = {};
+
+    if (tasks_.empty())
+    {
+        scheduled_ = false;
+        cv_.notify_all();
+        return;
+    }
+
+    // more images arrived, queue behind the other devices
+    lck.unlock();
+    reactor_.schedule(shared_from_this());
+}
+
+
+std::shared_ptr<V4L2Reactor> tcam::v4l2::V4L2Reactor::get_instance()
+{
+    static std::shared_ptr<V4L2Reactor> instance = []() -> std::shared_ptr<V4L2Reactor>
+    {
+        const int worker_count = tcam::get_environment_variable_int("TCAM_V4L2_REACTOR").value_or(0);
+
+        if (worker_count <= 0)
+        {
+            return nullptr;
+        }
+
+        auto cpus = parse_cpu_list(tcam::get_environment_variable("TCAM_V4L2_REACTOR_CPUS", ""));
+
+        try
+        {
+            return std::make_shared<V4L2Reactor>(worker_count, std::move(cpus));
+        }
+        catch (const std::exception& e)
+        {
+            libtcam::logger()->error(
+                "Unable to create v4l2 reactor: {}. Devices will use their own threads.", e.what());
+        }
+        return nullptr;
+    }();
+
+    return instance;
+}
+
+
+tcam::v4l2::V4L2Reactor::V4L2Reactor(int worker_count, std::vector<int> cpus)
+    : cpus_(std::move(cpus))
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1)
+    {
+        throw std::runtime_error("epoll_create1 failed");
+    }
+
+    wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd_ == -1)
+    {
+        close(epoll_fd_);
+        throw std::runtime_error("eventfd failed");
+    }
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    if (!open_udev_monitor())
+    {
+        libtcam::logger()->warn("v4l2 reactor has no udev monitor. Devices will monitor themselves.");
+    }
+
+    for (int i = 0; i < worker_count; ++i)
+    {
+        workers_.emplace_back(&V4L2Reactor::worker, this);
+    }
+
+    thread_ = std::thread(&V4L2Reactor::run, this);
+
+    libtcam::logger()->info("Using shared v4l2 reactor with {} worker(s).", worker_count);
+}
+
+
+tcam::v4l2::V4L2Reactor::~V4L2Reactor()
+{
+    {
+        std::scoped_lock lck(mtx_);
+        stop_ = true;
+    }
+    wake();
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+
+    {
+        std::scoped_lock lck(workers_mtx_);
+        stop_workers_ = true;
+    }
+    workers_cv_.notify_all();
+
+    for (auto& w : workers_)
+    {
+        if (w.joinable())
+        {
+            w.join();
+        }
+    }
+
+    if (udev_monitor_)
+    {
+        udev_monitor_unref(udev_monitor_);
+    }
+    if (udev_)
+    {
+        udev_unref(udev_);
+    }
+
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+
+bool tcam::v4l2::V4L2Reactor::open_udev_monitor()
+{
+    udev_ = udev_new();
+    if (!udev_)
+    {
+        libtcam::logger()->error("Failed to create udev context");
+        return false;
+    }
+
+    udev_monitor_ = udev_monitor_new_from_netlink(udev_, "udev");
+    if (!udev_monitor_)
+    {
+        libtcam::logger()->error("Failed to create udev monitor");
+        udev_unref(udev_);
+        udev_ = nullptr;
+        return false;
+    }
+    udev_monitor_filter_add_match_subsystem_devtype(udev_monitor_, "video4linux", NULL);
+    udev_monitor_enable_receiving(udev_monitor_);
+
+    udev_fd_ = udev_monitor_get_fd(udev_monitor_);
+
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.fd = udev_fd_;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, udev_fd_, &ev) == -1)
+    {
+        libtcam::logger()->error("Unable to watch udev monitor. errno: {} ({})", errno, strerror(errno));
+        udev_monitor_unref(udev_monitor_);
+        udev_unref(udev_);
+        udev_monitor_ = nullptr;
+        udev_ = nullptr;
+        udev_fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+
+bool tcam::v4l2::V4L2Reactor::add_fd(int fd,
+                                     uint32_t epoll_events,
+                                     event_callback on_event,
+                                     timeout_callback on_timeout,
+                                     timeout_getter get_timeout_ms)
+{
+    {
+        std::scoped_lock lck(mtx_);
+
+        if (handlers_.count(fd))
+        {
+            libtcam::logger()->error("fd {} is already watched by the v4l2 reactor.", fd);
+            return false;
+        }
+
+        epoll_event ev = {};
+        ev.events = epoll_events;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1)
+        {
+            libtcam::logger()->error("Unable to add fd to the v4l2 reactor. errno: {} ({})", errno, strerror(errno));
+            return false;
+        }
+
+        const auto deadline = deadline_from(get_timeout_ms());
+        handlers_[fd] = { std::move(on_event), std::move(on_timeout), std::move(get_timeout_ms), deadline };
+    }
+
+    // the reactor may be waiting without any timeout
+    wake();
+    return true;
+}
+
+
+void tcam::v4l2::V4L2Reactor::remove_fd(int fd)
+{
+    std::unique_lock lck(mtx_);
+
+    if (handlers_.erase(fd) == 0)
+    {
+        return;
+    }
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+
+    if (!is_reactor_thread())
+    {
+        dispatch_done_cv_.wait(lck, [this, fd] { return dispatching_fd_ != fd; });
+    }
+}
+
+
+void tcam::v4l2::V4L2Reactor::reset_timeout(int fd)
+{
+    std::scoped_lock lck(mtx_);
+
+    auto it = handlers_.find(fd);
+    if (it != handlers_.end())
+    {
+        // only moves the deadline further away, no need to wake the reactor
+        it->second.deadline = deadline_from(it->second.get_timeout_ms());
+    }
+}
+
+
+bool tcam::v4l2::V4L2Reactor::add_device_lost_watch(const std::string& devnode,
+                                                    const void* owner,
+                                                    device_lost_callback cb)
+{
+    if (!udev_monitor_)
+    {
+        return false;
+    }
+
+    std::scoped_lock lck(mtx_);
+    watches_.push_back({ devnode, owner, std::move(cb) });
+
+    return true;
+}
+
+
+void tcam::v4l2::V4L2Reactor::remove_device_lost_watch(const void* owner)
+{
+    std::unique_lock lck(mtx_);
+
+    watches_.erase(std::remove_if(watches_.begin(),
+                                  watches_.end(),
+                                  [owner](const auto& w) { return w.owner == owner; }),
+                   watches_.end());
+
+    if (!is_reactor_thread())
+    {
+        dispatch_done_cv_.wait(lck, [this, owner] { return dispatching_owner_ != owner; });
+    }
+}
+
+
+std::shared_ptr<V4L2Reactor::delivery_queue> tcam::v4l2::V4L2Reactor::create_delivery_queue()
+{
+    return std::make_shared<delivery_queue>(*this);
+}
+
+
+void tcam::v4l2::V4L2Reactor::wake()
+{
+    uint64_t one = 1;
+    [[maybe_unused]] auto r = write(wake_fd_, &one, sizeof(one));
+}
+
+
+bool tcam::v4l2::V4L2Reactor::is_reactor_thread() const
+{
+    return std::this_thread::get_id() == thread_.get_id();
+}
+
+
+void tcam::v4l2::V4L2Reactor::apply_affinity()
+{
+    if (cpus_.empty())
+    {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus_)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &set);
+        }
+    }
+
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0)
+    {
+        libtcam::logger()->warn("Unable to set cpu affinity of v4l2 reactor thread: {}", strerror(ret));
+    }
+}
+
+
+int tcam::v4l2::V4L2Reactor::next_wait_ms()
+{
+    std::scoped_lock lck(mtx_);
+
+    auto next = std::chrono::steady_clock::time_point::max();
+    for (const auto& [fd, h] : handlers_) { next = std::min(next, h.deadline); }
+
+    if (next == std::chrono::steady_clock::time_point::max())
+    {
+        return -1;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (next <= now)
+    {
+        return 0;
+    }
+    // round up, waking before the deadline would only cause another wait
+    return std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count() + 1;
+}
+
+
+void tcam::v4l2::V4L2Reactor::run()
+{
+    tcam::apply_thread_policy(tcam::thread_role::capture, "tcam_v4l2_react");
+    apply_affinity();
+
+    epoll_event events[max_events] = {};
+
+    while (true)
+    {
+        {
+            std::scoped_lock lck(mtx_);
+            if (stop_)
+            {
+                break;
+            }
+        }
+
+        int ret = epoll_wait(epoll_fd_, events, max_events, next_wait_ms());
+
+        if (ret == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            libtcam::logger()->error("Error during epoll_wait in v4l2 reactor. errno: {} ({})", errno, strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < ret; ++i)
+        {
+            const int fd = events[i].data.fd;
+
+            if (fd == wake_fd_)
+            {
+                uint64_t count = 0;
+                [[maybe_unused]] auto r = read(wake_fd_, &count, sizeof(count));
+            }
+            else if (fd == udev_fd_)
+            {
+                handle_udev();
+            }
+            else
+            {
+                dispatch(fd, events[i].events);
+            }
+        }
+
+        check_timeouts();
+    }
+}
+
+
+void tcam::v4l2::V4L2Reactor::dispatch(int fd, uint32_t events)
+{
+    event_callback cb;
+    {
+        std::scoped_lock lck(mtx_);
+
+        auto it = handlers_.find(fd);
+        // removed while epoll_wait already returned its event
+        if (it == handlers_.end())
+        {
+            return;
+        }
+        cb = it->second.on_event;
+        dispatching_fd_ = fd;
+    }
+
+    cb(events);
+
+    std::scoped_lock lck(mtx_);
+
+    dispatching_fd_ = -1;
+
+    auto it = handlers_.find(fd);
+    if (it != handlers_.end())
+    {
+        it->second.deadline = deadline_from(it->second.get_timeout_ms());
+    }
+    dispatch_done_cv_.notify_all();
+}
+
+
+void tcam::v4l2::V4L2Reactor::check_timeouts()
+{
+    std::vector<int> expired;
+    {
+        std::scoped_lock lck(mtx_);
+
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& [fd, h] : handlers_)
+        {
+            if (h.deadline <= now)
+            {
+                expired.push_back(fd);
+            }
+        }
+    }
+
+    for (int fd : expired)
+    {
+        timeout_callback cb;
+        {
+            std::scoped_lock lck(mtx_);
+
+            auto it = handlers_.find(fd);
+            if (it == handlers_.end())
+            {
+                continue;
+            }
+            cb = it->second.on_timeout;
+            dispatching_fd_ = fd;
+        }
+
+        if (cb)
+        {
+            cb();
+        }
+
+        std::scoped_lock lck(mtx_);
+
+        dispatching_fd_ = -1;
+
+        auto it = handlers_.find(fd);
+        if (it != handlers_.end())
+        {
+            it->second.deadline = deadline_from(it->second.get_timeout_ms());
+        }
+        dispatch_done_cv_.notify_all();
+    }
+}
+
+
+void tcam::v4l2::V4L2Reactor::handle_udev()
+{
+    auto dev = udev_monitor_receive_device(udev_monitor_);
+    if (!dev)
+    {
+        libtcam::logger()->error("No Device from udev_monitor_receive_device. An error occured.");
+        return;
+    }
+
+    const char* devnode = udev_device_get_devnode(dev);
+    const char* action = udev_device_get_action(dev);
+
+    if (!devnode || !action || strcmp(action, "remove") != 0)
+    {
+        udev_device_unref(dev);
+        return;
+    }
+
+    std::vector<const void*> owners;
+    {
+        std::scoped_lock lck(mtx_);
+        for (const auto& w : watches_)
+        {
+            if (w.devnode == devnode)
+            {
+                owners.push_back(w.owner);
+            }
+        }
+    }
+    udev_device_unref(dev);
+
+    for (const void* owner : owners)
+    {
+        device_lost_callback cb;
+        {
+            std::scoped_lock lck(mtx_);
+
+            auto it = std::find_if(
+                watches_.begin(), watches_.end(), [owner](const auto& w) { return w.owner == owner; });
+            if (it == watches_.end())
+            {
+                continue;
+            }
+            cb = it->cb;
+            dispatching_owner_ = owner;
+        }
+
+        cb();
+
+        std::scoped_lock lck(mtx_);
+        dispatching_owner_ = nullptr;
+        dispatch_done_cv_.notify_all();
+    }
+}
+
+
+void tcam::v4l2::V4L2Reactor::schedule(std::shared_ptr<delivery_queue> queue)
+{
+    {
+        std::scoped_lock lck(workers_mtx_);
+        ready_queues_.push_back(std::move(queue));
+    }
+    workers_cv_.notify_one();
+}
+
+
+void tcam::v4l2::V4L2Reactor::worker()
+{
+    tcam::apply_thread_policy(tcam::thread_role::delivery, "tcam_v4l2_work");
+    apply_affinity();
+
+    while (true)
+    {
+        std::shared_ptr<delivery_queue> queue;
+        {
+            std::unique_lock lck(workers_mtx_);
+            workers_cv_.wait(lck, [this] { return stop_workers_ || !ready_queues_.empty(); });
+
+            if (ready_queues_.empty())
+            {
+                return;
+            }
+            queue = std::move(ready_queues_.front());
+            ready_queues_.pop_front();
+        }
+
+        queue->run();
+    }
+}
@@ -0,0 +1,200 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../compiler_defines.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct udev;
+struct udev_monitor;
+
+VISIBILITY_INTERNAL
+
+namespace tcam::v4l2
+{
+
+//
+// Process wide event loop for all v4l2 devices
+//
+// Instead of a stream thread and a udev monitor thread per device,
+// one thread waits on all streaming devices and one shared udev monitor.
+// Images are dequeued on that thread and handed to the sinks on a
+// small worker pool. Each device delivers through its own delivery_queue,
+// which keeps the images of a device in order.
+//
+// Enabled with TCAM_V4L2_REACTOR=<number of worker threads>.
+// TCAM_V4L2_REACTOR_CPUS=<cpu>[,<cpu>...] pins the reactor and workers.
+//
+class V4L2Reactor
+{
+public:
+    // called on the reactor thread with the epoll events of the fd
+    using event_callback = std::function<void(uint32_t events)>;
+    // called on the reactor thread when the fd had no event for get_timeout_ms
+    using timeout_callback = std::function<void()>;
+    // evaluated after every event/timeout, values <= 0 disable the timeout
+    using timeout_getter = std::function<int()>;
+    using device_lost_callback = std::function<void()>;
+
+    //
+    // Tasks posted to a delivery_queue run one after another on the worker pool
+    //
+    class delivery_queue : public std::enable_shared_from_this<delivery_queue>
+    {
+    public:
+        explicit delivery_queue(V4L2Reactor& reactor);
+
+        // on_cancel runs instead of task when the queue is canceled before task ran,
+        // e.g. to give back a buffer the task would have consumed
+        void post(std::function<void()> task, std::function<void()> on_cancel = {});
+
+        // drop all pending tasks, running their on_cancel on the calling thread,
+        // and wait for a running one to finish
+        // does not wait when called from within a task of this queue
+        void cancel();
+
+    private:
+        friend class V4L2Reactor;
+
+        struct entry
+        {
+            std::function<void()> task;
+            std::function<void()> on_cancel;
+        };
+
+        // executes pending tasks, called by a worker
+        void run();
+
+        V4L2Reactor& reactor_;
+
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        std::deque<entry> tasks_;
+        // the queue is waiting for or running on a worker
+        bool scheduled_ = false;
+        std::thread::id running_in_;
+    };
+
+    // returns nullptr when the reactor is not enabled
+    static std::shared_ptr<V4L2Reactor> get_instance();
+
+    V4L2Reactor(int worker_count, std::vector<int> cpus);
+    ~V4L2Reactor();
+
+    V4L2Reactor(const V4L2Reactor&) = delete;
+    V4L2Reactor& operator=(const V4L2Reactor&) = delete;
+
+    // epoll_events - e.g. EPOLLIN
+    bool add_fd(int fd,
+                uint32_t epoll_events,
+                event_callback on_event,
+                timeout_callback on_timeout,
+                timeout_getter get_timeout_ms);
+
+    // no callback for fd runs or will be called after this returns
+    // unless it is called from such a callback
+    void remove_fd(int fd);
+
+    // restart the timeout of fd, e.g. when waiting makes sense again
+    void reset_timeout(int fd);
+
+    // devnode - e.g. /dev/video0
+    // cb is called on the reactor thread when udev reports the removal of devnode
+    bool add_device_lost_watch(const std::string& devnode, const void* owner, device_lost_callback cb);
+
+    // no callback of owner runs or will be called after this returns
+    // unless it is called from such a callback
+    void remove_device_lost_watch(const void* owner);
+
+    std::shared_ptr<delivery_queue> create_delivery_queue();
+
+private:
+    struct fd_handler
+    {
+        event_callback on_event;
+        timeout_callback on_timeout;
+        timeout_getter get_timeout_ms;
+        // time_point::max() when no timeout is active
+        std::chrono::steady_clock::time_point deadline;
+    };
+
+    struct lost_watch
+    {
+        std::string devnode;
+        const void* owner;
+        device_lost_callback cb;
+    };
+
+    void run();
+    void dispatch(int fd, uint32_t events);
+    void check_timeouts();
+    int next_wait_ms();
+    void handle_udev();
+    bool open_udev_monitor();
+
+    void wake();
+    bool is_reactor_thread() const;
+
+    void schedule(std::shared_ptr<delivery_queue> queue);
+    void worker();
+
+    void apply_affinity();
+
+    int epoll_fd_ = -1;
+    // wakes the reactor thread for stop and changed timeouts
+    int wake_fd_ = -1;
+
+    std::thread thread_;
+    bool stop_ = false;
+
+    // guards handlers_, dispatching_fd_, watches_ and dispatching_owner_
+    std::mutex mtx_;
+    std::condition_variable dispatch_done_cv_;
+    std::map<int, fd_handler> handlers_;
+    int dispatching_fd_ = -1;
+
+    std::vector<lost_watch> watches_;
+    const void* dispatching_owner_ = nullptr;
+
+    // only touched by the reactor thread after creation
+    struct udev* udev_ = nullptr;
+    struct udev_monitor* udev_monitor_ = nullptr;
+    int udev_fd_ = -1;
+
+    std::mutex workers_mtx_;
+    std::condition_variable workers_cv_;
+    std::deque<std::shared_ptr<delivery_queue>> ready_queues_;
+    std::vector<std::thread> workers_;
+    bool stop_workers_ = false;
+
+    std::vector<int> cpus_;
+};
+
+} // namespace tcam::v4l2
+
+VISIBILITY_POP
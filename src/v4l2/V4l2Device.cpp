@@ -16,8 +16,11 @@
 
 #include "V4l2Device.h"
 
+#include "../ThreadPolicy.h"
 #include "../logging.h"
 #include "../utils.h"
+#include "uvc-extension-loader.h"
+#include "v4l2_format_cache.h"
 #include "v4l2_utils.h"
 
 #include <algorithm>
@@ -27,6 +30,8 @@
 #include <fcntl.h> /* O_RDWR O_NONBLOCK */
 #include <libudev.h>
 #include <linux/videodev2.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 using namespace tcam;
@@ -34,6 +39,23 @@ using namespace tcam;
 static const int lost_countdown_default = 5;
 
 
+static v4l2_memory to_v4l2_memory(TCAM_MEMORY_TYPE t)
+{
+    switch (t)
+    {
+        case TCAM_MEMORY_TYPE_USERPTR:
+            return V4L2_MEMORY_USERPTR;
+        // exported dma buffers are mmap buffers for v4l2
+        case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
+            return V4L2_MEMORY_MMAP;
+        case TCAM_MEMORY_TYPE_DMA_IMPORT:
+            return V4L2_MEMORY_DMABUF;
+    }
+    return V4L2_MEMORY_USERPTR;
+}
+
+
 V4l2Device::V4l2Device(const DeviceInfo& device_desc)
 {
     device = device_desc;
@@ -48,13 +70,35 @@ V4l2Device::V4l2Device(const DeviceInfo& device_desc)
         throw std::runtime_error("Failed opening device.");
     }
 
-    m_monitor_v4l2_thread = std::thread(&V4l2Device::monitor_v4l2_thread_func, this);
+    m_reactor = tcam::v4l2::V4L2Reactor::get_instance();
+
+    if (m_reactor)
+    {
+        m_reactor_watches_device =
+            m_reactor->add_device_lost_watch(device.get_identifier(),
+                                             this,
+                                             [this]()
+                                             {
+                                                 libtcam::logger()->error("Lost device! {}",
+                                                                          device.get_name());
+                                                 this->lost_device();
+                                             });
+    }
+
+    if (!m_reactor_watches_device)
+    {
+        m_monitor_v4l2_thread = std::thread(&V4l2Device::monitor_v4l2_thread_func, this);
+    }
 
     p_property_backend = std::make_shared<tcam::v4l2::V4L2PropertyBackend>(m_fd);
 
     allocator_ = std::make_shared<V4L2Allocator>(m_fd);
 
     this->create_properties();
+
+    p_property_backend->set_control_changed_callback(
+        [this](uint32_t v4l2_id, int64_t /*new_value*/) { on_control_changed(v4l2_id); });
+
     this->index_formats();
 
     determine_active_video_format();
@@ -72,6 +116,11 @@ V4l2Device::~V4l2Device()
 
     this->m_stop_monitor_v4l2_thread = true;
 
+    if (m_reactor_watches_device)
+    {
+        m_reactor->remove_device_lost_watch(this);
+    }
+
     if (this->m_fd != -1)
     {
         close(m_fd);
@@ -266,12 +315,15 @@ bool V4l2Device::initialize_buffers(std::shared_ptr<BufferPool> pool)
 
     auto b = pool_->get_buffer();
 
+    std::scoped_lock lck(m_buffers_mtx);
+
+    m_shrink_pending = false;
     this->m_buffers.clear();
     this->m_buffers.reserve(b.size());
 
     for (unsigned int i = 0; i < b.size(); ++i)
     {
-        buffer_info info = { b.at(i), false };
+        buffer_info info = { b.at(i).lock(), false };
 
         this->m_buffers.push_back(info);
     }
@@ -292,7 +344,7 @@ bool V4l2Device::release_buffers()
 
     req.count = 0; // free all buffers
     req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    req.memory = V4L2_MEMORY_USERPTR;
+    req.memory = pool_ ? to_v4l2_memory(pool_->get_memory_type()) : V4L2_MEMORY_USERPTR;
 
     if (-1 == tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req))
     {
@@ -300,12 +352,42 @@ bool V4l2Device::release_buffers()
                      strerror(errno));
     }
 
+    std::scoped_lock lck(m_buffers_mtx);
     m_buffers.clear();
     return true;
 }
 
 
-bool V4l2Device::queue_mmap(int i, std::shared_ptr<ImageBuffer> b)
+void V4l2Device::begin_property_batch()
+{
+    p_property_backend->begin_batch();
+}
+
+
+outcome::result<void> V4l2Device::commit_property_batch(
+    std::vector<tcam::property::batch_write_failure>& failed)
+{
+    std::vector<tcam::v4l2::V4L2PropertyBackend::batch_failure> failed_controls;
+    auto ret = p_property_backend->commit_batch(&failed_controls);
+
+    for (const auto& f : failed_controls)
+    {
+        auto iter = m_control_names.find(f.v4l2_id);
+        if (iter != m_control_names.end())
+        {
+            failed.push_back({ iter->second, f.error });
+        }
+        else
+        {
+            // e.g. the second control of a property that is mapped onto two controls
+            libtcam::logger()->warn("Unable to write control {:#x}: {}", f.v4l2_id, f.error.message());
+        }
+    }
+    return ret;
+}
+
+
+bool V4l2Device::queue_mmap(int i, const std::shared_ptr<ImageBuffer>& b)
 {
     struct v4l2_buffer buf = {};
 
@@ -325,7 +407,29 @@ bool V4l2Device::queue_mmap(int i, std::shared_ptr<ImageBuffer> b)
 }
 
 
-bool V4l2Device::queue_userptr(int i, std::shared_ptr<ImageBuffer> b)
+bool V4l2Device::queue_dma(int i, const std::shared_ptr<ImageBuffer>& b)
+{
+    struct v4l2_buffer buf = {};
+
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_DMABUF;
+    buf.index = i;
+    buf.m.fd = b->get_file_descriptor();
+    buf.length = b->get_image_buffer_size();
+
+    int ret = tcam_xioctl(m_fd, VIDIOC_QBUF, &buf);
+    if (ret == -1)
+    {
+        libtcam::logger()->error(
+            "Unable to queue dma buffer(fd: {}): {} {}", buf.m.fd, errno, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+
+bool V4l2Device::queue_userptr(int i, const std::shared_ptr<ImageBuffer>& b)
 {
 
     struct v4l2_buffer buf = {};
@@ -349,41 +453,76 @@ bool V4l2Device::queue_userptr(int i, std::shared_ptr<ImageBuffer> b)
 
 void V4l2Device::requeue_buffer(const std::shared_ptr<ImageBuffer>& buffer)
 {
+    std::scoped_lock lck(m_buffers_mtx);
 
-    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    const int i = buffer->get_pool_index();
+
+    if (i < 0 || (size_t)i >= m_buffers.size() || m_buffers[i].buffer != buffer)
     {
+        libtcam::logger()->debug("Buffer not requeued. Not part of the current buffer pool. ptr={}",
+                                 fmt::ptr(buffer.get()));
+        return;
+    }
+
+    auto& b = m_buffers[i];
 
-        auto& b = m_buffers.at(i);
+    if (b.is_queued || !buffer->has_memory())
+    {
+        return;
+    }
 
-        auto buf_ptr = b.buffer.lock();
+    // the stream thread cannot receive anything while no buffer is queued
+    // tell it that waiting makes sense again
+    const bool was_starved = std::none_of(
+        m_buffers.begin(), m_buffers.end(), [](const auto& info) { return info.is_queued; });
 
-        if (!b.is_queued && buf_ptr == buffer)
+    if (m_shrink_pending && pool_->shrink(buffer))
+    {
+        // the slot stays known to v4l2 but is not queued again
+        // until the pool grows
+        m_shrink_pending = false;
+        libtcam::logger()->debug("Released idle buffer {}", i);
+        return;
+    }
+
+    switch (pool_->get_memory_type())
+    {
+        case TCAM_MEMORY_TYPE_USERPTR:
         {
-            switch (pool_->get_memory_type())
+            if (queue_userptr(i, buffer))
             {
-                case TCAM_MEMORY_TYPE_USERPTR:
-                {
-                    if (queue_userptr(i, buf_ptr))
-                    {
-                        b.is_queued = true;
-                    }
-                    break;
-                }
-                case TCAM_MEMORY_TYPE_MMAP:
-                {
-                    if (queue_mmap(i, buf_ptr))
-                    {
-                        b.is_queued = true;
-                    }
-                    break;
-                }
-                case TCAM_MEMORY_TYPE_DMA:
-                case TCAM_MEMORY_TYPE_DMA_IMPORT:
-                {
-                    libtcam::logger()->error("Queueing of DMA not implemented");
-                    break;
-                }
+                b.is_queued = true;
+            }
+            break;
+        }
+        case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
+        {
+            if (queue_mmap(i, buffer))
+            {
+                b.is_queued = true;
             }
+            break;
+        }
+        case TCAM_MEMORY_TYPE_DMA_IMPORT:
+        {
+            if (queue_dma(i, buffer))
+            {
+                b.is_queued = true;
+            }
+            break;
+        }
+    }
+
+    if (was_starved && b.is_queued)
+    {
+        if (m_reactor)
+        {
+            m_reactor->reset_timeout(m_fd);
+        }
+        else
+        {
+            signal_stream_event();
         }
     }
 }
@@ -422,27 +561,37 @@ bool V4l2Device::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
             break;
         }
         case TCAM_MEMORY_TYPE_MMAP:
+        case TCAM_MEMORY_TYPE_DMA:
         {
             libtcam::logger()->debug("init mmap");
             init_mmap_buffers();
             break;
         }
-        case TCAM_MEMORY_TYPE_DMA:
         case TCAM_MEMORY_TYPE_DMA_IMPORT:
         {
-            libtcam::logger()->error("MEMORY type not implemented");
-            return false;
+            if (!init_dma_buffers())
+            {
+                return false;
+            }
+            break;
         }
     }
 
+    if (!m_reactor && !create_stream_events())
+    {
+        return false;
+    }
+
     v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     if (-1 == tcam_xioctl(m_fd, VIDIOC_STREAMON, &type))
     {
         libtcam::logger()->error("Unable to set ioctl VIDIOC_STREAMON {} {}", errno, strerror(errno));
+        close_stream_events();
         return false;
     }
 
     m_statistics = {};
+    m_has_sequence = false;
 
     m_listener = sink;
 
@@ -450,10 +599,25 @@ bool V4l2Device::start_stream(const std::shared_ptr<IImageBufferSink>& sink)
 
     update_stream_timeout();
 
+    if (m_reactor)
+    {
+        if (!start_reactor_stream())
+        {
+            m_is_stream_on = false;
+            tcam_xioctl(m_fd, VIDIOC_STREAMOFF, &type);
+            m_listener.reset();
+            return false;
+        }
+        p_property_backend->set_events_watched(true);
+        return true;
+    }
+
     libtcam::logger()->info("Starting stream in work thread.");
 
     this->m_work_thread = std::thread(&V4l2Device::stream, this);
 
+    p_property_backend->set_events_watched(true);
+
     return true;
 }
 
@@ -480,9 +644,30 @@ void V4l2Device::stop_stream()
 
     m_is_stream_on = false;
 
-    if (m_work_thread.joinable())
+    p_property_backend->set_events_watched(false);
+
+    if (m_reactor)
     {
-        m_work_thread.join();
+        m_reactor->remove_fd(m_fd);
+
+        // images that were dequeued but not delivered yet are requeued
+        if (m_delivery_queue)
+        {
+            m_delivery_queue->cancel();
+            m_delivery_queue.reset();
+        }
+    }
+    else
+    {
+        // wake the stream thread, it may wait for a long exposure
+        signal_stream_event();
+
+        if (m_work_thread.joinable())
+        {
+            m_work_thread.join();
+        }
+
+        close_stream_events();
     }
 
     m_listener.reset();
@@ -508,6 +693,19 @@ void V4l2Device::lost_device()
 }
 
 
+void V4l2Device::on_control_changed(uint32_t v4l2_id)
+{
+    auto iter = m_control_names.find(v4l2_id);
+    if (iter == m_control_names.end())
+    {
+        return;
+    }
+
+    libtcam::logger()->debug("Device reported new value for '{}'", iter->second);
+    notify_property_changed(iter->second);
+}
+
+
 /*
  * in kernel versions < 3.15 uvcvideo does not correctly interpret bayer 8-bit
  * this function detects those cases and corrects all settings
@@ -977,76 +1175,114 @@ void V4l2Device::generate_scales()
 
 void V4l2Device::index_formats()
 {
-    generate_scales();
+    tcam::v4l2::format_cache_data cache_data;
 
-    struct v4l2_fmtdesc fmtdesc = {};
-    struct v4l2_frmsizeenum frms = {};
+    std::string cache_key;
+    if (!tcam::is_environment_variable_set("TCAM_DISABLE_FORMAT_CACHE"))
+    {
+        cache_key = tcam::v4l2::format_cache_key(
+            m_fd, tcam::uvc::determine_extension_file(device.get_info().additional_identifier));
+    }
 
-    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (!cache_key.empty() && tcam::v4l2::load_format_cache(cache_key, m_fd, cache_data))
+    {
+        // properties are still needed to apply scalings
+        if (m_scale.scale_type == ImageScalingType::Unknown)
+        {
+            determine_scaling();
+        }
+        m_scale.scales = cache_data.scales;
+        for (const auto& o : cache_data.override_index)
+        {
+            m_scale.override_index.push_back({ o.override_value, o.scales_index });
+        }
 
-    for (fmtdesc.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FMT, &fmtdesc); fmtdesc.index++)
+        libtcam::logger()->debug("Using cached format list of {}", cache_key);
+    }
+    else
+    {
+        generate_scales();
+
+        cache_data.formats = enumerate_formats();
+
+        if (!cache_key.empty())
+        {
+            cache_data.scales = m_scale.scales;
+            for (const auto& o : m_scale.override_index)
+            {
+                cache_data.override_index.push_back({ o.override_value, o.scales_index });
+            }
+            tcam::v4l2::store_format_cache(cache_key, cache_data);
+        }
+    }
+
+    for (const auto& fmt : cache_data.formats)
     {
         struct tcam_video_format_description desc = {};
 
+        struct v4l2_fmtdesc fmtdesc = {};
+        fmtdesc.pixelformat = fmt.pixelformat;
+        strncpy((char*)fmtdesc.description, fmt.description.c_str(), sizeof(fmtdesc.description) - 1);
+
         struct v4l2_fmtdesc new_desc = {};
         m_emulate_bayer = checkForBayer(fmtdesc, new_desc);
 
         // internal fourcc definitions are identical with v4l2
         desc.fourcc = new_desc.pixelformat;
         memcpy(desc.description, new_desc.description, sizeof(new_desc.description));
-        frms.pixel_format = fmtdesc.pixelformat;
 
         std::vector<struct framerate_mapping> rf;
 
         // needed for binning/skipping later on
         tcam_image_size sensor_size = {};
 
-        // iterate all framesizes to find largest
-        for (frms.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMESIZES, &frms); frms.index++)
+        // find largest framesize
+        for (const auto& size : fmt.sizes)
         {
-            if (frms.type == V4L2_FRMSIZE_TYPE_DISCRETE)
-            {
-                sensor_size.width = std::max(frms.discrete.width,sensor_size.width);
-                sensor_size.height = std::max(frms.discrete.height,sensor_size.height);
-            }
+            sensor_size.width = std::max(size.width, sensor_size.width);
+            sensor_size.height = std::max(size.height, sensor_size.height);
         }
 
-        for (frms.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMESIZES, &frms); frms.index++)
+        for (const auto& size : fmt.sizes)
         {
-            if (frms.type == V4L2_FRMSIZE_TYPE_DISCRETE)
+            struct tcam_resolution_description res = {};
+
+            res.min_size.width = size.width;
+            res.max_size.width = size.width;
+            res.min_size.height = size.height;
+            res.max_size.height = size.height;
+
+            std::vector<double> f;
+            for (const auto& interval : size.intervals)
             {
-                struct tcam_resolution_description res = {};
+                // v4l2 lists frame rates as fractions (number of seconds / frames (e.g. 1/30))
+                // we however use framerates as fps (e.g. 30/1)
+                // therefor we have to switch numerator and denominator
 
-                res.min_size.width = frms.discrete.width;
-                res.max_size.width = frms.discrete.width;
-                res.min_size.height = frms.discrete.height;
-                res.max_size.height = frms.discrete.height;
+                double frac = (double)interval.denominator / interval.numerator;
+                f.push_back(frac);
 
-                std::vector<double> f = index_framerates(frms);
+                framerate_conv c = { frac, interval.numerator, interval.denominator };
+                framerate_conversions.push_back(c);
+            }
 
-                res.type = TCAM_RESOLUTION_TYPE_FIXED;
+            res.type = TCAM_RESOLUTION_TYPE_FIXED;
 
-                framerate_mapping r = { res, f };
-                rf.push_back(r);
+            framerate_mapping r = { res, f };
+            rf.push_back(r);
 
-                for (auto s : m_scale.scales)
+            for (auto s : m_scale.scales)
+            {
+                if (s.legal_resolution(sensor_size, res.max_size))
                 {
-                    if (s.legal_resolution(sensor_size, res.max_size))
-                    {
-                        // being here we have a valid resolution/scaling combo
-                        // copy resolution desc and add scaling
-                        auto scaled_res = res;
-                        scaled_res.scaling = s;
+                    // being here we have a valid resolution/scaling combo
+                    // copy resolution desc and add scaling
+                    auto scaled_res = res;
+                    scaled_res.scaling = s;
 
-                        rf.push_back({scaled_res, f});
-                    }
+                    rf.push_back({scaled_res, f});
                 }
             }
-            else
-            {
-                // TIS USB cameras do not have this kind of setting
-                libtcam::logger()->error("Encountered unknown V4L2_FRMSIZE_TYPE");
-            }
         }
 
         // algorithms, etc. use Y800 as an identifier.
@@ -1065,7 +1301,48 @@ void V4l2Device::index_formats()
 }
 
 
-std::vector<double> V4l2Device::index_framerates(const struct v4l2_frmsizeenum& frms)
+std::vector<tcam::v4l2::cached_format> V4l2Device::enumerate_formats()
+{
+    std::vector<tcam::v4l2::cached_format> formats;
+
+    struct v4l2_fmtdesc fmtdesc = {};
+    struct v4l2_frmsizeenum frms = {};
+
+    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    for (fmtdesc.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FMT, &fmtdesc); fmtdesc.index++)
+    {
+        tcam::v4l2::cached_format fmt = {};
+
+        fmt.pixelformat = fmtdesc.pixelformat;
+        fmt.description = std::string((const char*)fmtdesc.description,
+                                      strnlen((const char*)fmtdesc.description,
+                                              sizeof(fmtdesc.description)));
+
+        frms.pixel_format = fmtdesc.pixelformat;
+
+        for (frms.index = 0; !tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMESIZES, &frms); frms.index++)
+        {
+            if (frms.type == V4L2_FRMSIZE_TYPE_DISCRETE)
+            {
+                fmt.sizes.push_back(
+                    { frms.discrete.width, frms.discrete.height, index_framerates(frms) });
+            }
+            else
+            {
+                // TIS USB cameras do not have this kind of setting
+                libtcam::logger()->error("Encountered unknown V4L2_FRMSIZE_TYPE");
+            }
+        }
+
+        formats.push_back(std::move(fmt));
+    }
+
+    return formats;
+}
+
+
+std::vector<v4l2_fract> V4l2Device::index_framerates(const struct v4l2_frmsizeenum& frms)
 {
     struct v4l2_frmivalenum frmival = {};
 
@@ -1073,23 +1350,19 @@ std::vector<double> V4l2Device::index_framerates(const struct v4l2_frmsizeenum&
     frmival.width = frms.discrete.width;
     frmival.height = frms.discrete.height;
 
-    std::vector<double> f;
+    std::vector<v4l2_fract> f;
 
     for (frmival.index = 0; tcam_xioctl(m_fd, VIDIOC_ENUM_FRAMEINTERVALS, &frmival) >= 0;
          frmival.index++)
     {
         if (frmival.type == V4L2_FRMIVAL_TYPE_DISCRETE)
         {
-
-            // v4l2 lists frame rates as fractions (number of seconds / frames (e.g. 1/30))
-            // we however use framerates as fps (e.g. 30/1)
-            // therefor we have to switch numerator and denominator
-
-            double frac = (double)frmival.discrete.denominator / frmival.discrete.numerator;
-            f.push_back(frac);
-
-            framerate_conv c = { frac, frmival.discrete.numerator, frmival.discrete.denominator };
-            framerate_conversions.push_back(c);
+            // skip invalid entries, they would result in infinite frame rates
+            if (frmival.discrete.numerator == 0 || frmival.discrete.denominator == 0)
+            {
+                continue;
+            }
+            f.push_back(frmival.discrete);
         }
         else
         {
@@ -1176,37 +1449,29 @@ bool V4l2Device::extension_unit_is_loaded()
 
 void V4l2Device::stream()
 {
-    tcam::set_thread_name("tcam_v4l2_strm");
+    tcam::apply_thread_policy(tcam::thread_role::capture, "tcam_v4l2_strm");
 
     m_already_received_valid_image = false;
-    static const int log_repetition = 10;
     int log_repetition_counter = 0;
     int lost_countdown = lost_countdown_default;
+
+    // epoll_wait timeout, the stream timeout is checked in these steps
+    static const int wait_timeout_ms = 2000;
     // period elapsed for current image
-    int waited_seconds = 0;
+    int waited_ms = 0;
     // maximum_waiting period
-    // do not compare waited_seconds with m_stream_timeout_sec directly
+    // do not compare waited_ms with m_stream_timeout_sec directly
     // m_stream_timeout_sec may be set to low values while we are
     // still waiting for a long exposure image
     // still 'step in between' prevents such errors
-    int waiting_period = m_stream_timeout_sec;
+    int waiting_period_ms = m_stream_timeout_sec * 1000;
+
+    epoll_event events[2] = {};
 
     while (this->m_is_stream_on)
     {
-        fd_set fds;
-
-        FD_ZERO(&fds);
-        FD_SET(m_fd, &fds);
-
-        int select_timeout = 2;
-
-        /* Timeout. */
-        struct timeval tv;
-        tv.tv_sec = select_timeout;
-        tv.tv_usec = 0;
-
         /* Wait until device gives go */
-        int ret = select(m_fd + 1, &fds, NULL, NULL, &tv);
+        int ret = epoll_wait(m_epoll_fd, events, 2, wait_timeout_ms);
         if (ret == -1)
         {
             if (errno == EINTR)
@@ -1215,8 +1480,7 @@ void V4l2Device::stream()
             }
             else
             {
-                /* error during select */
-                libtcam::logger()->error("Error during select. errno: %d (%s)", errno, strerror(errno));
+                libtcam::logger()->error("Error during epoll_wait. errno: {} ({})", errno, strerror(errno));
                 return;
             }
         }
@@ -1235,46 +1499,270 @@ void V4l2Device::stream()
                 continue; // timeout while trigger is enabled, just continue
             }
 
-            if (waited_seconds < waiting_period)
+            if (waited_ms < waiting_period_ms)
             {
-                waited_seconds += select_timeout;
+                waited_ms += wait_timeout_ms;
             }
             else
             {
                 libtcam::logger()->error("Timeout while waiting for new image buffer.");
                 m_statistics.frames_dropped++;
-                waited_seconds = 0;
+                if (metrics_)
+                {
+                    metrics_->count_drop(drop_cause::other);
+                }
+                waited_ms = 0;
                 lost_countdown--;
             }
         }
         else
         {
-            bool ret_value = get_frame();
-            if (ret_value)
+            bool device_ready = false;
+            bool device_error = false;
+            for (int i = 0; i < ret; ++i)
             {
-                lost_countdown = lost_countdown_default; // reset lost countdown variable
-                log_repetition_counter = 0;
+                if (events[i].data.fd == m_stream_event_fd)
+                {
+                    uint64_t count = 0;
+                    [[maybe_unused]] auto r = read(m_stream_event_fd, &count, sizeof(count));
+
+                    // buffers were requeued after the backend ran dry,
+                    // the time without queued buffers does not count as timeout
+                    waited_ms = 0;
+                }
+                else
+                {
+                    if (events[i].events & EPOLLPRI)
+                    {
+                        p_property_backend->handle_events();
+                    }
+                    if (events[i].events & ~EPOLLPRI)
+                    {
+                        device_ready = true;
+                    }
+                    if (events[i].events & (EPOLLERR | EPOLLHUP))
+                    {
+                        device_error = true;
+                    }
+                }
             }
-            else
+
+            if (device_ready)
             {
-                lost_countdown--;
+                // at high frame rates several buffers may be done,
+                // take all of them before waiting again
+                int received = 0;
+                while (m_is_stream_on && get_frame()) { received++; }
+
+                if (received > 0)
+                {
+                    lost_countdown = lost_countdown_default; // reset lost countdown variable
+                    log_repetition_counter = 0;
+                    waited_ms = 0;
+                }
+                else if (device_error)
+                {
+                    // the error is level triggered, e.g. after the device was unplugged
+                    // stop waiting on the device instead of spinning through epoll_wait
+                    // a removal is reported by the udev monitor
+                    libtcam::logger()->error(
+                        "Device reports an error. No further images will be received.");
+                    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, m_fd, nullptr);
+                }
+                else
+                {
+                    lost_countdown--;
+                }
+                waiting_period_ms = m_stream_timeout_sec * 1000;
             }
-            waiting_period = m_stream_timeout_sec;
         }
-        if (lost_countdown <= 0 && log_repetition_counter < log_repetition)
+        report_missing_images(lost_countdown, log_repetition_counter);
+    }
+}
+
+
+void V4l2Device::report_missing_images(int& lost_countdown, int& log_repetition_counter)
+{
+    static const int log_repetition = 10;
+
+    if (lost_countdown <= 0 && log_repetition_counter < log_repetition)
+    {
+        libtcam::logger()->warn("Did not receive image for long time.");
+        lost_countdown = lost_countdown_default;
+        if (log_repetition_counter < log_repetition)
+        {
+            log_repetition_counter++;
+        }
+        if (log_repetition_counter >= log_repetition)
         {
-            libtcam::logger()->warn("Did not receive image for long time.");
-            lost_countdown = lost_countdown_default;
-            if (log_repetition_counter < log_repetition)
-            {
-                log_repetition_counter++;
-            }
-            if (log_repetition_counter >= log_repetition)
+            libtcam::logger()->warn("Stopping messages \"Did not receive image for long time.\".");
+        }
+    }
+}
+
+
+bool V4l2Device::start_reactor_stream()
+{
+    m_already_received_valid_image = false;
+    m_lost_countdown = lost_countdown_default;
+    m_log_repetition_counter = 0;
+
+    m_delivery_queue = m_reactor->create_delivery_queue();
+
+    if (!m_reactor->add_fd(
+            m_fd,
+            EPOLLIN | EPOLLPRI,
+            [this](uint32_t events)
             {
-                libtcam::logger()->warn("Stopping messages \"Did not receive image for long time.\".");
-            }
+                if (events & EPOLLPRI)
+                {
+                    p_property_backend->handle_events();
+                }
+                if (events & ~EPOLLPRI)
+                {
+                    on_stream_event(events);
+                }
+            },
+            [this]() { on_stream_timeout(); },
+            [this]() { return m_stream_timeout_sec * 1000; }))
+    {
+        m_delivery_queue.reset();
+        return false;
+    }
+
+    libtcam::logger()->info("Starting stream in shared v4l2 reactor.");
+
+    return true;
+}
+
+
+// reactor thread, the device has done buffers or is in an error state
+void V4l2Device::on_stream_event(uint32_t events)
+{
+    // at high frame rates several buffers may be done,
+    // take all of them before waiting again
+    int received = 0;
+    std::shared_ptr<ImageBuffer> b;
+    while (m_is_stream_on && dequeue_frame(b))
+    {
+        received++;
+        if (b)
+        {
+            // stop_stream cancels the queue, the buffer has to go back to the driver
+            m_delivery_queue->post([this, b]() { deliver_frame(b); },
+                                   [this, b]() { requeue_buffer(b); });
         }
     }
+
+    if (received > 0)
+    {
+        m_lost_countdown = lost_countdown_default;
+        m_log_repetition_counter = 0;
+    }
+    else if (events & (EPOLLERR | EPOLLHUP))
+    {
+        // the error is level triggered, e.g. after the device was unplugged
+        // without removing the fd the reactor would call us in a busy loop
+        // a removal is reported through the device lost watch
+        libtcam::logger()->error("Device reports an error. No further images will be received.");
+        m_reactor->remove_fd(m_fd);
+        return;
+    }
+    else
+    {
+        m_lost_countdown--;
+    }
+    report_missing_images(m_lost_countdown, m_log_repetition_counter);
+}
+
+
+// reactor thread, no buffer was done within m_stream_timeout_sec
+void V4l2Device::on_stream_timeout()
+{
+    if (!m_is_stream_on || is_trigger_mode_enabled())
+    {
+        return;
+    }
+
+    libtcam::logger()->error("Timeout while waiting for new image buffer.");
+    m_statistics.frames_dropped++;
+    if (metrics_)
+    {
+        metrics_->count_drop(drop_cause::other);
+    }
+    m_lost_countdown--;
+    report_missing_images(m_lost_countdown, m_log_repetition_counter);
+}
+
+
+bool V4l2Device::create_stream_events()
+{
+    std::scoped_lock lck(m_buffers_mtx);
+
+    m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epoll_fd == -1)
+    {
+        libtcam::logger()->error("Unable to create epoll instance. errno: {} ({})", errno, strerror(errno));
+        return false;
+    }
+
+    m_stream_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stream_event_fd == -1)
+    {
+        libtcam::logger()->error("Unable to create eventfd. errno: {} ({})", errno, strerror(errno));
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+        return false;
+    }
+
+    epoll_event ev = {};
+    // EPOLLPRI signals subscribed control events
+    ev.events = EPOLLIN | EPOLLPRI;
+    ev.data.fd = m_fd;
+    int ret_dev = epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_fd, &ev);
+
+    ev.events = EPOLLIN;
+    ev.data.fd = m_stream_event_fd;
+    int ret_event = epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, m_stream_event_fd, &ev);
+
+    if (ret_dev == -1 || ret_event == -1)
+    {
+        libtcam::logger()->error("Unable to register stream events. errno: {} ({})", errno, strerror(errno));
+        close(m_stream_event_fd);
+        close(m_epoll_fd);
+        m_stream_event_fd = -1;
+        m_epoll_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+
+void V4l2Device::close_stream_events()
+{
+    std::scoped_lock lck(m_buffers_mtx);
+
+    if (m_stream_event_fd != -1)
+    {
+        close(m_stream_event_fd);
+        m_stream_event_fd = -1;
+    }
+    if (m_epoll_fd != -1)
+    {
+        close(m_epoll_fd);
+        m_epoll_fd = -1;
+    }
+}
+
+
+// caller has to hold m_buffers_mtx or be the thread that calls close_stream_events
+void V4l2Device::signal_stream_event()
+{
+    if (m_stream_event_fd != -1)
+    {
+        uint64_t one = 1;
+        [[maybe_unused]] auto r = write(m_stream_event_fd, &one, sizeof(one));
+    }
 }
 
 
@@ -1301,29 +1789,56 @@ bool V4l2Device::is_trigger_mode_enabled()
 
 bool V4l2Device::get_frame()
 {
-    struct v4l2_buffer buf = {};
-
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-
-    if (pool_->get_memory_type() == TCAM_MEMORY_TYPE_USERPTR)
+    std::shared_ptr<ImageBuffer> b;
+    if (!dequeue_frame(b))
     {
-        buf.memory = V4L2_MEMORY_USERPTR;
+        return false;
     }
-    else
+    if (!b)
     {
-        buf.memory = V4L2_MEMORY_MMAP;
+        // dropped, there may be more
+        return true;
     }
+    return deliver_frame(b);
+}
+
+
+bool V4l2Device::dequeue_frame(std::shared_ptr<ImageBuffer>& b)
+{
+    b.reset();
+
+    struct v4l2_buffer buf = {};
+
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = to_v4l2_memory(pool_->get_memory_type());
+
     int ret = tcam_xioctl(m_fd, VIDIOC_DQBUF, &buf);
 
     if (ret == -1)
     {
-        libtcam::logger()->trace("Unable to dequeue buffer.");
+        // EAGAIN: all done buffers have been taken
+        if (errno != EAGAIN)
+        {
+            libtcam::logger()->trace("Unable to dequeue buffer.");
+        }
         return false;
     }
 
-    auto& image_buffer = m_buffers.at(buf.index);
+    const uint64_t dequeue_time_ns = get_monotonic_time_ns();
 
-    image_buffer.is_queued = false;
+    check_sequence(buf.sequence);
+
+    size_t queued_count = 0;
+    {
+        std::scoped_lock lck(m_buffers_mtx);
+
+        auto& image_buffer = m_buffers.at(buf.index);
+        image_buffer.is_queued = false;
+        b = image_buffer.buffer;
+
+        queued_count = std::count_if(
+            m_buffers.begin(), m_buffers.end(), [](const auto& info) { return info.is_queued; });
+    }
 
     // buf.bytesused
     /* The number of bytes occupied by the data in the buffer. It depends on
@@ -1340,14 +1855,23 @@ bool V4l2Device::get_frame()
     {
         if (buf.bytesused != (this->m_active_video_format.get_required_buffer_size()))
         {
+            // the empty buffers of the stream start are no frames
             if (m_already_received_valid_image)
             {
                 libtcam::logger()->error("Buffer has wrong size. Got: {} Expected: {} Dropping...",
                              buf.bytesused,
                              this->m_active_video_format.get_required_buffer_size());
+                m_statistics.frames_dropped++;
+                m_statistics.frames_dropped_size_mismatch++;
+                m_statistics.sequence_gap = true;
+                if (metrics_)
+                {
+                    metrics_->count_drop(drop_cause::size_mismatch);
+                }
             }
             //libtcam::logger()->error("error requeue");
-            requeue_buffer(image_buffer.buffer.lock());
+            requeue_buffer(b);
+            b.reset();
             return true;
         }
     }
@@ -1357,10 +1881,47 @@ bool V4l2Device::get_frame()
     m_statistics.capture_time_ns =
         ((long long)buf.timestamp.tv_sec * 1000 * 1000 * 1000) + (buf.timestamp.tv_usec * 1000);
     m_statistics.frame_count++;
-    auto b = image_buffer.buffer.lock();
+    m_statistics.dequeue_time_ns = dequeue_time_ns;
+
+    if (metrics_)
+    {
+        const size_t active_count = pool_->get_active_count();
+        metrics_->record_buffers_in_flight(
+            active_count > queued_count ? active_count - queued_count : 0);
+    }
+
+    switch (pool_->update_queue_level(queued_count))
+    {
+        case BufferPool::action::grow:
+        {
+            grow_buffer_pool();
+            break;
+        }
+        case BufferPool::action::shrink:
+        {
+            std::scoped_lock lck(m_buffers_mtx);
+            m_shrink_pending = true;
+            break;
+        }
+        case BufferPool::action::none:
+        {
+            break;
+        }
+    }
+    pool_->fill_statistics(m_statistics);
+
     b->set_statistics(m_statistics);
     b->set_valid_data_length(buf.bytesused);
 
+    // only flag the first buffer after a gap
+    m_statistics.sequence_gap = false;
+
+    return true;
+}
+
+
+bool V4l2Device::deliver_frame(const std::shared_ptr<ImageBuffer>& b)
+{
     //libtcam::logger()->info("pushing new buffer");
 
     if (auto ptr = m_listener.lock())
@@ -1377,6 +1938,89 @@ bool V4l2Device::get_frame()
 }
 
 
+void V4l2Device::check_sequence(uint32_t sequence)
+{
+    if (!m_has_sequence)
+    {
+        m_has_sequence = true;
+        m_last_sequence = sequence;
+        return;
+    }
+
+    // unsigned arithmetic handles the wrap around
+    const uint32_t diff = sequence - m_last_sequence;
+    m_last_sequence = sequence;
+
+    // 0 or 'negative' means the driver restarted counting
+    if (diff <= 1 || diff > UINT32_MAX / 2)
+    {
+        return;
+    }
+
+    const uint32_t lost = diff - 1;
+
+    libtcam::logger()->debug("Driver dropped {} frame(s) before sequence {}", lost, sequence);
+
+    m_statistics.frames_dropped += lost;
+    m_statistics.sequence_gap = true;
+
+    if (metrics_)
+    {
+        metrics_->count_drop(drop_cause::driver, lost);
+    }
+}
+
+
+void V4l2Device::grow_buffer_pool()
+{
+    auto res = pool_->grow();
+    if (!res)
+    {
+        return;
+    }
+
+    auto buffer = res.value();
+    const unsigned int index = buffer->get_pool_index();
+
+    std::scoped_lock lck(m_buffers_mtx);
+
+    if (index == m_buffers.size())
+    {
+        // new slot, the driver has to know about it before it can be queued
+        struct v4l2_create_buffers create = {};
+
+        create.count = 1;
+        create.memory = V4L2_MEMORY_USERPTR;
+        create.format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+        if (tcam_xioctl(m_fd, VIDIOC_G_FMT, &create.format) == -1
+            || tcam_xioctl(m_fd, VIDIOC_CREATE_BUFS, &create) == -1 || create.index != index)
+        {
+            libtcam::logger()->warn("Unable to add buffer via VIDIOC_CREATE_BUFS: {}. "
+                                    "Disabling buffer pool growth.",
+                                    strerror(errno));
+            (void)pool_->shrink(buffer);
+            pool_->set_max_count(0);
+            return;
+        }
+
+        m_buffers.push_back({ buffer, false });
+    }
+    else if (index > m_buffers.size() || m_buffers.at(index).buffer != buffer)
+    {
+        libtcam::logger()->error("Buffer pool and stream are out of sync.");
+        return;
+    }
+
+    if (queue_userptr(index, buffer))
+    {
+        m_buffers.at(index).is_queued = true;
+    }
+
+    libtcam::logger()->debug("Buffer pool grew to {} buffers.", pool_->get_active_count());
+}
+
+
 void V4l2Device::init_userptr_buffers()
 {
     struct v4l2_requestbuffers req = {};
@@ -1406,7 +2050,7 @@ void V4l2Device::init_userptr_buffers()
         buf.memory = V4L2_MEMORY_USERPTR;
         buf.index = i;
 
-        auto b = m_buffers.at(i).buffer.lock();
+        auto& b = m_buffers.at(i).buffer;
 
         buf.m.userptr = (unsigned long)b->get_image_buffer_ptr();
         buf.length = b->get_image_buffer_size();
@@ -1461,7 +2105,7 @@ void V4l2Device::init_mmap_buffers()
 
     for (unsigned int i = 0; i < m_buffers.size(); ++i)
     {
-        if (queue_mmap(i, m_buffers.at(i).buffer.lock()))
+        if (queue_mmap(i, m_buffers.at(i).buffer))
         {
             m_buffers.at(i).is_queued = true;
         }
@@ -1469,25 +2113,49 @@ void V4l2Device::init_mmap_buffers()
 }
 
 
-void V4l2Device::init_dma_buffers()
+bool V4l2Device::init_dma_buffers()
 {
-    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    // dmabuf import has no allocation step in V4L2Allocator
+    // the driver only needs to know how many slots to reserve
+    struct v4l2_requestbuffers req = {};
+
+    req.count = m_buffers.size();
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_DMABUF;
+
+    if (tcam_xioctl(m_fd, VIDIOC_REQBUFS, &req) == -1)
     {
-        struct v4l2_buffer buf = {};
+        libtcam::logger()->error("VIDIOC_REQBUFS for dma import failed: {}", strerror(errno));
+        return false;
+    }
 
-        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        buf.memory = V4L2_MEMORY_DMABUF;
-        buf.index = i;
-        // TODO: pass dma fd
-        // buf.m.fd = dmafd;
+    if (req.count < m_buffers.size())
+    {
+        libtcam::logger()->error(
+            "Driver only accepts {} of {} dma buffers", req.count, m_buffers.size());
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_buffers.size(); ++i)
+    {
+        auto& b = m_buffers.at(i).buffer;
 
-        if (tcam_xioctl(m_fd, VIDIOC_QBUF, &buf) == -1)
+        if (b->get_file_descriptor() < 0)
         {
-            perror("VIDIOC_QBUF");
-            return;
+            libtcam::logger()->error("Buffer {} has no dma file descriptor", i);
+            return false;
         }
 
+        if (queue_dma(i, b))
+        {
+            m_buffers.at(i).is_queued = true;
+        }
+        else
+        {
+            return false;
+        }
     }
+    return true;
 }
 
 
@@ -1508,7 +2176,7 @@ tcam_image_size V4l2Device::get_sensor_size() const
 
 void V4l2Device::monitor_v4l2_thread_func()
 {
-    tcam::set_thread_name( "tcam_v4l2_mon" );
+    tcam::apply_thread_policy(tcam::thread_role::housekeeping, "tcam_v4l2_mon");
     auto udev = udev_new();
     if (!udev)
     {
@@ -23,10 +23,13 @@
 #include "../BufferPool.h"
 #include "V4L2PropertyBackend.h"
 #include "V4L2Allocator.h"
+#include "V4L2Reactor.h"
+#include "v4l2_format_cache.h"
 
 #include <atomic>
 #include <condition_variable> // std::condition_variable
 #include <linux/videodev2.h>
+#include <map>
 #include <memory>
 #include <mutex> // std::mutex, std::unique_lock
 #include <thread>
@@ -76,6 +79,10 @@ public:
 
     bool release_buffers() override;
 
+    void begin_property_batch() final;
+    outcome::result<void> commit_property_batch(
+        std::vector<tcam::property::batch_write_failure>& failed) final;
+
     void requeue_buffer(const std::shared_ptr<ImageBuffer>&) final;
 
     bool start_stream(const std::shared_ptr<IImageBufferSink>&) final;
@@ -87,6 +94,30 @@ private:
 
     std::thread m_work_thread;
 
+    // the stream thread waits on m_fd and m_stream_event_fd
+    // m_stream_event_fd wakes it for stop and for requeued buffers
+    // both only exist while streaming, guarded by m_buffers_mtx
+    int m_epoll_fd = -1;
+    int m_stream_event_fd = -1;
+
+    bool create_stream_events();
+    void close_stream_events();
+    void signal_stream_event();
+
+    // set when the process wide reactor is enabled
+    // the reactor then replaces m_work_thread and m_monitor_v4l2_thread
+    std::shared_ptr<tcam::v4l2::V4L2Reactor> m_reactor;
+    std::shared_ptr<tcam::v4l2::V4L2Reactor::delivery_queue> m_delivery_queue;
+    bool m_reactor_watches_device = false;
+
+    // equivalent of the stream() locals when the reactor drives the stream
+    int m_lost_countdown = 0;
+    int m_log_repetition_counter = 0;
+
+    bool start_reactor_stream();
+    void on_stream_event(uint32_t events);
+    void on_stream_timeout();
+
     int m_fd = -1;
 
     VideoFormat m_active_video_format;
@@ -154,7 +185,9 @@ private:
      */
     void index_formats();
 
-    std::vector<double> index_framerates(const struct v4l2_frmsizeenum& frms);
+    // raw enumeration of the device, used when no cached result is available
+    std::vector<tcam::v4l2::cached_format> enumerate_formats();
+    std::vector<v4l2_fract> index_framerates(const struct v4l2_frmsizeenum& frms);
 
     void determine_active_video_format();
 
@@ -168,6 +201,11 @@ private:
 
     std::shared_ptr<tcam::v4l2::V4L2PropertyBackend> p_property_backend;
 
+    // v4l2 control id to name of the public property, for change notifications
+    std::map<uint32_t, std::string> m_control_names;
+
+    void on_control_changed(uint32_t v4l2_id);
+
     // streaming related
 
     // on initial startup all buffers are received once, but empty
@@ -177,17 +215,31 @@ private:
 
     tcam_stream_statistics m_statistics = {};
 
+    // v4l2_buffer.sequence of the previous dequeued buffer
+    // gaps are frames the driver dropped
+    bool m_has_sequence = false;
+    uint32_t m_last_sequence = 0;
+
+    void check_sequence(uint32_t sequence);
+
     std::shared_ptr<BufferPool> pool_;
 
+    // m_buffers is indexed by ImageBuffer::get_pool_index()
+    // which is identical to the v4l2_buffer.index
     struct buffer_info
     {
-        std::weak_ptr<ImageBuffer> buffer;
+        std::shared_ptr<ImageBuffer> buffer;
         bool is_queued = false;
     };
 
     std::atomic<int> m_stream_timeout_sec { 10 };
 
     std::vector<buffer_info> m_buffers;
+    // requeue_buffer is called from outside the stream thread
+    // and the stream thread may add buffers when the pool grows
+    std::mutex m_buffers_mtx;
+    // the pool requested that the next requeued buffer is released
+    bool m_shrink_pending = false;
 
     std::weak_ptr<IImageBufferSink> m_listener;
 
@@ -197,13 +249,23 @@ private:
 
     bool get_frame();
 
+    // returns false when no buffer could be dequeued
+    // b is nullptr when the dequeued buffer was dropped
+    bool dequeue_frame(std::shared_ptr<ImageBuffer>& b);
+    bool deliver_frame(const std::shared_ptr<ImageBuffer>& b);
+
+    void report_missing_images(int& lost_countdown, int& log_repetition_counter);
+
+    // add a buffer to the running stream, userptr only
+    void grow_buffer_pool();
+
     void init_userptr_buffers();
     void init_mmap_buffers();
-    void init_dma_buffers();
+    bool init_dma_buffers();
 
-    bool queue_dma(int i, std::shared_ptr<ImageBuffer>);
-    bool queue_mmap(int i, std::shared_ptr<ImageBuffer>);
-    bool queue_userptr(int i, std::shared_ptr<ImageBuffer>);
+    bool queue_dma(int i, const std::shared_ptr<ImageBuffer>&);
+    bool queue_mmap(int i, const std::shared_ptr<ImageBuffer>&);
+    bool queue_userptr(int i, const std::shared_ptr<ImageBuffer>&);
 
     bool is_trigger_mode_enabled();
 
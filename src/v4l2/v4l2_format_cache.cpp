@@ -0,0 +1,310 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "v4l2_format_cache.h"
+
+#include "../cache_file.h"
+#include "../logging.h"
+#include "../utils.h"
+
+#include <cstdio>
+#include <libudev.h>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace
+{
+
+// increase when the file layout or the meaning of its content changes
+const int cache_file_version = 1;
+const char* cache_file_magic = "tcam-v4l2-format-cache";
+const char* cache_file_prefix = "v4l2-formats";
+
+
+// keys and descriptions are stored as rest of a line
+std::string sanitize(std::string str)
+{
+    for (auto& c : str)
+    {
+        if (c == '\n' || c == '\r')
+        {
+            c = ' ';
+        }
+    }
+    return str;
+}
+
+
+// cheap check that the device still reports what was cached
+// a different driver behavior or a reflashed camera with the same
+// firmware string would otherwise go unnoticed
+bool device_matches(int fd, const tcam::v4l2::format_cache_data& data)
+{
+    v4l2_fmtdesc fmtdesc = {};
+    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    fmtdesc.index = 0;
+    if (tcam::tcam_xioctl(fd, VIDIOC_ENUM_FMT, &fmtdesc) != 0
+        || fmtdesc.pixelformat != data.formats.front().pixelformat)
+    {
+        return false;
+    }
+
+    fmtdesc.index = data.formats.size() - 1;
+    if (tcam::tcam_xioctl(fd, VIDIOC_ENUM_FMT, &fmtdesc) != 0
+        || fmtdesc.pixelformat != data.formats.back().pixelformat)
+    {
+        return false;
+    }
+
+    // no additional formats
+    fmtdesc.index = data.formats.size();
+    return tcam::tcam_xioctl(fd, VIDIOC_ENUM_FMT, &fmtdesc) != 0;
+}
+
+
+std::string serialize(const std::string& key, const tcam::v4l2::format_cache_data& data)
+{
+    std::ostringstream out;
+
+    out << cache_file_magic << " " << cache_file_version << "\n";
+    out << "key " << sanitize(key) << "\n";
+
+    for (const auto& s : data.scales)
+    {
+        out << "scale " << s.binning_h << " " << s.binning_v << " " << s.skipping_h << " "
+            << s.skipping_v << "\n";
+    }
+
+    for (const auto& o : data.override_index)
+    {
+        out << "override " << o.override_value << " " << o.scales_index << "\n";
+    }
+
+    for (const auto& fmt : data.formats)
+    {
+        out << "format " << fmt.pixelformat << " " << sanitize(fmt.description) << "\n";
+
+        for (const auto& size : fmt.sizes)
+        {
+            out << "size " << size.width << " " << size.height;
+            for (const auto& i : size.intervals)
+            {
+                out << " " << i.numerator << "/" << i.denominator;
+            }
+            out << "\n";
+        }
+    }
+
+    return out.str();
+}
+
+
+bool deserialize(const std::string& content,
+                 const std::string& key,
+                 tcam::v4l2::format_cache_data& data)
+{
+    std::istringstream in(content);
+    std::string line;
+
+    if (!std::getline(in, line)
+        || line != std::string(cache_file_magic) + " " + std::to_string(cache_file_version))
+    {
+        return false;
+    }
+
+    if (!std::getline(in, line) || line != "key " + sanitize(key))
+    {
+        return false;
+    }
+
+    while (std::getline(in, line))
+    {
+        std::istringstream l(line);
+        std::string type;
+        l >> type;
+
+        if (type == "scale")
+        {
+            tcam::image_scaling s = {};
+            if (!(l >> s.binning_h >> s.binning_v >> s.skipping_h >> s.skipping_v))
+            {
+                return false;
+            }
+            data.scales.push_back(s);
+        }
+        else if (type == "override")
+        {
+            tcam::v4l2::cached_override_mapping o = {};
+            if (!(l >> o.override_value >> o.scales_index) || o.scales_index < 0
+                || o.scales_index >= (int)data.scales.size())
+            {
+                return false;
+            }
+            data.override_index.push_back(o);
+        }
+        else if (type == "format")
+        {
+            tcam::v4l2::cached_format fmt = {};
+            if (!(l >> fmt.pixelformat))
+            {
+                return false;
+            }
+            l.get();
+            std::getline(l, fmt.description);
+            data.formats.push_back(std::move(fmt));
+        }
+        else if (type == "size")
+        {
+            tcam::v4l2::cached_frame_size size = {};
+            if (data.formats.empty() || !(l >> size.width >> size.height))
+            {
+                return false;
+            }
+
+            std::string frac;
+            while (l >> frac)
+            {
+                v4l2_fract f = {};
+                if (sscanf(frac.c_str(), "%u/%u", &f.numerator, &f.denominator) != 2
+                    || f.numerator == 0 || f.denominator == 0)
+                {
+                    return false;
+                }
+                size.intervals.push_back(f);
+            }
+            data.formats.back().sizes.push_back(std::move(size));
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return !data.formats.empty();
+}
+
+} // namespace
+
+
+std::string tcam::v4l2::format_cache_key(int fd, const std::string& extension_file)
+{
+    v4l2_capability cap = {};
+    if (tcam_xioctl(fd, VIDIOC_QUERYCAP, &cap) != 0)
+    {
+        return {};
+    }
+
+    struct stat st = {};
+    if (fstat(fd, &st) != 0)
+    {
+        return {};
+    }
+
+    auto udev = udev_new();
+    if (!udev)
+    {
+        return {};
+    }
+
+    std::string key;
+
+    auto dev = udev_device_new_from_devnum(udev, 'c', st.st_rdev);
+    if (dev)
+    {
+        auto usb_dev = udev_device_get_parent_with_subsystem_devtype(dev, "usb", "usb_device");
+
+        auto attr = [usb_dev](const char* name) -> std::string
+        {
+            const char* value = udev_device_get_sysattr_value(usb_dev, name);
+            return value ? value : "";
+        };
+
+        // model and firmware
+        // bcdDevice is the firmware version of TIS usb cameras
+        if (usb_dev && !attr("idProduct").empty() && !attr("bcdDevice").empty())
+        {
+            key = attr("idVendor") + ":" + attr("idProduct") + " fw " + attr("bcdDevice") + " "
+                  + attr("product") + " driver " + (const char*)cap.driver + " "
+                  + std::to_string(cap.version);
+        }
+        udev_device_unref(dev);
+    }
+    udev_unref(udev);
+
+    if (key.empty())
+    {
+        return {};
+    }
+
+    // the extension unit defines which scanning mode controls exist
+    struct stat ext_st = {};
+    if (!extension_file.empty() && stat(extension_file.c_str(), &ext_st) == 0)
+    {
+        key += " extension " + extension_file + " " + std::to_string(ext_st.st_size) + " "
+               + std::to_string(ext_st.st_mtime);
+    }
+    else
+    {
+        key += " extension none";
+    }
+
+    return key;
+}
+
+
+bool tcam::v4l2::load_format_cache(const std::string& key, int fd, format_cache_data& data)
+{
+    auto file_name = get_cache_file_name(cache_file_prefix, key);
+    if (file_name.empty())
+    {
+        return false;
+    }
+
+    std::string content;
+    if (!load_cache_file(file_name, content))
+    {
+        return false;
+    }
+
+    format_cache_data tmp;
+    if (!deserialize(content, key, tmp))
+    {
+        libtcam::logger()->warn("Ignoring invalid format cache {}", file_name);
+        return false;
+    }
+
+    if (!device_matches(fd, tmp))
+    {
+        libtcam::logger()->info("Format cache {} does not match the device. Enumerating formats.",
+                                file_name);
+        return false;
+    }
+
+    data = std::move(tmp);
+    return true;
+}
+
+
+void tcam::v4l2::store_format_cache(const std::string& key, const format_cache_data& data)
+{
+    if (data.formats.empty())
+    {
+        return;
+    }
+
+    store_cache_file(get_cache_file_name(cache_file_prefix, key), serialize(key, data));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include "../base_types.h"
+#include "../compiler_defines.h"
+
+#include <cstdint>
+#include <linux/videodev2.h>
+#include <string>
+#include <vector>
+
+VISIBILITY_INTERNAL
+
+namespace tcam::v4l2
+{
+
+struct cached_frame_size
+{
+    uint32_t width;
+    uint32_t height;
+    // as reported by VIDIOC_ENUM_FRAMEINTERVALS, seconds per frame
+    std::vector<v4l2_fract> intervals;
+};
+
+struct cached_format
+{
+    // as reported by VIDIOC_ENUM_FMT, before any corrections
+    uint32_t pixelformat;
+    std::string description;
+
+    std::vector<cached_frame_size> sizes;
+};
+
+struct cached_override_mapping
+{
+    int override_value;
+    int scales_index;
+};
+
+struct format_cache_data
+{
+    std::vector<cached_format> formats;
+
+    // result of probing the binning/skipping capabilities
+    std::vector<image_scaling> scales;
+    std::vector<cached_override_mapping> override_index;
+};
+
+//
+// Persistent cache of the format enumeration of v4l2 devices
+//
+// Enumerating all formats, frame sizes and frame intervals and probing
+// the scanning modes takes a considerable amount of time on every open.
+// The results only depend on the camera model, its firmware, the driver
+// and the uvc extension unit, so they are stored under
+// $XDG_CACHE_HOME/tiscamera/ and reused by all devices that share these.
+//
+// Set TCAM_DISABLE_FORMAT_CACHE to always enumerate the device.
+//
+
+// fd - opened device
+// extension_file - uvc extension description that is used for the device, may be empty
+// returns an empty string when the device cannot be identified,
+// caching is not possible in that case
+std::string format_cache_key(int fd, const std::string& extension_file);
+
+// returns false when no valid entry for key exists or the entry does not
+// match the formats the device at fd currently reports
+bool load_format_cache(const std::string& key, int fd, format_cache_data& data);
+
+// failures are logged and otherwise ignored
+void store_format_cache(const std::string& key, const format_cache_data& data);
+
+} // namespace tcam::v4l2
+
+VISIBILITY_POP
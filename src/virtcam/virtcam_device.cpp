@@ -16,6 +16,7 @@
 
 #include "virtcam_device.h"
 
+#include "../ThreadPolicy.h"
 #include "../logging.h"
 #include "../utils.h"
 #include "dutils_img/image_fourcc.h"
@@ -135,8 +136,6 @@ bool tcam::virtcam::VirtcamDevice::start_stream(const std::shared_ptr<IImageBuff
     stream_thread_ended_ = false;
     stream_thread_ = std::thread([this] { stream_thread_main(); });
 
-    start_time_ = std::chrono::high_resolution_clock::now();
-
     return true;
 }
 
@@ -163,6 +162,8 @@ void tcam::virtcam::VirtcamDevice::trigger_device_lost ()
 
 void tcam::virtcam::VirtcamDevice::stream_thread_main()
 {
+    tcam::apply_thread_policy(tcam::thread_role::capture, "tcam_virt_strm");
+
     const int64_t timeout_in_us = 1'000'000 / active_video_format_.get_framerate();
 
     const auto send_interval = std::chrono::microseconds(timeout_in_us);
@@ -218,8 +219,10 @@ void tcam::virtcam::VirtcamDevice::stream_thread_main()
                 stats.frame_count = frames_delivered_;
                 stats.frames_dropped = frames_dropped_;
 
-                auto end = std::chrono::high_resolution_clock::now();
-                stats.capture_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_time_).count();
+                // CLOCK_MONOTONIC, like v4l2 buffer timestamps
+                stats.capture_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            std::chrono::steady_clock::now().time_since_epoch())
+                                            .count();
 
                 buf->set_statistics(stats);
                 buf->set_valid_data_length(buf->get_image_buffer_size());
@@ -89,7 +89,6 @@ private:
 
     int frames_dropped_ = 0;
     int frames_delivered_ = 0;
-    std::chrono::time_point<std::chrono::high_resolution_clock> start_time_;
 
     VideoFormat active_video_format_;
 
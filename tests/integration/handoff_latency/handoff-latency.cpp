@@ -0,0 +1,199 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures how regularly buffers leave the tcammainsrc src pad
+ * and how much CPU time the process needs per frame.
+ *
+ * Only pad probe timestamps and getrusage are used, so the same
+ * binary can measure builds before and after a change to the handoff.
+ * virtcam delivers images at the framerate of the caps.
+ * Every wake up and lock on the way to the src pad shows up as
+ * deviation from that interval.
+ */
+
+#include <CLI11.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <gst/gst.h>
+#include <sys/resource.h>
+#include <vector>
+
+struct latency_data
+{
+    unsigned int skip = 0;
+    uint64_t last_ns = 0;
+    std::vector<uint64_t> intervals_ns;
+};
+
+
+static uint64_t monotonic_now_ns()
+{
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+
+static uint64_t process_cpu_time_ns()
+{
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+
+    auto to_ns = [](const timeval& tv)
+    {
+        return (uint64_t)tv.tv_sec * 1000 * 1000 * 1000 + (uint64_t)tv.tv_usec * 1000;
+    };
+    return to_ns(usage.ru_utime) + to_ns(usage.ru_stime);
+}
+
+
+static GstPadProbeReturn buffer_probe(GstPad* /*pad*/, GstPadProbeInfo* /*info*/, gpointer user_data)
+{
+    const uint64_t now = monotonic_now_ns();
+
+    auto data = static_cast<latency_data*>(user_data);
+
+    // the first frames include stream start up
+    if (data->skip > 0)
+    {
+        data->skip--;
+        data->last_ns = now;
+        return GST_PAD_PROBE_OK;
+    }
+
+    data->intervals_ns.push_back(now - data->last_ns);
+    data->last_ns = now;
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+static double percentile_us(const std::vector<uint64_t>& sorted, double p)
+{
+    size_t index = std::min(sorted.size() - 1, (size_t)(p * sorted.size()));
+    return sorted.at(index) / 1000.0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    CLI::App app { "tcammainsrc buffer handoff latency" };
+
+    std::string serial;
+    app.add_option("-s,--serial", serial, "Serial number of the virtcam device that shall be used.");
+
+    std::string caps_str;
+    app.add_option("-c,--caps", caps_str, "GStreamer caps the device shall use.");
+
+    int frames = 3000;
+    app.add_option("-n,--frames", frames, "Number of frames to measure.")->capture_default_str();
+
+    unsigned int warmup = 30;
+    app.add_option("-w,--warmup", warmup, "Number of frames to ignore at stream start.")
+        ->capture_default_str();
+
+    // allow --gst-debug etc
+    app.allow_extras(true);
+
+    CLI11_PARSE(app, argc, argv);
+
+    gst_init(&argc, &argv);
+
+    std::string pipeline_str = "tcammainsrc name=source type=virtcam";
+    if (!serial.empty())
+    {
+        pipeline_str += " serial=" + serial;
+    }
+    pipeline_str += " num-buffers=" + std::to_string(frames + warmup);
+    if (!caps_str.empty())
+    {
+        pipeline_str += " ! " + caps_str;
+    }
+    pipeline_str += " ! fakesink sync=false";
+
+    GError* err = nullptr;
+    GstElement* pipeline = gst_parse_launch(pipeline_str.c_str(), &err);
+
+    if (!pipeline)
+    {
+        printf("Unable to create pipeline: %s\n", err ? err->message : "");
+        return 1;
+    }
+
+    latency_data data;
+    data.skip = warmup;
+    data.intervals_ns.reserve(frames);
+
+    GstElement* source = gst_bin_get_by_name(GST_BIN(pipeline), "source");
+    GstPad* pad = gst_element_get_static_pad(source, "src");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, &data, nullptr);
+    gst_object_unref(pad);
+    gst_object_unref(source);
+
+    const uint64_t cpu_start_ns = process_cpu_time_ns();
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+    GstBus* bus = gst_element_get_bus(pipeline);
+    GstMessage* msg = gst_bus_timed_pop_filtered(
+        bus, GST_CLOCK_TIME_NONE, (GstMessageType)(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+
+    int ret = 0;
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR)
+    {
+        GError* error = nullptr;
+        gst_message_parse_error(msg, &error, nullptr);
+        printf("Error while streaming: %s\n", error->message);
+        g_error_free(error);
+        ret = 1;
+    }
+
+    const uint64_t cpu_ns = process_cpu_time_ns() - cpu_start_ns;
+
+    gst_message_unref(msg);
+    gst_object_unref(bus);
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+
+    if (data.intervals_ns.size() < 2)
+    {
+        printf("Not enough frames.\n");
+        return 1;
+    }
+
+    uint64_t sum = 0;
+    for (auto s : data.intervals_ns) { sum += s; }
+    const uint64_t mean = sum / data.intervals_ns.size();
+
+    // deviation of each frame from the mean frame interval
+    std::vector<uint64_t> jitter_ns;
+    jitter_ns.reserve(data.intervals_ns.size());
+    for (auto s : data.intervals_ns) { jitter_ns.push_back(s > mean ? s - mean : mean - s); }
+    std::sort(jitter_ns.begin(), jitter_ns.end());
+
+    printf("frames:   %zu\n", data.intervals_ns.size());
+    printf("interval: %.1f us\n", mean / 1000.0);
+    printf("jitter p50: %.1f us\n", percentile_us(jitter_ns, 0.50));
+    printf("jitter p99: %.1f us\n", percentile_us(jitter_ns, 0.99));
+    printf("jitter max: %.1f us\n", jitter_ns.back() / 1000.0);
+    printf("cpu/frame:  %.1f us\n",
+           cpu_ns / 1000.0 / (data.intervals_ns.size() + warmup));
+
+    return ret;
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#define CATCH_CONFIG_MAIN
+
+#include <catch.hpp>
+
+#include "tcam-network/ActionCommand.h"
+#include "tcam-network/NetworkInterface.h"
+#include "tcam-network/gigevision.h"
+#include "tcam-network/utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace tis;
+
+namespace
+{
+
+//
+// Plays the GVCP part of cameras on 127.0.0.1
+// Records every received packet and acknowledges commands that request it
+//
+class responder
+{
+public:
+    // valid_acks - number of cameras that acknowledge a command
+    // additionally one ack with a wrong id and one with an error status are sent
+    explicit responder(int valid_acks = 0) : valid_acks_(valid_acks)
+    {
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        REQUIRE(fd_ >= 0);
+
+        int reuse = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        timeval timeout = { 0, 50'000 };
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        sockaddr_in addr = fillAddr("127.0.0.1", STANDARD_GVCP_PORT);
+        REQUIRE(bind(fd_, (sockaddr*)&addr, sizeof(addr)) == 0);
+
+        thread_ = std::thread(&responder::run, this);
+    }
+
+    ~responder()
+    {
+        stop_ = true;
+        thread_.join();
+        close(fd_);
+    }
+
+    // waits until count packets arrived
+    std::vector<std::vector<uint8_t>> wait_for(size_t count)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            {
+                std::scoped_lock lck(mtx_);
+                if (packets_.size() >= count)
+                {
+                    return packets_;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        std::scoped_lock lck(mtx_);
+        return packets_;
+    }
+
+private:
+    void run()
+    {
+        while (!stop_)
+        {
+            uint8_t buffer[1024];
+            sockaddr_in sender = {};
+            socklen_t sender_size = sizeof(sender);
+
+            ssize_t size =
+                recvfrom(fd_, buffer, sizeof(buffer), 0, (sockaddr*)&sender, &sender_size);
+            if (size <= 0)
+            {
+                continue;
+            }
+
+            {
+                std::scoped_lock lck(mtx_);
+                packets_.emplace_back(buffer, buffer + size);
+            }
+
+            auto header = (const Packet::COMMAND_HEADER*)buffer;
+            if (!(header->flag & Flags::NEEDACK))
+            {
+                continue;
+            }
+
+            auto send_ack = [&](unsigned short status, unsigned short ack_id)
+            {
+                Packet::ACK_ACTION ack = {};
+                ack.header.status = htons(status);
+                ack.header.answer = htons(Commands::ACTION_ACK);
+                ack.header.length = 0;
+                ack.header.ack_id = htons(ack_id);
+
+                sendto(fd_, &ack, sizeof(ack), 0, (sockaddr*)&sender, sender_size);
+            };
+
+            const unsigned short id = ntohs(header->req_id);
+
+            send_ack(Status::SUCCESS, id + 1);
+            send_ack(Status::ACCESS_DENIED, id);
+            for (int i = 0; i < valid_acks_; ++i) { send_ack(Status::SUCCESS, id); }
+        }
+    }
+
+    int fd_ = -1;
+    int valid_acks_;
+
+    std::atomic<bool> stop_ = false;
+    std::thread thread_;
+
+    std::mutex mtx_;
+    std::vector<std::vector<uint8_t>> packets_;
+};
+
+
+void require_action_packet(const std::vector<uint8_t>& packet, const ActionCommand& command)
+{
+    const bool is_scheduled = command.action_time != 0;
+    const size_t expected_size = is_scheduled ? sizeof(Packet::CMD_ACTION)
+                                              : sizeof(Packet::CMD_ACTION) - 8;
+
+    REQUIRE(packet.size() == expected_size);
+
+    Packet::CMD_ACTION cmd = {};
+    memcpy(&cmd, packet.data(), packet.size());
+
+    REQUIRE(cmd.header.magic == 0x42);
+    REQUIRE(ntohs(cmd.header.command) == Commands::ACTION_CMD);
+    REQUIRE(ntohs(cmd.header.length) == expected_size - sizeof(Packet::COMMAND_HEADER));
+    REQUIRE(ntohs(cmd.header.req_id) != 0);
+
+    REQUIRE(ntohl(cmd.device_key) == command.device_key);
+    REQUIRE(ntohl(cmd.group_key) == command.group_key);
+    REQUIRE(ntohl(cmd.group_mask) == command.group_mask);
+
+    REQUIRE(((cmd.header.flag & Flags::SCHEDULED_ACTION) != 0) == is_scheduled);
+    if (is_scheduled)
+    {
+        const uint64_t time =
+            ((uint64_t)ntohl(cmd.action_time_high) << 32) | ntohl(cmd.action_time_low);
+        REQUIRE(time == command.action_time);
+    }
+}
+
+
+const ActionCommand test_command = { 0x12345678, 0x1, 0x3, 0 };
+
+
+std::shared_ptr<NetworkInterface> loopback()
+{
+    sockaddr_in addr = fillAddr("127.0.0.1", 0);
+    sockaddr_in netmask = fillAddr("255.0.0.0", 0);
+
+    ifaddrs ifa = {};
+    ifa.ifa_name = (char*)"lo";
+    ifa.ifa_flags = IFF_UP | IFF_LOOPBACK | IFF_RUNNING;
+    ifa.ifa_addr = (sockaddr*)&addr;
+    ifa.ifa_netmask = (sockaddr*)&netmask;
+
+    // short timeout, the tests wait for missing acknowledges
+    return std::make_shared<NetworkInterface>(&ifa, 200);
+}
+
+
+std::shared_ptr<Camera> loopback_camera(const std::shared_ptr<NetworkInterface>& inf,
+                                        const std::string& serial)
+{
+    Packet::ACK_DISCOVERY discovery = {};
+    discovery.CurrentIP = ip2int("127.0.0.1");
+    strncpy(discovery.Serialnumber, serial.c_str(), sizeof(discovery.Serialnumber) - 1);
+
+    return std::make_shared<Camera>(discovery, inf);
+}
+
+} // namespace
+
+
+TEST_CASE("immediate action command", "[action_command]")
+{
+    responder cameras;
+
+    Socket socket(fillAddr("127.0.0.1", 0), 200);
+
+    REQUIRE(sendActionCommand(socket, "127.0.0.1", test_command) == 0);
+
+    auto packets = cameras.wait_for(1);
+    REQUIRE(packets.size() == 1);
+
+    require_action_packet(packets.at(0), test_command);
+    REQUIRE((packets.at(0).at(1) & Flags::NEEDACK) == 0);
+}
+
+
+TEST_CASE("scheduled action command", "[action_command]")
+{
+    responder cameras;
+
+    Socket socket(fillAddr("127.0.0.1", 0), 200);
+
+    ActionCommand command = test_command;
+    command.action_time = 0x0123456789abcdef;
+
+    REQUIRE(sendActionCommand(socket, "127.0.0.1", command) == 0);
+
+    auto packets = cameras.wait_for(1);
+    REQUIRE(packets.size() == 1);
+
+    require_action_packet(packets.at(0), command);
+}
+
+
+TEST_CASE("only matching acknowledges are counted", "[action_command]")
+{
+    responder cameras(2);
+
+    Socket socket(fillAddr("127.0.0.1", 0), 200);
+
+    REQUIRE(sendActionCommand(socket, "127.0.0.1", test_command, 2) == 2);
+
+    auto packets = cameras.wait_for(1);
+    REQUIRE(packets.size() == 1);
+    require_action_packet(packets.at(0), test_command);
+    REQUIRE((packets.at(0).at(1) & Flags::NEEDACK) != 0);
+
+    // a missing camera ends in a timeout
+    REQUIRE(sendActionCommand(socket, "127.0.0.1", test_command, 3) == 2);
+}
+
+
+TEST_CASE("failed sends are reported", "[action_command]")
+{
+    Socket socket(fillAddr("127.0.0.1", 0), 200);
+
+    // a socket bound to loopback cannot reach other networks
+    REQUIRE(sendActionCommand(socket, "192.0.2.1", test_command) == -1);
+}
+
+
+TEST_CASE("action group sends one command per interface", "[action_command]")
+{
+    auto inf = loopback();
+
+    ActionGroup group(test_command.device_key, test_command.group_key, test_command.group_mask);
+
+    // the cameras are configured via GenICam, no GVCP control is required
+    REQUIRE(group.addCamera(loopback_camera(inf, "00000001"), false));
+    REQUIRE(group.addCamera(loopback_camera(inf, "00000002"), false));
+    REQUIRE(group.getCameras().size() == 2);
+
+    SECTION("immediate")
+    {
+        responder cameras;
+
+        REQUIRE(group.fire() == 0);
+
+        auto packets = cameras.wait_for(1);
+        // give a duplicate the chance to arrive
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        packets = cameras.wait_for(1);
+
+        REQUIRE(packets.size() == 1);
+        require_action_packet(packets.at(0), test_command);
+    }
+
+    SECTION("scheduled with acknowledge")
+    {
+        responder cameras(2);
+
+        const uint64_t action_time = 1'000'000'000'000;
+        REQUIRE(group.fire(action_time, true) == 2);
+
+        ActionCommand command = test_command;
+        command.action_time = action_time;
+
+        auto packets = cameras.wait_for(1);
+        REQUIRE(packets.size() == 1);
+        require_action_packet(packets.at(0), command);
+    }
+
+    SECTION("removed cameras do not count")
+    {
+        responder cameras(1);
+
+        group.removeCamera("00000002");
+        REQUIRE(group.getCameras().size() == 1);
+
+        REQUIRE(group.fire(0, true) == 1);
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#define CATCH_CONFIG_MAIN
+
+#include <catch.hpp>
+
+#include "aravis/AravisBandwidthManager.h"
+
+using namespace tcam::aravis;
+
+namespace
+{
+
+// 1 Gbit/s
+constexpr uint64_t gigabit = 125'000'000;
+
+// 1920x1080 mono8 with jumbo frames
+const bandwidth_request full_hd = { 1920 * 1080, 30.0, 9000 };
+
+// bytes on the wire for one packet with GevSCPSPacketSize 9000
+constexpr double wire_size_9000 = 9000 + 38;
+
+// bytes per second a stream paced with delay_ns sends at most
+double paced_bandwidth(uint64_t delay_ns, double wire_size, uint64_t link_speed)
+{
+    double interval_ns = delay_ns;
+    if (link_speed > 0)
+    {
+        interval_ns += wire_size / link_speed * 1e9;
+    }
+    return wire_size / interval_ns * 1e9;
+}
+
+} // namespace
+
+
+TEST_CASE("required bandwidth", "[bandwidth]")
+{
+    // 8964 bytes of image data per packet, 232 data packets plus leader and trailer
+    REQUIRE(required_bandwidth(full_hd) == 234 * 9038 * 30);
+
+    // invalid configurations do not require anything
+    REQUIRE(required_bandwidth({ 1920 * 1080, 30.0, 0 }) == 0);
+    REQUIRE(required_bandwidth({ 1920 * 1080, 30.0, 36 }) == 0);
+    REQUIRE(required_bandwidth({ 1920 * 1080, 0.0, 9000 }) == 0);
+}
+
+
+TEST_CASE("streams below the budget keep their framerate", "[bandwidth]")
+{
+    const link_budget link = { gigabit * 9 / 10, gigabit };
+
+    // ~ 250 Mbit/s each
+    const bandwidth_request slow = { 1920 * 1080, 15.0, 9000 };
+    const std::vector<bandwidth_request> requests = { slow, slow };
+
+    REQUIRE(2 * required_bandwidth(slow) < link.budget);
+
+    auto delays = compute_packet_delays(link, requests);
+
+    REQUIRE(delays.size() == 2);
+    // identical streams receive the same share
+    REQUIRE(delays.at(0) == delays.at(1));
+    REQUIRE(delays.at(0) > 0);
+
+    for (auto delay : delays)
+    {
+        const double bandwidth = paced_bandwidth(delay, wire_size_9000, link.link_speed);
+
+        // paced to half the budget, which is more than the stream needs
+        REQUIRE(bandwidth == Approx(link.budget / 2.0).epsilon(0.001));
+        REQUIRE(bandwidth > required_bandwidth(slow));
+    }
+}
+
+
+TEST_CASE("streams above the budget are throttled to their share", "[bandwidth]")
+{
+    const link_budget link = { gigabit * 9 / 10, gigabit };
+
+    // 5 MP at 60 fps, requires ~ 2.4 Gbit/s
+    const bandwidth_request large = { 2448 * 2048, 60.0, 9000 };
+
+    const std::vector<bandwidth_request> requests = { full_hd, large };
+
+    auto delays = compute_packet_delays(link, requests);
+
+    REQUIRE(delays.size() == 2);
+
+    const double total = required_bandwidth(full_hd) + required_bandwidth(large);
+    REQUIRE(total > link.budget);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const double required = required_bandwidth(requests.at(i));
+        const double bandwidth = paced_bandwidth(delays.at(i), wire_size_9000, link.link_speed);
+
+        REQUIRE(bandwidth == Approx(link.budget * required / total).epsilon(0.001));
+        REQUIRE(bandwidth < required);
+
+        sum += bandwidth;
+    }
+
+    // together the streams stay within the budget
+    REQUIRE(sum == Approx(link.budget).epsilon(0.001));
+}
+
+
+TEST_CASE("no delays without a budget", "[bandwidth]")
+{
+    const std::vector<bandwidth_request> requests = { full_hd, full_hd };
+
+    auto delays = compute_packet_delays({ 0, gigabit }, requests);
+
+    REQUIRE(delays == std::vector<uint64_t> { 0, 0 });
+
+    // a stream that requires nothing is left alone
+    delays = compute_packet_delays({ gigabit / 2, gigabit }, { full_hd, { 1920 * 1080, 0.0, 9000 } });
+
+    REQUIRE(delays.at(0) > 0);
+    REQUIRE(delays.at(1) == 0);
+
+    REQUIRE(compute_packet_delays({ gigabit, gigabit }, {}).empty());
+}
+
+
+TEST_CASE("links without a speed use the whole interval as delay", "[bandwidth]")
+{
+    // lo reports no speed, the budget is set via TCAM_GIGE_LINK_BUDGET
+    const link_budget link = { gigabit, 0 };
+
+    auto delays = compute_packet_delays(link, { full_hd });
+
+    REQUIRE(delays.size() == 1);
+
+    // the time on the wire is unknown, the delay is the complete packet interval
+    const double expected_ns = wire_size_9000 / gigabit * 1e9;
+    REQUIRE(delays.at(0) == Approx(expected_ns).margin(1));
+
+    REQUIRE(paced_bandwidth(delays.at(0), wire_size_9000, link.link_speed)
+            == Approx(link.budget).epsilon(0.001));
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#define CATCH_CONFIG_MAIN
+
+#include <catch.hpp>
+
+#include "CameraClockEstimator.h"
+
+#include <cstdint>
+
+namespace
+{
+
+constexpr uint64_t sync_interval_ns = 1'000'000'000;
+constexpr uint64_t host_offset_ns = 1'600'000'000'000'000'000;
+// typical round trip of a latch command
+constexpr uint64_t round_trip_ns = 200'000;
+
+// host_ns - host time the camera latched its clock at
+void add(tcam::CameraClockEstimator& estimator,
+         uint64_t camera_ns,
+         uint64_t host_ns,
+         uint64_t round_trip = round_trip_ns)
+{
+    estimator.add_sample(camera_ns, host_ns - round_trip / 2, host_ns + round_trip / 2);
+}
+
+} // namespace
+
+
+TEST_CASE("no estimate without samples", "[clock_estimator]")
+{
+    tcam::CameraClockEstimator estimator;
+
+    REQUIRE(estimator.to_host_time(1'000) == 0);
+
+    // host time going backwards during a latch is not a usable sample
+    estimator.add_sample(1'000, 2'000, 1'000);
+    REQUIRE(estimator.to_host_time(1'000) == 0);
+
+    // the camera did not latch
+    estimator.add_sample(0, 1'000, 2'000);
+    REQUIRE(estimator.to_host_time(1'000) == 0);
+
+    add(estimator, 1'000, host_offset_ns);
+    REQUIRE(estimator.to_host_time(0) == 0);
+
+    estimator.reset();
+    REQUIRE(estimator.to_host_time(1'000) == 0);
+}
+
+
+TEST_CASE("the camera latched in the middle of the round trip", "[clock_estimator]")
+{
+    tcam::CameraClockEstimator estimator;
+
+    estimator.add_sample(1'000, host_offset_ns, host_offset_ns + 300'001);
+
+    REQUIRE(estimator.to_host_time(1'000) == host_offset_ns + 150'000);
+    REQUIRE(estimator.to_host_time(1'000 + sync_interval_ns)
+            == host_offset_ns + 150'000 + sync_interval_ns);
+}
+
+
+TEST_CASE("samples with a large round trip are ignored", "[clock_estimator]")
+{
+    tcam::CameraClockEstimator estimator;
+
+    for (uint64_t i = 0; i < 8; ++i)
+    {
+        const uint64_t camera = 1 + i * sync_interval_ns;
+        add(estimator, camera, host_offset_ns + camera);
+    }
+
+    // the request was delayed by the host, the camera answered immediately
+    // the middle of the round trip is 4 ms too early
+    const uint64_t camera = 1 + 8 * sync_interval_ns;
+    const uint64_t host_after = host_offset_ns + camera;
+    estimator.add_sample(camera, host_after - 8'000'000, host_after);
+
+    REQUIRE(estimator.to_host_time(camera) == host_offset_ns + camera);
+
+    // slightly slower round trips are still used
+    for (uint64_t i = 9; i < 12; ++i)
+    {
+        const uint64_t c = 1 + i * sync_interval_ns;
+        add(estimator, c, host_offset_ns + c + 1'000, 2 * round_trip_ns);
+    }
+
+    const uint64_t c = 1 + 12 * sync_interval_ns;
+    REQUIRE(estimator.to_host_time(c) > host_offset_ns + c);
+}
+
+
+TEST_CASE("round trips before a time base change are forgotten", "[clock_estimator]")
+{
+    tcam::CameraClockEstimator estimator;
+
+    for (uint64_t i = 0; i < 8; ++i)
+    {
+        const uint64_t camera = 3600'000'000'000 + i * sync_interval_ns;
+        add(estimator, camera, host_offset_ns + camera, 10'000);
+    }
+
+    // TimestampReset, the host is busier now
+    // the round trip is too large for the samples before, but it is the best of the new time base
+    const uint64_t host = host_offset_ns + 3600'000'000'000 + 8 * sync_interval_ns;
+    add(estimator, 1'000, host);
+
+    REQUIRE(estimator.to_host_time(1'000) == host);
+    REQUIRE(estimator.to_host_time(1'000 + sync_interval_ns) == host + sync_interval_ns);
+}
+
+
+TEST_CASE("host clock selection", "[clock_estimator]")
+{
+    REQUIRE(tcam::CameraClockEstimator::clock_from_name("realtime") == CLOCK_REALTIME);
+    REQUIRE(tcam::CameraClockEstimator::clock_from_name("tai") == CLOCK_TAI);
+    REQUIRE_FALSE(tcam::CameraClockEstimator::clock_from_name("TAI").has_value());
+    REQUIRE_FALSE(tcam::CameraClockEstimator::clock_from_name("monotonic").has_value());
+    REQUIRE_FALSE(tcam::CameraClockEstimator::clock_from_name("").has_value());
+
+    // TAI is ahead of UTC by the leap seconds, 0 while the kernel does not know them
+    const uint64_t realtime = tcam::CameraClockEstimator::now(CLOCK_REALTIME);
+    const uint64_t tai = tcam::CameraClockEstimator::now(CLOCK_TAI);
+
+    REQUIRE(tai >= realtime);
+    REQUIRE(tai - realtime < 60'000'000'000);
+}
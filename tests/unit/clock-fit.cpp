@@ -0,0 +1,181 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#define CATCH_CONFIG_MAIN
+
+#include <catch.hpp>
+
+#include "ClockFit.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+
+constexpr uint64_t frame_interval_ns = 33'333'333;
+
+// CLOCK_REALTIME in 2022, more than a double can hold with ns precision
+constexpr uint64_t host_offset_ns = 1'650'000'000'000'000'000;
+
+constexpr double max_deviation_ns = 10'000'000.0;
+
+int64_t error(uint64_t result, uint64_t expected)
+{
+    return (int64_t)(result - expected);
+}
+
+} // namespace
+
+
+TEST_CASE("a single sample gives the offset", "[clock_fit]")
+{
+    tcam::ClockFit fit(16, max_deviation_ns);
+
+    REQUIRE(fit.empty());
+    REQUIRE(fit.to_host(1000) == 0);
+
+    REQUIRE(fit.add(1000, host_offset_ns + 1000));
+
+    REQUIRE(fit.get_slope() == 1.0);
+    REQUIRE(fit.to_host(1000) == host_offset_ns + 1000);
+    REQUIRE(fit.to_host(5000) == host_offset_ns + 5000);
+}
+
+
+TEST_CASE("the slope between the clocks is estimated", "[clock_fit]")
+{
+    tcam::ClockFit fit(16, max_deviation_ns);
+
+    // host clock runs 50 ppm faster than the device clock
+    const double slope = 1.00005;
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        const uint64_t device = 1 + i * frame_interval_ns;
+        const uint64_t host = host_offset_ns + std::llround(slope * device);
+
+        REQUIRE(fit.add(device, host) == (i == 0));
+    }
+
+    REQUIRE(fit.size() == 16);
+    REQUIRE(fit.get_slope() == Approx(slope).epsilon(1e-9));
+
+    const uint64_t device = 1 + 110 * frame_interval_ns;
+    REQUIRE(std::abs(error(fit.to_host(device), host_offset_ns + std::llround(slope * device))) <= 1);
+}
+
+
+TEST_CASE("the window follows a changed slope", "[clock_fit]")
+{
+    tcam::ClockFit fit(16, max_deviation_ns);
+
+    uint64_t host = host_offset_ns;
+    for (uint64_t i = 1; i < 100; ++i)
+    {
+        // the host clock is slowed down after 50 samples, e.g. by NTP
+        host += i < 50 ? frame_interval_ns : frame_interval_ns - 1000;
+
+        REQUIRE(fit.add(i * frame_interval_ns, host) == (i == 1));
+    }
+
+    REQUIRE(fit.get_slope() == Approx(1.0 - 1000.0 / frame_interval_ns).epsilon(1e-9));
+    REQUIRE(std::abs(error(fit.to_host(99 * frame_interval_ns), host)) <= 1);
+}
+
+
+TEST_CASE("device time going backwards restarts the fit", "[clock_fit]")
+{
+    tcam::ClockFit fit(16, max_deviation_ns);
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        const uint64_t device = 10'000'000'000 + i * frame_interval_ns;
+        fit.add(device, device + host_offset_ns);
+    }
+
+    // camera was reset, its timestamps start at 0 again
+    const uint64_t host = host_offset_ns + 20'000'000'000;
+
+    REQUIRE(fit.add(1, host));
+    REQUIRE(fit.size() == 1);
+    REQUIRE(fit.get_base_device() == 1);
+    REQUIRE(fit.get_base_host() == host);
+    REQUIRE(fit.to_host(1 + frame_interval_ns) == host + frame_interval_ns);
+
+    // the same device time again is no progress either
+    REQUIRE(fit.add(1, host + frame_interval_ns));
+}
+
+
+TEST_CASE("a large deviation restarts the fit", "[clock_fit]")
+{
+    tcam::ClockFit fit(16, max_deviation_ns);
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        const uint64_t device = 1 + i * frame_interval_ns;
+        fit.add(device, device + host_offset_ns);
+    }
+
+    // less than max_deviation_ns is jitter
+    const uint64_t device = 1 + 100 * frame_interval_ns;
+    REQUIRE_FALSE(fit.add(device, device + host_offset_ns + 9'000'000));
+
+    // device time advances by an hour while only one frame interval passes on the host
+    const uint64_t jump = 3600'000'000'000;
+    const uint64_t host = device + frame_interval_ns + host_offset_ns;
+
+    REQUIRE(fit.add(jump + device, host));
+    REQUIRE(fit.to_host(jump + device + frame_interval_ns) == host + frame_interval_ns);
+}
+
+
+TEST_CASE("a slope that is not clock drift is ignored", "[clock_fit]")
+{
+    tcam::ClockFit fit(16, max_deviation_ns);
+
+    // host advances 20% faster, more than any clock drifts
+    for (uint64_t i = 0; i < 16; ++i) { fit.add(1 + i * 1000, host_offset_ns + i * 1200); }
+
+    REQUIRE(fit.get_slope() == 1.0);
+}
+
+
+TEST_CASE("long runs keep their precision", "[clock_fit]")
+{
+    tcam::ClockFit fit(512, max_deviation_ns);
+
+    // host clock runs 20 ppm slower than the device clock
+    const double slope = 0.99998;
+
+    // about 15 hours at 30 fps, the sums are updated and not recomputed per sample
+    for (uint64_t i = 0; i < 1'600'000; ++i)
+    {
+        const uint64_t device = 1 + i * frame_interval_ns;
+        const uint64_t host = host_offset_ns + std::llround(slope * device);
+
+        REQUIRE(fit.add(device, host) == (i == 0));
+
+        if (i >= 1'599'000)
+        {
+            REQUIRE(std::abs(error(fit.to_host(device), host)) <= 1);
+        }
+    }
+
+    REQUIRE(fit.get_slope() == Approx(slope).epsilon(1e-9));
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#define CATCH_CONFIG_MAIN
+
+#include <catch.hpp>
+
+#include "tcamsrc/mainsrc_timestamp_mapper.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+
+constexpr uint64_t frame_interval_ns = 33'333'333;
+constexpr uint64_t host_offset_ns = 5'000'000'000;
+
+// deterministic arrival delay between 0 and 200 us, every 8th frame arrives without delay
+uint64_t arrival_delay(uint64_t frame)
+{
+    if (frame % 8 == 0)
+    {
+        return 0;
+    }
+    return (frame * 7919) % 200'000;
+}
+
+// a tenth of the arrival jitter
+constexpr int64_t max_error_ns = 20'000;
+
+int64_t error(uint64_t result, double expected)
+{
+    return std::llround((double)result - expected);
+}
+
+} // namespace
+
+
+TEST_CASE("constant offset is mapped to the earliest arrival", "[timestamp_mapper]")
+{
+    tcam::mainsrc::timestamp_mapper mapper;
+
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        const uint64_t device = 1'000'000 + i * frame_interval_ns;
+        const uint64_t result = mapper.map(device, device + host_offset_ns + arrival_delay(i));
+
+        if (i >= 64)
+        {
+            REQUIRE(std::abs(error(result, device + host_offset_ns)) < max_error_ns);
+        }
+    }
+
+    REQUIRE(mapper.get_skew() == Approx(1.0).epsilon(1e-6));
+}
+
+
+TEST_CASE("the earliest arrival is found with clock skew", "[timestamp_mapper]")
+{
+    tcam::mainsrc::timestamp_mapper mapper;
+
+    // host clock runs 50 ppm faster than the device clock
+    const double skew = 1.00005;
+
+    for (uint64_t i = 0; i < 2000; ++i)
+    {
+        const uint64_t device = i * frame_interval_ns + 1;
+        const double host = host_offset_ns + skew * device;
+
+        const uint64_t result = mapper.map(device, std::llround(host) + arrival_delay(i));
+
+        if (i >= 64)
+        {
+            REQUIRE(std::abs(error(result, host)) < max_error_ns);
+        }
+    }
+
+    REQUIRE(mapper.get_skew() == Approx(skew).epsilon(1e-6));
+}
+
+
+TEST_CASE("results keep increasing when the device time restarts", "[timestamp_mapper]")
+{
+    tcam::mainsrc::timestamp_mapper mapper;
+
+    uint64_t last = 0;
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        const uint64_t device = 10'000'000'000 + i * frame_interval_ns;
+        last = mapper.map(device, device + host_offset_ns + arrival_delay(i));
+    }
+
+    // camera was reset, its timestamps start at 0 again
+    // host time continues
+    const uint64_t host_base = 10'000'000'000 + 100 * frame_interval_ns + host_offset_ns;
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        const uint64_t device = 1 + i * frame_interval_ns;
+        const uint64_t host = host_base + i * frame_interval_ns;
+        const uint64_t result = mapper.map(device, host + arrival_delay(i));
+
+        REQUIRE(result > last);
+        last = result;
+
+        if (i >= 64)
+        {
+            REQUIRE(std::abs(error(result, host)) < max_error_ns);
+        }
+    }
+}
+
+
+TEST_CASE("results are strictly increasing", "[timestamp_mapper]")
+{
+    tcam::mainsrc::timestamp_mapper mapper;
+
+    uint64_t last = 0;
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        // the device timestamp resolution is coarser than the mapping
+        const uint64_t device = 1 + i * 1000;
+        // host arrivals are bunched, several frames arrive at once
+        const uint64_t host = host_offset_ns + (i / 4) * 4000;
+
+        const uint64_t result = mapper.map(device, host);
+
+        REQUIRE(result > last);
+        last = result;
+    }
+
+    mapper.reset();
+
+    // after a reset the mapping is allowed to start over
+    REQUIRE(mapper.map(1, 1000) > 0);
+}
+
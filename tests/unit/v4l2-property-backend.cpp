@@ -0,0 +1,482 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#define CATCH_CONFIG_MAIN
+
+#include <catch.hpp>
+
+#include "v4l2/V4L2PropertyBackend.h"
+
+#include <cerrno>
+#include <deque>
+#include <map>
+#include <set>
+
+using tcam::v4l2::V4L2PropertyBackend;
+
+namespace
+{
+
+constexpr uint32_t exposure_auto_id = V4L2_CID_EXPOSURE_AUTO;
+constexpr uint32_t exposure_id = V4L2_CID_EXPOSURE_ABSOLUTE;
+constexpr uint32_t gain_id = V4L2_CID_GAIN;
+constexpr uint32_t brightness_id = V4L2_CID_BRIGHTNESS;
+// V4L2_CTRL_TYPE_INTEGER64
+constexpr uint32_t pixel_rate_id = V4L2_CID_PIXEL_RATE;
+
+//
+// Plays the driver of a device
+// Values the device changes on its own are set with device_changes
+//
+class fake_device : public V4L2PropertyBackend
+{
+public:
+    fake_device() : V4L2PropertyBackend(-1) {}
+
+    struct control
+    {
+        int64_t value = 0;
+        bool sends_events = true;
+        // VIDIOC_S_CTRL fails with EIO and does not apply the value
+        bool fail_writes = false;
+        // V4L2_CTRL_TYPE_INTEGER64, only accessible through the ext ioctls
+        bool is_int64 = false;
+    };
+
+    std::map<uint32_t, control> controls;
+    // VIDIOC_S_EXT_CTRLS with more than one control fails with EINVAL
+    // like drivers that do not accept mixed control classes
+    bool ext_ctrls_supported = true;
+
+    // number of VIDIOC_G_CTRL calls
+    int reads = 0;
+
+    void add(uint32_t id, int64_t value, uint32_t flags = 0, uint32_t type = V4L2_CTRL_TYPE_INTEGER)
+    {
+        controls[id].value = value;
+        controls[id].is_int64 = type == V4L2_CTRL_TYPE_INTEGER64;
+
+        v4l2_queryctrl qctrl = {};
+        qctrl.id = id;
+        qctrl.type = type;
+        qctrl.flags = flags;
+        enable_cache(qctrl);
+    }
+
+    // the device changes the value without sending an event
+    void device_changes_silently(uint32_t id, int64_t value)
+    {
+        controls.at(id).value = value;
+    }
+
+    void device_changes(uint32_t id, int64_t value)
+    {
+        controls.at(id).value = value;
+
+        v4l2_event ev = {};
+        ev.type = V4L2_EVENT_CTRL;
+        ev.id = id;
+        ev.u.ctrl.changes = V4L2_EVENT_CTRL_CH_VALUE;
+        ev.u.ctrl.type = V4L2_CTRL_TYPE_INTEGER;
+        ev.u.ctrl.value = value;
+        send(ev);
+    }
+
+    void device_changes_flags(uint32_t id, uint32_t flags)
+    {
+        v4l2_event ev = {};
+        ev.type = V4L2_EVENT_CTRL;
+        ev.id = id;
+        ev.u.ctrl.changes = V4L2_EVENT_CTRL_CH_FLAGS;
+        ev.u.ctrl.flags = flags;
+        send(ev);
+    }
+
+protected:
+    int xioctl(unsigned int request, void* arg) override
+    {
+        switch (request)
+        {
+            case VIDIOC_G_CTRL:
+            {
+                auto ctrl = static_cast<v4l2_control*>(arg);
+                if (controls.at(ctrl->id).is_int64)
+                {
+                    errno = EINVAL;
+                    return -1;
+                }
+                reads++;
+                ctrl->value = controls.at(ctrl->id).value;
+                return 0;
+            }
+            case VIDIOC_G_EXT_CTRLS:
+            {
+                auto ext = static_cast<v4l2_ext_controls*>(arg);
+                for (unsigned i = 0; i < ext->count; ++i)
+                {
+                    auto& c = ext->controls[i];
+                    if (controls.at(c.id).is_int64)
+                    {
+                        c.value64 = controls.at(c.id).value;
+                    }
+                    else
+                    {
+                        c.value = controls.at(c.id).value;
+                    }
+                }
+                reads++;
+                return 0;
+            }
+            case VIDIOC_S_CTRL:
+            {
+                auto ctrl = static_cast<v4l2_control*>(arg);
+                if (controls.at(ctrl->id).is_int64)
+                {
+                    errno = EINVAL;
+                    return -1;
+                }
+                if (controls.at(ctrl->id).fail_writes)
+                {
+                    errno = EIO;
+                    return -1;
+                }
+                controls.at(ctrl->id).value = ctrl->value;
+                return 0;
+            }
+            case VIDIOC_S_EXT_CTRLS:
+            {
+                auto ext = static_cast<v4l2_ext_controls*>(arg);
+                if (!ext_ctrls_supported && ext->count > 1)
+                {
+                    errno = EINVAL;
+                    return -1;
+                }
+                for (unsigned i = 0; i < ext->count; ++i)
+                {
+                    if (controls.at(ext->controls[i].id).fail_writes)
+                    {
+                        ext->error_idx = i;
+                        errno = EIO;
+                        return -1;
+                    }
+                }
+                for (unsigned i = 0; i < ext->count; ++i)
+                {
+                    auto& c = ext->controls[i];
+                    controls.at(c.id).value = controls.at(c.id).is_int64 ? c.value64 : c.value;
+                }
+                return 0;
+            }
+            case VIDIOC_SUBSCRIBE_EVENT:
+            {
+                auto sub = static_cast<v4l2_event_subscription*>(arg);
+                if (!controls.at(sub->id).sends_events)
+                {
+                    errno = EINVAL;
+                    return -1;
+                }
+                subscriptions_.insert(sub->id);
+                return 0;
+            }
+            case VIDIOC_UNSUBSCRIBE_EVENT:
+            {
+                auto sub = static_cast<v4l2_event_subscription*>(arg);
+                subscriptions_.erase(sub->id);
+                return 0;
+            }
+            case VIDIOC_DQEVENT:
+            {
+                if (events_.empty())
+                {
+                    errno = ENOENT;
+                    return -1;
+                }
+                *static_cast<v4l2_event*>(arg) = events_.front();
+                events_.pop_front();
+                return 0;
+            }
+        }
+        errno = ENOTTY;
+        return -1;
+    }
+
+private:
+    void send(const v4l2_event& ev)
+    {
+        if (subscriptions_.count(ev.id))
+        {
+            events_.push_back(ev);
+        }
+    }
+
+    std::set<uint32_t> subscriptions_;
+    std::deque<v4l2_event> events_;
+};
+
+} // namespace
+
+
+TEST_CASE("controls are read once", "[v4l2_control_cache]")
+{
+    fake_device dev;
+    dev.add(gain_id, 10);
+
+    REQUIRE(dev.read_control(gain_id).value() == 10);
+    REQUIRE(dev.read_control(gain_id).value() == 10);
+    REQUIRE(dev.reads == 1);
+
+    // own writes keep the cache valid
+    REQUIRE(dev.write_control(gain_id, 20));
+    REQUIRE(dev.read_control(gain_id).value() == 20);
+    REQUIRE(dev.reads == 1);
+}
+
+
+TEST_CASE("events update cached controls", "[v4l2_control_cache]")
+{
+    fake_device dev;
+    dev.add(gain_id, 10);
+
+    std::vector<std::pair<uint32_t, int64_t>> changes;
+    dev.set_control_changed_callback([&changes](uint32_t id, int64_t value)
+                                     { changes.push_back({ id, value }); });
+
+    REQUIRE(dev.read_control(gain_id).value() == 10);
+
+    dev.device_changes(gain_id, 30);
+
+    REQUIRE(dev.read_control(gain_id).value() == 30);
+    REQUIRE(dev.reads == 1);
+
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes.at(0).first == gain_id);
+    REQUIRE(changes.at(0).second == 30);
+
+    // the stream thread dequeues the events
+    dev.set_events_watched(true);
+    dev.device_changes(gain_id, 40);
+    dev.handle_events();
+
+    REQUIRE(dev.read_control(gain_id).value() == 40);
+    REQUIRE(dev.reads == 1);
+}
+
+
+TEST_CASE("failed writes invalidate the cache", "[v4l2_control_cache]")
+{
+    fake_device dev;
+    dev.add(gain_id, 10);
+    dev.add(brightness_id, 1);
+
+    REQUIRE(dev.read_control(gain_id).value() == 10);
+
+    SECTION("single write")
+    {
+        dev.controls.at(gain_id).fail_writes = true;
+
+        REQUIRE_FALSE(dev.write_control(gain_id, 20));
+
+        // the device may have changed anyway
+        dev.device_changes_silently(gain_id, 15);
+
+        REQUIRE(dev.read_control(gain_id).value() == 15);
+        REQUIRE(dev.reads == 2);
+    }
+
+    SECTION("batch write")
+    {
+        SECTION("without VIDIOC_S_EXT_CTRLS")
+        {
+            dev.ext_ctrls_supported = false;
+        }
+        SECTION("with VIDIOC_S_EXT_CTRLS")
+        {
+            dev.ext_ctrls_supported = true;
+        }
+        dev.controls.at(gain_id).fail_writes = true;
+
+        V4L2PropertyBackend::batch_guard batch(dev);
+        REQUIRE(dev.write_control(brightness_id, 2));
+        REQUIRE(dev.write_control(gain_id, 20));
+
+        std::vector<V4L2PropertyBackend::batch_failure> failed;
+        REQUIRE_FALSE(batch.commit(&failed));
+
+        // only the rejected control is reported
+        REQUIRE(failed.size() == 1);
+        REQUIRE(failed.at(0).v4l2_id == gain_id);
+        REQUIRE(failed.at(0).error);
+
+        dev.device_changes_silently(gain_id, 15);
+
+        REQUIRE(dev.read_control(gain_id).value() == 15);
+        REQUIRE(dev.reads == 2);
+
+        // the other control was written
+        REQUIRE(dev.read_control(brightness_id).value() == 2);
+        REQUIRE(dev.reads == 2);
+    }
+}
+
+
+TEST_CASE("volatile controls are not cached", "[v4l2_control_cache]")
+{
+    fake_device dev;
+
+    SECTION("volatile")
+    {
+        dev.add(exposure_id, 100, V4L2_CTRL_FLAG_VOLATILE);
+    }
+    SECTION("without events")
+    {
+        dev.controls[exposure_id].sends_events = false;
+        dev.add(exposure_id, 100);
+    }
+    SECTION("changed by the device")
+    {
+        dev.add(exposure_id, 100);
+        dev.disable_cache(exposure_id);
+    }
+
+    REQUIRE(dev.read_control(exposure_id).value() == 100);
+
+    dev.device_changes_silently(exposure_id, 200);
+
+    REQUIRE(dev.read_control(exposure_id).value() == 200);
+    REQUIRE(dev.reads == 2);
+}
+
+
+TEST_CASE("slaves of an active auto control are not cached", "[v4l2_control_cache]")
+{
+    fake_device dev;
+    dev.add(exposure_auto_id, V4L2_EXPOSURE_APERTURE_PRIORITY, V4L2_CTRL_FLAG_UPDATE);
+    dev.add(exposure_id, 100, V4L2_CTRL_FLAG_INACTIVE);
+
+    REQUIRE(dev.read_control(exposure_id).value() == 100);
+    dev.device_changes_silently(exposure_id, 200);
+    REQUIRE(dev.read_control(exposure_id).value() == 200);
+    REQUIRE(dev.reads == 2);
+
+    // auto exposure is switched off, the driver reports the slave as active
+    REQUIRE(dev.write_control(exposure_auto_id, V4L2_EXPOSURE_MANUAL));
+    dev.device_changes_flags(exposure_id, 0);
+
+    REQUIRE(dev.read_control(exposure_id).value() == 200);
+    REQUIRE(dev.read_control(exposure_id).value() == 200);
+    REQUIRE(dev.reads == 3);
+
+    // and active again
+    REQUIRE(dev.write_control(exposure_auto_id, V4L2_EXPOSURE_APERTURE_PRIORITY));
+    dev.device_changes_flags(exposure_id, V4L2_CTRL_FLAG_INACTIVE);
+    dev.device_changes_silently(exposure_id, 300);
+
+    REQUIRE(dev.read_control(exposure_id).value() == 300);
+}
+
+
+TEST_CASE("writing a control that updates others invalidates the cache", "[v4l2_control_cache]")
+{
+    fake_device dev;
+    dev.add(exposure_auto_id, V4L2_EXPOSURE_MANUAL, V4L2_CTRL_FLAG_UPDATE);
+    dev.add(exposure_id, 100);
+
+    REQUIRE(dev.read_control(exposure_id).value() == 100);
+
+    SECTION("single write")
+    {
+        REQUIRE(dev.write_control(exposure_auto_id, V4L2_EXPOSURE_APERTURE_PRIORITY));
+    }
+    SECTION("batch write")
+    {
+        V4L2PropertyBackend::batch_guard batch(dev);
+        REQUIRE(dev.write_control(exposure_auto_id, V4L2_EXPOSURE_APERTURE_PRIORITY));
+        REQUIRE(batch.commit());
+    }
+
+    // the driver did not send an event for the slave
+    dev.device_changes_silently(exposure_id, 150);
+
+    REQUIRE(dev.read_control(exposure_id).value() == 150);
+    REQUIRE(dev.reads == 2);
+
+    // the written control itself is still cached
+    REQUIRE(dev.read_control(exposure_auto_id).value() == V4L2_EXPOSURE_APERTURE_PRIORITY);
+    REQUIRE(dev.reads == 2);
+}
+
+
+TEST_CASE("a batch guard that is not committed writes on destruction", "[v4l2_control_cache]")
+{
+    fake_device dev;
+    dev.add(gain_id, 10);
+
+    auto write_and_return_early = [&dev]()
+    {
+        V4L2PropertyBackend::batch_guard batch(dev);
+        REQUIRE(dev.write_control(gain_id, 20));
+        REQUIRE(dev.controls.at(gain_id).value == 10);
+    };
+    write_and_return_early();
+
+    REQUIRE(dev.controls.at(gain_id).value == 20);
+
+    // the batch is closed, writes reach the device immediately again
+    REQUIRE(dev.write_control(gain_id, 30));
+    REQUIRE(dev.controls.at(gain_id).value == 30);
+}
+
+
+TEST_CASE("64 bit controls keep their value", "[v4l2_control_cache]")
+{
+    fake_device dev;
+    dev.add(pixel_rate_id, 1, 0, V4L2_CTRL_TYPE_INTEGER64);
+    dev.add(gain_id, 10);
+
+    const int64_t value = 5'000'000'000;
+
+    SECTION("single write")
+    {
+        REQUIRE(dev.write_control(pixel_rate_id, value).value() == value);
+    }
+    SECTION("batch write")
+    {
+        SECTION("without VIDIOC_S_EXT_CTRLS")
+        {
+            dev.ext_ctrls_supported = false;
+        }
+        SECTION("with VIDIOC_S_EXT_CTRLS")
+        {
+            dev.ext_ctrls_supported = true;
+        }
+
+        V4L2PropertyBackend::batch_guard batch(dev);
+        REQUIRE(dev.write_control(pixel_rate_id, value));
+        REQUIRE(dev.write_control(gain_id, 20));
+        REQUIRE(dev.read_control(pixel_rate_id).value() == value);
+
+        // the fallback writes the 64 bit control through the ext ioctl as well
+        REQUIRE(batch.commit());
+    }
+
+    REQUIRE(dev.controls.at(pixel_rate_id).value == value);
+    REQUIRE(dev.read_control(pixel_rate_id).value() == value);
+
+    dev.device_changes_silently(pixel_rate_id, 7);
+    dev.disable_cache(pixel_rate_id);
+    REQUIRE(dev.read_control(pixel_rate_id).value() == 7);
+}
@@ -0,0 +1,285 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
+#define CATCH_CONFIG_MAIN
+
+#include <catch.hpp>
+
+#include "v4l2/V4L2Reactor.h"
+
+#include <atomic>
+#include <future>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using tcam::v4l2::V4L2Reactor;
+using namespace std::chrono_literals;
+
+namespace
+{
+
+// upper bound for things that should happen immediately,
+// only reached when the reactor hangs
+constexpr auto hang_timeout = 5s;
+
+void signal_fd(int fd)
+{
+    uint64_t one = 1;
+    [[maybe_unused]] auto r = write(fd, &one, sizeof(one));
+}
+
+void drain_fd(int fd)
+{
+    uint64_t count = 0;
+    [[maybe_unused]] auto r = read(fd, &count, sizeof(count));
+}
+
+} // namespace
+
+
+TEST_CASE("delivery_queue keeps the order of its tasks")
+{
+    V4L2Reactor reactor(4, {});
+
+    constexpr int task_count = 1000;
+
+    struct device
+    {
+        std::shared_ptr<V4L2Reactor::delivery_queue> queue;
+        std::vector<int> delivered;
+        std::atomic<int> running { 0 };
+        bool overlapped = false;
+        std::promise<void> done;
+    };
+
+    device devices[3];
+
+    for (auto& d : devices)
+    {
+        d.queue = reactor.create_delivery_queue();
+    }
+
+    for (int i = 0; i < task_count; ++i)
+    {
+        for (auto& d : devices)
+        {
+            d.queue->post(
+                [&d, i]()
+                {
+                    if (d.running.fetch_add(1) != 0)
+                    {
+                        d.overlapped = true;
+                    }
+                    d.delivered.push_back(i);
+                    d.running.fetch_sub(1);
+
+                    if (i == task_count - 1)
+                    {
+                        d.done.set_value();
+                    }
+                });
+        }
+    }
+
+    for (auto& d : devices)
+    {
+        REQUIRE(d.done.get_future().wait_for(hang_timeout) == std::future_status::ready);
+
+        REQUIRE_FALSE(d.overlapped);
+        REQUIRE(d.delivered.size() == (size_t)task_count);
+        for (int i = 0; i < task_count; ++i)
+        {
+            REQUIRE(d.delivered[i] == i);
+        }
+    }
+}
+
+
+TEST_CASE("delivery_queue cancel hands pending tasks to their cancel handler")
+{
+    V4L2Reactor reactor(2, {});
+    auto queue = reactor.create_delivery_queue();
+
+    std::promise<void> started;
+    std::atomic<bool> release = false;
+    std::atomic<bool> finished = false;
+    std::atomic<int> ran = 0;
+    std::atomic<int> canceled = 0;
+
+    queue->post(
+        [&]()
+        {
+            started.set_value();
+            while (!release)
+            {
+                std::this_thread::sleep_for(1ms);
+            }
+            std::this_thread::sleep_for(20ms);
+            finished = true;
+        },
+        [&]() { canceled++; });
+
+    REQUIRE(started.get_future().wait_for(hang_timeout) == std::future_status::ready);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        queue->post([&]() { ran++; }, [&]() { canceled++; });
+    }
+
+    std::thread releaser(
+        [&]()
+        {
+            std::this_thread::sleep_for(20ms);
+            release = true;
+        });
+
+    queue->cancel();
+
+    // the running task is waited for, the pending ones never run
+    REQUIRE(finished);
+    REQUIRE(canceled == 10);
+
+    releaser.join();
+
+    std::this_thread::sleep_for(20ms);
+    REQUIRE(ran == 0);
+    REQUIRE(canceled == 10);
+
+    // the queue is usable after cancel
+    std::promise<void> after;
+    queue->post([&]() { after.set_value(); });
+    REQUIRE(after.get_future().wait_for(hang_timeout) == std::future_status::ready);
+}
+
+
+TEST_CASE("delivery_queue cancel from within one of its tasks")
+{
+    V4L2Reactor reactor(1, {});
+    auto queue = reactor.create_delivery_queue();
+
+    std::promise<void> posted;
+    auto posted_future = posted.get_future();
+    std::promise<void> done;
+    std::atomic<int> ran = 0;
+    std::atomic<int> canceled = 0;
+
+    queue->post(
+        [&]()
+        {
+            posted_future.wait();
+            // would deadlock if cancel waited for this task
+            queue->cancel();
+            done.set_value();
+        });
+
+    queue->post([&]() { ran++; }, [&]() { canceled++; });
+    queue->post([&]() { ran++; }, [&]() { canceled++; });
+    posted.set_value();
+
+    REQUIRE(done.get_future().wait_for(hang_timeout) == std::future_status::ready);
+
+    std::promise<void> after;
+    queue->post([&]() { after.set_value(); });
+    REQUIRE(after.get_future().wait_for(hang_timeout) == std::future_status::ready);
+
+    REQUIRE(ran == 0);
+    REQUIRE(canceled == 2);
+}
+
+
+TEST_CASE("remove_fd waits for a running dispatch")
+{
+    V4L2Reactor reactor(1, {});
+
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    REQUIRE(fd != -1);
+
+    std::atomic<bool> in_callback = false;
+    std::atomic<int> calls = 0;
+    std::promise<void> entered;
+    bool entered_set = false;
+
+    REQUIRE(reactor.add_fd(
+        fd,
+        EPOLLIN,
+        [&](uint32_t)
+        {
+            in_callback = true;
+            if (!entered_set)
+            {
+                entered_set = true;
+                entered.set_value();
+            }
+            std::this_thread::sleep_for(50ms);
+            drain_fd(fd);
+            calls++;
+            in_callback = false;
+        },
+        []() {},
+        []() { return 0; }));
+
+    signal_fd(fd);
+    REQUIRE(entered.get_future().wait_for(hang_timeout) == std::future_status::ready);
+
+    reactor.remove_fd(fd);
+
+    REQUIRE_FALSE(in_callback);
+    const int calls_after_remove = calls;
+
+    signal_fd(fd);
+    std::this_thread::sleep_for(50ms);
+
+    REQUIRE(calls == calls_after_remove);
+
+    close(fd);
+}
+
+
+TEST_CASE("remove_fd from within the callback of the fd")
+{
+    V4L2Reactor reactor(1, {});
+
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    REQUIRE(fd != -1);
+
+    std::atomic<int> calls = 0;
+    std::promise<void> removed;
+
+    // the fd stays readable, like a device stuck in an error state
+    REQUIRE(reactor.add_fd(
+        fd,
+        EPOLLIN,
+        [&](uint32_t)
+        {
+            if (calls++ == 0)
+            {
+                reactor.remove_fd(fd);
+                removed.set_value();
+            }
+        },
+        []() {},
+        []() { return 0; }));
+
+    signal_fd(fd);
+    REQUIRE(removed.get_future().wait_for(hang_timeout) == std::future_status::ready);
+
+    std::this_thread::sleep_for(50ms);
+    REQUIRE(calls == 1);
+
+    close(fd);
+}
@@ -907,7 +907,7 @@ void MainWindow::fps_tick(double new_fps)
 
         if (meta)
         {
-            GstStructure* struc = ((TcamStatisticsMeta*)meta)->structure;
+            auto struc = tcam_statistics_meta_get_structure((TcamStatisticsMeta*)meta);
 
             // will be freed by receiver
             emit new_meta(gst_structure_copy(struc));
@@ -18,6 +18,7 @@
 #include "../../src/version.h"
 #include "formats.h"
 #include "general.h"
+#include "metrics.h"
 #include "properties.h"
 #include "system.h"
 
@@ -138,6 +139,9 @@ int main(int argc, char* argv[])
                                      "Read a JSON string/file containing properties and their "
                                      "values and set them in the device");
 
+    auto show_metrics = app.add_option(
+        "--metrics", serial, "Print the stream metrics of a device that is used by another process");
+
     auto list_transform = app.add_subcommand("transform", "list format transformations of a GstElement");
 
     std::string transform_element = "tcamconvert";
@@ -192,6 +196,13 @@ int main(int argc, char* argv[])
     {
         list_gstreamer_1_0_formats(serial);
     }
+    else if (*show_metrics)
+    {
+        if (!print_stream_metrics(serial))
+        {
+            return 1;
+        }
+    }
     else if (*show_properties)
     {
         print_properties(serial);
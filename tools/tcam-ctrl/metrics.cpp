@@ -0,0 +1,114 @@
+/*
+ * Copyright 2022 The Imaging Source Europe GmbH
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics.h"
+
+#include "../../src/StreamMetrics.h"
+
+#include <iomanip>
+#include <iostream>
+#include <signal.h> // kill
+
+namespace
+{
+
+void print_histogram(const char* name, const tcam::metrics_histogram& histogram)
+{
+    const auto s = tcam::summarize(histogram);
+
+    std::cout << std::left << std::setw(22) << name << std::right
+              << std::setw(12) << s.count
+              << std::setw(12) << s.mean
+              << std::setw(12) << s.p50
+              << std::setw(12) << s.p90
+              << std::setw(12) << s.p99
+              << std::setw(12) << s.p999
+              << std::setw(12) << s.max << std::endl;
+}
+
+} // namespace
+
+
+bool tcam::tools::ctrl::print_stream_metrics(const std::string& serial)
+{
+    // accept the long serial format <serial>-<type>
+    auto metrics = tcam::StreamMetrics::open_readonly(serial);
+    if (!metrics && serial.find('-') != std::string::npos)
+    {
+        metrics = tcam::StreamMetrics::open_readonly(serial.substr(0, serial.find_last_of('-')));
+    }
+
+    if (!metrics)
+    {
+        std::cerr << "No stream metrics for " << serial
+                  << ". Metrics are only available while a process has the device open."
+                  << std::endl;
+        return false;
+    }
+
+    const auto& data = metrics->data();
+
+    const int pid = data.pid.load(std::memory_order_relaxed);
+    const bool is_running = pid > 0 && kill(pid, 0) == 0;
+
+    std::cout << std::left
+              << std::setw(22) << "serial" << metrics->get_serial() << std::endl
+              << std::setw(22) << "pid" << pid << (is_running ? "" : " (not running)") << std::endl
+              << std::setw(22) << "frames-delivered"
+              << data.frames_delivered.load(std::memory_order_relaxed) << std::endl;
+
+    for (size_t i = 0; i < tcam::drop_cause_count; ++i)
+    {
+        std::cout << std::setw(22)
+                  << std::string("drops-") + tcam::drop_cause_to_string(static_cast<tcam::drop_cause>(i))
+                  << data.drops[i].load(std::memory_order_relaxed) << std::endl;
+    }
+
+    if (data.packet_size.load(std::memory_order_relaxed) != 0)
+    {
+        std::cout << std::setw(22) << "packets-resent"
+                  << data.packets_resent.load(std::memory_order_relaxed) << std::endl
+                  << std::setw(22) << "packets-missing"
+                  << data.packets_missing.load(std::memory_order_relaxed) << std::endl
+                  << std::setw(22) << "frames-lost"
+                  << data.frames_lost.load(std::memory_order_relaxed) << std::endl
+                  << std::setw(22) << "packet-size"
+                  << data.packet_size.load(std::memory_order_relaxed) << std::endl
+                  << std::setw(22) << "packet-delay-ns"
+                  << data.packet_delay_ns.load(std::memory_order_relaxed) << std::endl;
+    }
+
+    std::cout << std::endl
+              << std::left << std::setw(22) << "histogram" << std::right
+              << std::setw(12) << "count"
+              << std::setw(12) << "mean"
+              << std::setw(12) << "p50"
+              << std::setw(12) << "p90"
+              << std::setw(12) << "p99"
+              << std::setw(12) << "p99.9"
+              << std::setw(12) << "max" << std::endl;
+
+    print_histogram("dequeue-to-push-ns", data.dequeue_to_push_ns);
+    print_histogram("handoff-wait-ns", data.handoff_wait_ns);
+    print_histogram("convert-ns", data.convert_ns);
+    print_histogram("buffers-in-flight", data.buffers_in_flight);
+    if (data.packet_size.load(std::memory_order_relaxed) != 0)
+    {
+        print_histogram("packets-resent/frame", data.packets_resent_per_frame);
+    }
+
+    return true;
+}